@@ -33,6 +33,21 @@ unsigned test_set_l(int verbose);
 unsigned test_shift_right(int verbose);
 unsigned test_subtract(int verbose);
 unsigned test_to_string(int verbose);
+unsigned test_u64(int verbose);
+unsigned test_scratch(int verbose);
+unsigned test_growable(int verbose);
+unsigned test_pool(int verbose);
+unsigned test_thread_cache(int verbose);
+unsigned test_sizes(int verbose);
+unsigned test_view(int verbose);
+unsigned test_swap(int verbose);
+unsigned test_bits(int verbose);
+unsigned test_bitwise(int verbose);
+unsigned test_string_radix(int verbose);
+unsigned test_serialize(int verbose);
+unsigned test_import_export(int verbose);
+unsigned test_parser(int verbose);
+unsigned test_write(int verbose);
 
 /* globals */
 uint32_t loop_count;
@@ -110,6 +125,21 @@ void loop(void)
 	failures += Test_func(test_shift_right, verbose);
 	failures += Test_func(test_subtract, verbose);
 	failures += Test_func(test_to_string, verbose);
+	failures += Test_func(test_u64, verbose);
+	failures += Test_func(test_scratch, verbose);
+	failures += Test_func(test_growable, verbose);
+	failures += Test_func(test_pool, verbose);
+	failures += Test_func(test_thread_cache, verbose);
+	failures += Test_func(test_sizes, verbose);
+	failures += Test_func(test_view, verbose);
+	failures += Test_func(test_swap, verbose);
+	failures += Test_func(test_bits, verbose);
+	failures += Test_func(test_bitwise, verbose);
+	failures += Test_func(test_string_radix, verbose);
+	failures += Test_func(test_serialize, verbose);
+	failures += Test_func(test_import_export, verbose);
+	failures += Test_func(test_parser, verbose);
+	failures += Test_func(test_write, verbose);
 
 	Serial.println("=================================================");
 	if (failures) {
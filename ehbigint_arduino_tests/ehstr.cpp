@@ -1 +0,0 @@
-../submodules/libehstr/src/ehstr.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-bits.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-bitwise.c
\ No newline at end of file
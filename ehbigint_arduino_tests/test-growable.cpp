@@ -0,0 +1 @@
+../tests/test-growable.c
\ No newline at end of file
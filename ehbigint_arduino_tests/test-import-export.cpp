@@ -0,0 +1 @@
+../tests/test-import-export.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-parser.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-scratch.c
\ No newline at end of file
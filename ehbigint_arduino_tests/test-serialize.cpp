@@ -0,0 +1 @@
+../tests/test-serialize.c
\ No newline at end of file
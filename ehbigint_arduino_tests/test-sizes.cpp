@@ -0,0 +1 @@
+../tests/test-sizes.c
\ No newline at end of file
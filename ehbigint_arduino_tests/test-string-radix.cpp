@@ -0,0 +1 @@
+../tests/test-string-radix.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-swap.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-thread-cache.c
\ No newline at end of file
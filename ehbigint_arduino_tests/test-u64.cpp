@@ -0,0 +1 @@
+../tests/test-u64.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-view.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-write.c
\ No newline at end of file
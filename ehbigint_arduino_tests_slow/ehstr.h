@@ -1 +0,0 @@
-../submodules/libehstr/src/ehstr.h
\ No newline at end of file
@@ -5,7 +5,6 @@
 #include "ehbigint.h"
 #include "eembed.h"
 #include "eba.h"
-#include "ehstr.h"
 
 #include <limits.h>		/* LONG_MAX */
 
@@ -33,6 +32,15 @@
 #define Ehbi_bi_buf_size (sizeof(size_t) * 16)
 #endif
 
+/* per-thread state, on a single threaded target this is simply static */
+#ifndef EHBI_THREAD_LOCAL
+#if EEMBED_HOSTED && defined(__GNUC__)
+#define EHBI_THREAD_LOCAL __thread
+#else
+#define EHBI_THREAD_LOCAL
+#endif
+#endif
+
 /* global variables */
 static struct eembed_log *global_ehbi_log = NULL;
 
@@ -51,12 +59,6 @@ static void ehbi_log_error_s_c_s(const char *file, int line,
 #define Ehbi_log_error_s_c_s(pre, c, post) \
 	ehbi_log_error_s_c_s(__FILE__, __LINE__, pre, c, post)
 
-static void ehbi_log_error_s_s_s(const char *file, int line,
-				 const char *pre, const char *mid,
-				 const char *post);
-#define Ehbi_log_error_s_s_s(pre, mid, post) \
-	ehbi_log_error_s_s_s(__FILE__, __LINE__, pre, mid, post)
-
 static void ehbi_log_error_s_l_s(const char *file, int line,
 				 const char *pre, long l, const char *post);
 #define Ehbi_log_error_s_l_s(pre, mid, post) \
@@ -68,12 +70,6 @@ static void ehbi_log_error_s_ul_s(const char *file, int line,
 #define Ehbi_log_error_s_ul_s(pre, ul, post) \
 	ehbi_log_error_s_ul_s(__FILE__, __LINE__, pre, ul, post)
 
-static void ehbi_log_error_s_c_s_c_s(const char *file, int line,
-				     const char *pre, char c1, const char *mid,
-				     char c2, const char *post);
-#define Ehbi_log_error_s_c_s_c_s(pre, c1, mid, c2, post) \
-	ehbi_log_error_s_c_s_c_s(__FILE__, __LINE__, pre, c1, mid, c2, post)
-
 static void ehbi_log_error_s_ul_s_ul_s(const char *file, int line,
 				       const char *pre, unsigned long ul1,
 				       const char *mid, unsigned long ul2,
@@ -87,12 +83,22 @@ static void ehbi_log_error_s_ul_s_ul_s(const char *file, int line,
 	eembed_assert(p->bytes_len); \
 } while (0)
 
-/* would a union make this nicer? */
-static char *ehbi_hex_chars_from_byte(char *high, char *low, unsigned char byte,
-				      int *err);
-static unsigned char ehbi_hex_chars_to_byte(char high, char low, int *err);
+/* bytes_used is kept exact by each operation, rather than found by a scan,
+   these checks are for debug builds only */
+#ifndef NDEBUG
+static int ehbi_internal_is_normal(const struct ehbigint *bi);
+#define Ehbi_assert_normal(p) eembed_assert(ehbi_internal_is_normal(p))
+#else
+#define Ehbi_assert_normal(p) do { } while (0)
+#endif
 
-static void ehbi_internal_reset_bytes_used(struct ehbigint *bi, size_t from);
+static struct ehbigint *ehbi_inc_l_x(struct ehbigint *bi, long val,
+				     struct ehbi_scratch *s, int *err);
+static struct ehbigint *ehbi_dec_l_x(struct ehbigint *bi, long val,
+				     struct ehbi_scratch *s, int *err);
+static struct ehbigint *ehbi_subtract_l_x(struct ehbigint *res,
+					  const struct ehbigint *bi1, long v2,
+					  struct ehbi_scratch *s, int *err);
 
 static void ehbi_set_error(int *err, int code)
 {
@@ -102,24 +108,133 @@ static void ehbi_set_error(int *err, int code)
 }
 
 enum ehbi_flags {
-	ehbi_flag_sign = 0
+	ehbi_flag_sign = 0,
+	ehbi_flag_heap = 1,
+	ehbi_flag_scratch = 2,
+	ehbi_flag_grow = 3,
+	ehbi_flag_view = 4
 };
 
+static void ehbi_flag_set(struct ehbigint *bi, enum ehbi_flags flag,
+			  unsigned val)
+{
+	bi->flags = eba_set_byte_bit(bi->flags, flag, val);
+}
+
+static unsigned ehbi_flag(const struct ehbigint *bi, enum ehbi_flags flag)
+{
+	return eba_get_byte_bit(bi->flags, flag);
+}
+
 static void ehbi_sign_set(struct ehbigint *bi, unsigned val)
 {
-	bi->flags = eba_set_byte_bit(bi->flags, ehbi_flag_sign, val);
+	ehbi_flag_set(bi, ehbi_flag_sign, val);
 }
 
 static unsigned ehbi_sign(const struct ehbigint *bi)
 {
-	return eba_get_byte_bit(bi->flags, ehbi_flag_sign);
+	return ehbi_flag(bi, ehbi_flag_sign);
+}
+
+/* the position of the highest set bit, 1 to 8, or 0 if none is set */
+static unsigned char ehbi_msb8(register unsigned char in)
+{
+#if defined(__GNUC__)
+	if (in == 0x00) {
+		return 0;
+	}
+	return (unsigned char)((sizeof(unsigned) * EEMBED_CHAR_BIT)
+			       - (unsigned)__builtin_clz(in));
+#else
+	if (in & (1 << 7)) {
+		return 8;
+	}
+	if (in & (1 << 6)) {
+		return 7;
+	}
+	if (in & (1 << 5)) {
+		return 6;
+	}
+	if (in & (1 << 4)) {
+		return 5;
+	}
+	if (in & (1 << 3)) {
+		return 4;
+	}
+	if (in & (1 << 2)) {
+		return 3;
+	}
+	if (in & (1 << 1)) {
+		return 2;
+	}
+	if (in & (1 << 0)) {
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+/* the count of low zero bits, the byte must not be zero */
+static unsigned char ehbi_ctz8(register unsigned char in)
+{
+#if defined(__GNUC__)
+	return (unsigned char)__builtin_ctz(in);
+#else
+	unsigned char bits;
+
+	for (bits = 0; !(in & 0x01); in = in >> 1) {
+		++bits;
+	}
+	return bits;
+#endif
+}
+
+static unsigned char ehbi_popcount8(register unsigned char in)
+{
+#if defined(__GNUC__)
+	return (unsigned char)__builtin_popcount(in);
+#else
+	unsigned char bits;
+
+	for (bits = 0; in; in = in & (in - 1)) {
+		++bits;
+	}
+	return bits;
+#endif
+}
+
+size_t ehbi_bit_length(const struct ehbigint *bi)
+{
+	Ehbi_assert_bi(bi);
+
+	if (bi->bytes_used == 0) {
+		return 0;
+	}
+	return (EEMBED_CHAR_BIT * (bi->bytes_used - 1))
+	    + ehbi_msb8(bi->bytes[bi->bytes_used - 1]);
+}
+
+size_t ehbi_count_trailing_zeros(const struct ehbigint *bi)
+{
+	size_t i;
+
+	Ehbi_assert_bi(bi);
+
+	for (i = 0; i < bi->bytes_used && bi->bytes[i] == 0x00; ++i) ;
+	if (i == bi->bytes_used) {
+		return 0;
+	}
+
+	return (EEMBED_CHAR_BIT * i) + ehbi_ctz8(bi->bytes[i]);
 }
 
 struct ehbigint *ehbi_zero(struct ehbigint *bi)
 {
 	Ehbi_assert_bi(bi);
+	eembed_assert(!ehbi_flag(bi, ehbi_flag_view));
 
-	eembed_memset(bi->bytes, 0x00, bi->bytes_len);
+	/* bytes above bytes_used are never read, so need not be cleared */
+	bi->bytes[0] = 0x00;
 	bi->bytes_used = 1;
 	ehbi_sign_set(bi, 0);
 
@@ -139,23 +254,59 @@ static void ehbi_internal_clear_null_struct(struct ehbigint *bi)
 static void ehbi_internal_struct_l(struct ehbigint *temp, long val)
 {
 	unsigned long v;
-	unsigned char c;
-	size_t i, j;
+	size_t i;
 
 	Ehbi_assert_bi(temp);
 
-	temp->bytes_used = sizeof(unsigned long);
-
-	v = (val < 0) ? (unsigned long)(-val) : (unsigned long)val;
+	/* avoid the overflow of -LONG_MIN by negating as unsigned */
+	v = (val < 0) ? (0UL - (unsigned long)val) : (unsigned long)val;
 
-	for (i = 0; i < temp->bytes_used; ++i) {
-		c = (v >> (8 * i));
-		j = (temp->bytes_len - 1) - i;
-		temp->bytes[j] = c;
+	/* only the bytes up to the most significant non-zero are written */
+	temp->bytes[0] = 0x00;
+	for (i = 0; v; ++i) {
+		temp->bytes[i] = (unsigned char)v;
+		v = v >> 8;
 	}
+	temp->bytes_used = i ? i : 1;
 	ehbi_sign_set(temp, (val < 0));
-	ehbi_internal_reset_bytes_used(temp, sizeof(unsigned long));
+	Ehbi_assert_normal(temp);
+}
+
+static void ehbi_internal_struct_u64(struct ehbigint *temp, uint64_t val)
+{
+	size_t i;
+
+	Ehbi_assert_bi(temp);
+	eembed_assert(temp->bytes_len >= sizeof(uint64_t));
+
+	temp->bytes[0] = 0x00;
+	for (i = 0; val; ++i) {
+		temp->bytes[i] = (unsigned char)val;
+		val = val >> 8;
+	}
+	temp->bytes_used = i ? i : 1;
+	ehbi_sign_set(temp, 0);
+	Ehbi_assert_normal(temp);
+}
+
+#ifdef EHBI_HAVE_U128
+static void ehbi_internal_struct_u128(struct ehbigint *temp, ehbi_u128 val)
+{
+	size_t i;
+
+	Ehbi_assert_bi(temp);
+	eembed_assert(temp->bytes_len >= sizeof(ehbi_u128));
+
+	temp->bytes[0] = 0x00;
+	for (i = 0; val; ++i) {
+		temp->bytes[i] = (unsigned char)val;
+		val = val >> 8;
+	}
+	temp->bytes_used = i ? i : 1;
+	ehbi_sign_set(temp, 0);
+	Ehbi_assert_normal(temp);
 }
+#endif
 
 struct ehbigint *ehbi_init(struct ehbigint *bi, unsigned char *bytes,
 			   size_t len)
@@ -164,6 +315,7 @@ struct ehbigint *ehbi_init(struct ehbigint *bi, unsigned char *bytes,
 
 	bi->bytes = bytes;
 	bi->bytes_len = len;
+	bi->flags = 0x00;
 
 	ehbi_zero(bi);
 
@@ -177,1143 +329,1374 @@ struct ehbigint *ehbi_init_l(struct ehbigint *bi, unsigned char *bytes,
 	return ehbi_set_l(bi, val, err);
 }
 
-struct ehbigint *ehbi_set_l(struct ehbigint *bi, long val, int *err)
-{
-	ehbi_zero(bi);
+/* the bytes of a view are never written, thus the const may be dropped */
+union ehbi_view_bytes {
+	const unsigned char *c;
+	unsigned char *u;
+};
 
-	return ehbi_inc_l(bi, val, err);
-}
+static const unsigned char ehbi_view_zero_byte = 0x00;
 
-struct ehbigint *ehbi_set(struct ehbigint *bi, const struct ehbigint *val,
-			  int *err)
+struct ehbigint *ehbi_view_init(struct ehbigint *view,
+				const unsigned char *bytes, size_t len,
+				int *err)
 {
-	size_t offset, voffset;
+	union ehbi_view_bytes vb;
+	size_t used;
 
-	Ehbi_assert_bi(bi);
-	Ehbi_assert_bi(val);
+	eembed_assert(view);
 
-	if (val->bytes_used > bi->bytes_len) {
-		Ehbi_log_error_s_ul_s_ul_s("Result byte[", bi->bytes_len,
-					   "] too small (", val->bytes_used,
-					   ")");
-		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
-		goto ehbi_set_error;
+	if (!bytes && len) {
+		Ehbi_log_error0("Null bytes");
+		ehbi_set_error(err, EHBI_NULL_BYTES);
+		return NULL;
 	}
-	ehbi_sign_set(bi, ehbi_sign(val));
-	bi->bytes_used = val->bytes_used;
-
-	offset = bi->bytes_len - bi->bytes_used;
-	if (offset) {
-		eembed_memset(bi->bytes, 0x00, offset);
+	if (len == 0) {
+		bytes = &ehbi_view_zero_byte;
+		len = 1;
 	}
 
-	voffset = val->bytes_len - val->bytes_used;
-	eembed_memcpy(bi->bytes + offset, val->bytes + voffset,
-		      val->bytes_used);
+	used = len;
+	while (used > 1 && bytes[used - 1] == 0x00) {
+		--used;
+	}
 
-	return bi;
+	vb.c = bytes;
+	view->bytes = vb.u;
+	view->bytes_len = len;
+	view->bytes_used = used;
+	view->flags = 0x00;
+	ehbi_flag_set(view, ehbi_flag_view, 1);
 
-ehbi_set_error:
-	ehbi_zero(bi);
-	return NULL;
+	return view;
 }
 
-int ehbi_is_zero(const struct ehbigint *bi)
+struct ehbigint *ehbi_view_slice(struct ehbigint *view,
+				 const struct ehbigint *bi, size_t offset,
+				 size_t len, int *err)
 {
 	Ehbi_assert_bi(bi);
 
-	return (bi->bytes_used <= 1 && bi->bytes[bi->bytes_len - 1] == 0x00);
-}
-
-static struct ehbigint *ehbi_set_or_malloc(struct ehbigint *tmp,
-					   unsigned char *bbuf, size_t bbuf_len,
-					   const struct ehbigint *val, int *err,
-					   int line)
-{
-	size_t need = val->bytes_used;
-	ehbi_internal_clear_null_struct(tmp);
-	if (bbuf_len >= need) {
-		tmp->bytes = bbuf;
-		tmp->bytes_len = bbuf_len;
-	} else {
-		tmp->bytes = (unsigned char *)eembed_malloc(need);
-		if (!tmp->bytes) {
-			Ehbi_log_error_s_ul_s_ul_s("Line ", line,
-						   ". Could not allocate ",
-						   need, " bytes?");
-			ehbi_set_error(err, EHBI_NOMEM);
-			return NULL;
-		}
-		tmp->bytes_len = need;
+	/* the bytes above bytes_used are unspecified, so are not viewed */
+	if (offset >= bi->bytes_used) {
+		len = 0;
+	} else if (len > bi->bytes_used - offset) {
+		len = bi->bytes_used - offset;
 	}
-	ehbi_zero(tmp);
-	return ehbi_set(tmp, val, err);
-}
 
-#define Ehbi_set_or_malloc(tmp, bbuf, bbuf_len, val, err) \
-	ehbi_set_or_malloc(tmp, bbuf, bbuf_len, val, err, __LINE__)
+	return ehbi_view_init(view, len ? bi->bytes + offset : NULL, len, err);
+}
 
-static void ehbi_set_or_malloc_free(struct ehbigint *tmp, size_t stack_buf_size)
+struct ehbigint *ehbi_set_l(struct ehbigint *bi, long val, int *err)
 {
-	if (tmp->bytes_len > stack_buf_size) {
-		eembed_free(tmp->bytes);
-		tmp->bytes = NULL;
-	}
+	ehbi_zero(bi);
+
+	return ehbi_inc_l(bi, val, err);
 }
 
-struct ehbigint *ehbi_add(struct ehbigint *res,
-			  const struct ehbigint *bi1,
-			  const struct ehbigint *bi2, int *err)
+struct ehbigint *ehbi_set_u64(struct ehbigint *bi, uint64_t val, int *err)
 {
-	size_t i;
-	unsigned char a, b, c;
-	const struct ehbigint *swp;
-	struct ehbigint tmp;
-	unsigned char bytes[Ehbi_bi_buf_size];
+	unsigned char bytes[sizeof(uint64_t)];
+	struct ehbigint temp;
 
-	ehbi_internal_clear_null_struct(&tmp);
+	ehbi_internal_clear_null_struct(&temp);
 
-	Ehbi_assert_bi(res);
-	Ehbi_assert_bi(bi1);
-	Ehbi_assert_bi(bi2);
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(uint64_t);
+	ehbi_internal_struct_u64(&temp, val);
 
-	/* adding zero */
-	if (ehbi_is_zero(bi2)) {
-		return ehbi_set(res, bi1, err);
-	}
+	return ehbi_set(bi, &temp, err);
+}
 
-	/* adding to zero */
-	if (ehbi_is_zero(bi1)) {
-		return ehbi_set(res, bi2, err);
-	}
+int ehbi_fits_u64(const struct ehbigint *bi)
+{
+	Ehbi_assert_bi(bi);
 
-	if (ehbi_sign(bi1) != ehbi_sign(bi2)) {
-		swp =
-		    Ehbi_set_or_malloc(&tmp, bytes, Ehbi_bi_buf_size, bi2, err);
-		if (!swp) {
-			goto ehbi_add_error;
-		}
-		ehbi_negate(&tmp);
-		swp = ehbi_subtract(res, bi1, &tmp, err);
-		if (!swp) {
-			goto ehbi_add_error;
-		}
-		ehbi_set_or_malloc_free(&tmp, Ehbi_bi_buf_size);
-		return res;
-	}
-	ehbi_sign_set(res, ehbi_sign(bi1));
+	return (!ehbi_is_negative(bi) && bi->bytes_used <= sizeof(uint64_t));
+}
 
-	if (bi1->bytes_used < bi2->bytes_used) {
-		swp = bi1;
-		bi1 = bi2;
-		bi2 = swp;
-	}
+uint64_t ehbi_get_u64(const struct ehbigint *bi, int *err)
+{
+	size_t i;
+	uint64_t val;
 
-	res->bytes_used = 0;
-	c = 0;
-	for (i = 1; i <= bi1->bytes_used; ++i) {
-		a = bi1->bytes[bi1->bytes_len - i];
-		b = (bi2->bytes_used < i) ? 0 : bi2->bytes[bi2->bytes_len - i];
-		c = c + a + b;
-
-		if (i > res->bytes_len) {
-			Ehbi_log_error_s_ul_s_ul_s("Result byte[",
-						   res->bytes_len,
-						   "] too small (", i, ")");
-			ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
-			goto ehbi_add_error;
-		}
-		res->bytes[res->bytes_len - i] = c;
-		res->bytes_used++;
+	Ehbi_assert_bi(bi);
 
-		c = (c < a) || (c == a && b != 0) ? 1 : 0;
-	}
-	if (c) {
-		if (i > res->bytes_len) {
-			Ehbi_log_error_s_ul_s_ul_s("Result byte[",
-						   res->bytes_len,
-						   "] too small (", i, ")");
-			ehbi_set_error(err, EHBI_BYTES_TOO_SMALL_FOR_CARRY);
-			goto ehbi_add_error;
-		}
-		res->bytes[res->bytes_len - i] = c;
-		res->bytes_used++;
-		if (c == 0xFF) {
-			if (res->bytes_used == res->bytes_len) {
-				Ehbi_log_error_s_ul_s("Result byte[",
-						      res->bytes_len,
-						      "] too small for carry");
-				ehbi_set_error(err,
-					       EHBI_BYTES_TOO_SMALL_FOR_CARRY);
-				goto ehbi_add_error;
-			}
-			res->bytes_used++;
-		}
+	if (!ehbi_fits_u64(bi)) {
+		Ehbi_log_error0("value does not fit in a uint64_t");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
 	}
 
-	if (ehbi_is_zero(res)) {
-		ehbi_sign_set(res, 0);
+	val = 0;
+	for (i = bi->bytes_used; i > 0; --i) {
+		val = (val << 8) | bi->bytes[i - 1];
 	}
-
-	return res;
-
-ehbi_add_error:
-	ehbi_zero(res);
-	ehbi_set_or_malloc_free(&tmp, Ehbi_bi_buf_size);
-	return NULL;
+	return val;
 }
 
-struct ehbigint *ehbi_add_l(struct ehbigint *res, const struct ehbigint *bi1,
-			    long v2, int *err)
+#ifdef EHBI_HAVE_U128
+struct ehbigint *ehbi_set_u128(struct ehbigint *bi, ehbi_u128 val, int *err)
 {
-	unsigned char bytes[sizeof(unsigned long)];
+	unsigned char bytes[sizeof(ehbi_u128)];
 	struct ehbigint temp;
 
 	ehbi_internal_clear_null_struct(&temp);
 
 	temp.bytes = bytes;
-	temp.bytes_len = sizeof(unsigned long);
-	ehbi_internal_struct_l(&temp, v2);
+	temp.bytes_len = sizeof(ehbi_u128);
+	ehbi_internal_struct_u128(&temp, val);
 
-	return ehbi_add(res, bi1, &temp, err);
+	return ehbi_set(bi, &temp, err);
 }
 
-struct ehbigint *ehbi_mul(struct ehbigint *res, const struct ehbigint *bi1,
-			  const struct ehbigint *bi2, int *err)
+int ehbi_fits_u128(const struct ehbigint *bi)
 {
-	size_t i, j;
-	const struct ehbigint *t;
-	unsigned int a, b, r;
-	unsigned long overflow;
-	struct ehbigint tmp;
-	struct ehbigint *rp;
-	unsigned char bytes[Ehbi_bi_buf_size];
+	Ehbi_assert_bi(bi);
 
-	ehbi_internal_clear_null_struct(&tmp);
+	return (!ehbi_is_negative(bi) && bi->bytes_used <= sizeof(ehbi_u128));
+}
 
-	Ehbi_assert_bi(res);
-	ehbi_zero(res);
-	Ehbi_assert_bi(bi1);
-	Ehbi_assert_bi(bi2);
+ehbi_u128 ehbi_get_u128(const struct ehbigint *bi, int *err)
+{
+	size_t i;
+	ehbi_u128 val;
 
-	err = 0;
-	if (bi1->bytes_used < bi2->bytes_used) {
-		t = bi1;
-		bi1 = bi2;
-		bi2 = t;
-	}
+	Ehbi_assert_bi(bi);
 
-	rp = Ehbi_set_or_malloc(&tmp, bytes, Ehbi_bi_buf_size, res, err);
-	if (!rp) {
-		return NULL;
+	if (!ehbi_fits_u128(bi)) {
+		Ehbi_log_error0("value does not fit in an ehbi_u128");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
 	}
-	ehbi_zero(&tmp);
 
-	rp = res;
-	for (i = 0; i < bi2->bytes_used; ++i) {
-		for (j = 0; j < bi1->bytes_used; ++j) {
-			a = bi2->bytes[(bi2->bytes_len - 1) - i];
-			b = bi1->bytes[(bi1->bytes_len - 1) - j];
-			r = (a * b);
-			rp = ehbi_set_l(&tmp, r, err);
-			if (!rp) {
-				goto ehbi_mul_end;
-			}
-			overflow = 0;
-			rp = ehbi_shift_left(&tmp, i * EEMBED_CHAR_BIT,
-					     &overflow);
-			if (overflow) {
-				rp = NULL;
-				goto ehbi_mul_end;
-			}
-			rp = ehbi_shift_left(&tmp, j * EEMBED_CHAR_BIT,
-					     &overflow);
-			if (overflow) {
-				rp = NULL;
-				goto ehbi_mul_end;
-			}
-			rp = ehbi_inc(res, &tmp, err);
-			if (!rp) {
-				goto ehbi_mul_end;
-			}
-		}
+	val = 0;
+	for (i = bi->bytes_used; i > 0; --i) {
+		val = (val << 8) | bi->bytes[i - 1];
 	}
+	return val;
+}
+#endif
 
-	if (ehbi_sign(bi1) != ehbi_sign(bi2)) {
-		ehbi_sign_set(res, 1);
-	}
+void ehbi_set_growable(struct ehbigint *bi, int growable)
+{
+	Ehbi_assert_bi(bi);
+	eembed_assert(!ehbi_flag(bi, ehbi_flag_view));
 
-ehbi_mul_end:
-	if (!rp) {
-		ehbi_zero(res);
-	}
+	ehbi_flag_set(bi, ehbi_flag_grow, growable ? 1 : 0);
+}
 
-	ehbi_set_or_malloc_free(&tmp, Ehbi_bi_buf_size);
+int ehbi_is_growable(const struct ehbigint *bi)
+{
+	Ehbi_assert_bi(bi);
 
-	return rp;
+	return ehbi_flag(bi, ehbi_flag_grow) ? 1 : 0;
 }
 
-struct ehbigint *ehbi_mul_l(struct ehbigint *res, const struct ehbigint *bi1,
-			    long v2, int *err)
+/* if the ehbigint is growable, ensure that it has room for "need" bytes,
+   at least doubling the byte[] in order to keep the growth amortized;
+   the value is preserved, and the extra room is added at the high end,
+   which being the end of the byte[] needs no moving or clearing.
+   a byte[] which is not already on the heap on its own (e.g.: the bytes
+   which share a block with the struct from ehbi_alloc) is left in place,
+   and the heap flag is set so that the new byte[] is freed later.
+   a fixed size ehbigint is returned unchanged, callers check bytes_len */
+static struct ehbigint *ehbi_reserve(struct ehbigint *bi, size_t need,
+				     int *err)
 {
-	unsigned char bytes[sizeof(unsigned long)];
-	struct ehbigint temp;
-
-	ehbi_internal_clear_null_struct(&temp);
+	struct eembed_allocator *ea = eembed_global_allocator;
+	unsigned char *bytes;
+	size_t len;
 
-	temp.bytes = bytes;
-	temp.bytes_len = sizeof(unsigned long);
-	ehbi_internal_struct_l(&temp, v2);
+	eembed_assert(!ehbi_flag(bi, ehbi_flag_view));
 
-	return ehbi_mul(res, bi1, &temp, err);
-}
+	if (need <= bi->bytes_len || !ehbi_flag(bi, ehbi_flag_grow)) {
+		return bi;
+	}
 
-struct ehbigint *ehbi_div(struct ehbigint *quotient, struct ehbigint *remainder,
-			  const struct ehbigint *numerator,
-			  const struct ehbigint *denominator, int *err)
-{
-	size_t i, num_idx;
-	unsigned long overflow;
-	struct ehbigint s_abs_numer;
-	struct ehbigint s_abs_denom;
-	const struct ehbigint *abs_numer;
-	const struct ehbigint *abs_denom;
-	struct ehbigint *rp;
-	unsigned char abs_numer_bytes[Ehbi_bi_buf_size];
-	unsigned char abs_denom_bytes[Ehbi_bi_buf_size];
+	len = bi->bytes_len * 2;
+	if (len < need) {
+		len = need;
+	}
 
-	ehbi_internal_clear_null_struct(&s_abs_numer);
-	ehbi_internal_clear_null_struct(&s_abs_denom);
+	if (ehbi_flag(bi, ehbi_flag_heap)) {
+		bytes = (unsigned char *)ea->realloc(ea, bi->bytes, len);
+	} else {
+		bytes = (unsigned char *)ea->malloc(ea, len);
+	}
+	if (!bytes) {
+		Ehbi_log_error_s_ul_s("could not allocate ", len, " bytes?");
+		ehbi_set_error(err, EHBI_NOMEM);
+		return NULL;
+	}
 
-	Ehbi_assert_bi(numerator);
-	Ehbi_assert_bi(denominator);
+	if (!ehbi_flag(bi, ehbi_flag_heap)) {
+		eembed_memcpy(bytes, bi->bytes, bi->bytes_used);
+		ehbi_flag_set(bi, ehbi_flag_heap, 1);
+	}
 
-	Ehbi_assert_bi(quotient);
-	ehbi_zero(quotient);
+	bi->bytes = bytes;
+	bi->bytes_len = len;
 
-	Ehbi_assert_bi(remainder);
-	ehbi_zero(remainder);
+	return bi;
+}
 
-	rp = quotient;
+struct ehbigint *ehbi_set(struct ehbigint *bi, const struct ehbigint *val,
+			  int *err)
+{
+	Ehbi_assert_bi(bi);
+	Ehbi_assert_bi(val);
 
-	if (remainder->bytes_len < numerator->bytes_used) {
-		Ehbi_log_error_s_ul_s_ul_s("byte[] too small;"
-					   " remainder->bytes_len < numerator->bytes_used"
-					   " (", remainder->bytes_len, " < ",
-					   numerator->bytes_used, ")");
+	if (!ehbi_reserve(bi, val->bytes_used, err)) {
+		goto ehbi_set_error;
+	}
+	if (val->bytes_used > bi->bytes_len) {
+		Ehbi_log_error_s_ul_s_ul_s("Result byte[", bi->bytes_len,
+					   "] too small (", val->bytes_used,
+					   ")");
 		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
-		return NULL;
+		goto ehbi_set_error;
 	}
-
-	if (ehbi_sign(numerator) == 0) {
-		abs_numer = numerator;
-	} else {
-		s_abs_numer.bytes_used = 0;
-		s_abs_numer.bytes_len = 0;
-		s_abs_numer.flags = 0x00;
-		rp = Ehbi_set_or_malloc(&s_abs_numer, abs_numer_bytes,
-					Ehbi_bi_buf_size, numerator, err);
-		if (!rp) {
-			return NULL;
-		}
-		ehbi_negate(&s_abs_numer);
-		abs_numer = &s_abs_numer;
+	if (bi == val) {
+		return bi;
 	}
+	ehbi_sign_set(bi, ehbi_sign(val));
+	bi->bytes_used = val->bytes_used;
 
-	if (ehbi_sign(denominator) == 0) {
-		abs_denom = denominator;
-	} else {
-		s_abs_denom.bytes_used = 0;
-		s_abs_denom.bytes_len = 0;
-		s_abs_denom.flags = 0x00;
-		rp = Ehbi_set_or_malloc(&s_abs_denom, abs_denom_bytes,
-					Ehbi_bi_buf_size, denominator, err);
-		if (!rp) {
-			goto ehbi_div_end;
-		}
-		ehbi_negate(&s_abs_denom);
-		abs_denom = &s_abs_denom;
-	}
+	/* val may be a slice of bi, or of the bytes bi is a slice of */
+	eembed_memmove(bi->bytes, val->bytes, val->bytes_used);
 
-	/* just early return if abs_denom is bigger than abs_numer */
-	if (ehbi_greater_than(abs_denom, abs_numer)) {
-		ehbi_zero(quotient);
-		rp = ehbi_set(remainder, abs_numer, err);
-		goto ehbi_div_end;
-	}
+	return bi;
+
+ehbi_set_error:
+	ehbi_zero(bi);
+	return NULL;
+}
 
-	/* base 256 "long division" */
+struct ehbigint *ehbi_swap(struct ehbigint *a, struct ehbigint *b, int *err)
+{
+	unsigned char *bytes;
+	unsigned char byte;
+	size_t i, len, used;
+	unsigned sign;
 
-	if (ehbi_equals(abs_denom, quotient)) {
-		Ehbi_log_error0("denominator == 0");
-		ehbi_set_error(err, EHBI_DIVIDE_BY_ZERO);
-		goto ehbi_div_end;
+	Ehbi_assert_bi(a);
+	Ehbi_assert_bi(b);
+
+	if (a == b) {
+		return a;
 	}
 
-	num_idx = abs_numer->bytes_len - abs_numer->bytes_used;
-	for (i = 0; i < abs_denom->bytes_used; ++i) {
-		if (!ehbi_is_zero(remainder)) {
-			overflow = 0;
-			rp = ehbi_shift_left(remainder, EEMBED_CHAR_BIT,
-					     &overflow);
-			if (overflow) {
-				rp = NULL;
-				goto ehbi_div_end;
-			}
+	sign = ehbi_sign(a);
+	used = a->bytes_used;
+
+	/* the byte[]s belong to neither struct, so may change hands */
+	if (ehbi_flag(a, ehbi_flag_heap) && ehbi_flag(b, ehbi_flag_heap)) {
+		bytes = a->bytes;
+		len = a->bytes_len;
+		a->bytes = b->bytes;
+		a->bytes_len = b->bytes_len;
+		b->bytes = bytes;
+		b->bytes_len = len;
+	} else {
+		if (!ehbi_reserve(a, b->bytes_used, err)
+		    || !ehbi_reserve(b, a->bytes_used, err)) {
+			return NULL;
 		}
-		rp = ehbi_inc_l(remainder, abs_numer->bytes[num_idx++], err);
-		if (!rp) {
-			goto ehbi_div_end;
+		if (a->bytes_len < b->bytes_used
+		    || b->bytes_len < a->bytes_used) {
+			Ehbi_log_error_s_ul_s_ul_s("byte[", a->bytes_len,
+						   "] and byte[", b->bytes_len,
+						   "] too small to swap");
+			ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+			return NULL;
 		}
-	}
-	if (ehbi_greater_than(abs_denom, remainder)) {
-		overflow = 0;
-		rp = ehbi_shift_left(remainder, EEMBED_CHAR_BIT, &overflow);
-		if (overflow) {
-			rp = NULL;
-			goto ehbi_div_end;
+		len = (a->bytes_used < b->bytes_used) ? a->bytes_used
+		    : b->bytes_used;
+		for (i = 0; i < len; ++i) {
+			byte = a->bytes[i];
+			a->bytes[i] = b->bytes[i];
+			b->bytes[i] = byte;
 		}
-		rp = ehbi_inc_l(remainder, abs_numer->bytes[num_idx++], err);
-		if (!rp) {
-			goto ehbi_div_end;
+		if (a->bytes_used > len) {
+			eembed_memcpy(b->bytes + len, a->bytes + len,
+				      a->bytes_used - len);
+		} else if (b->bytes_used > len) {
+			eembed_memcpy(a->bytes + len, b->bytes + len,
+				      b->bytes_used - len);
 		}
 	}
 
-	i = 0;
-	while (ehbi_greater_than(remainder, abs_denom)
-	       || ehbi_equals(remainder, abs_denom)) {
-		rp = ehbi_inc_l(quotient, 1, err);
-		if (!rp) {
-			goto ehbi_div_end;
-		}
-		rp = ehbi_dec(remainder, abs_denom, err);
-		if (!rp) {
-			goto ehbi_div_end;
-		}
-		while (ehbi_less_than(remainder, abs_denom)
-		       && (num_idx < abs_numer->bytes_len)) {
-			overflow = 0;
-			rp = ehbi_shift_left(quotient, EEMBED_CHAR_BIT,
-					     &overflow);
-			if (overflow) {
-				rp = NULL;
-				goto ehbi_div_end;
-			}
+	a->bytes_used = b->bytes_used;
+	b->bytes_used = used;
+	ehbi_sign_set(a, ehbi_sign(b));
+	ehbi_sign_set(b, sign);
 
-			rp = ehbi_shift_left(remainder, EEMBED_CHAR_BIT,
-					     &overflow);
-			if (overflow) {
-				rp = NULL;
-				goto ehbi_div_end;
-			}
-			remainder->bytes[remainder->bytes_len - 1] =
-			    abs_numer->bytes[num_idx++];
-		}
-	}
+	return a;
+}
 
-	if (ehbi_sign(numerator) != ehbi_sign(denominator)) {
-		ehbi_sign_set(quotient, 1);
-	}
+struct ehbigint *ehbi_move(struct ehbigint *dst, struct ehbigint *src,
+			   int *err)
+{
+	Ehbi_assert_bi(dst);
+	Ehbi_assert_bi(src);
 
-ehbi_div_end:
-	ehbi_set_or_malloc_free(&s_abs_denom, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&s_abs_numer, Ehbi_bi_buf_size);
+	if (dst == src) {
+		return dst;
+	}
 
-	/* if error, let's not return garbage or 1/2 an answer */
-	if (!rp) {
-		ehbi_zero(quotient);
-		ehbi_zero(remainder);
+	if (ehbi_flag(dst, ehbi_flag_heap) && ehbi_flag(src, ehbi_flag_heap)) {
+		ehbi_swap(dst, src, err);
+	} else if (!ehbi_set(dst, src, err)) {
 		return NULL;
 	}
-	return quotient;
+	ehbi_zero(src);
+
+	return dst;
 }
 
-struct ehbigint *ehbi_div_l(struct ehbigint *quotient,
-			    struct ehbigint *remainder,
-			    const struct ehbigint *numerator, long denominator,
-			    int *err)
+struct ehbigint *ehbi_set_big_endian(struct ehbigint *bi,
+				     const unsigned char *bytes, size_t len,
+				     int *err)
 {
-	unsigned char bytes[sizeof(unsigned long)];
-	struct ehbigint temp;
-
-	ehbi_internal_clear_null_struct(&temp);
+	size_t i;
 
-	temp.bytes = bytes;
-	temp.bytes_len = sizeof(unsigned long);
-	ehbi_internal_struct_l(&temp, denominator);
+	Ehbi_assert_bi(bi);
 
-	return ehbi_div(quotient, remainder, numerator, &temp, err);
-}
+	if (len && !bytes) {
+		Ehbi_log_error0("Null bytes");
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		goto ehbi_set_big_endian_error;
+	}
 
-struct ehbigint *ehbi_sqrt(struct ehbigint *result, struct ehbigint *remainder,
-			   const struct ehbigint *val, int *err)
-{
-	struct ehbigint zero, one, two;
-	struct ehbigint guess, temp, junk;
-	unsigned char zbytes[2];
-	unsigned char obytes[2];
-	unsigned char tbytes[2];
-	struct ehbigint *rp;
-	unsigned char gues_bytes[Ehbi_bi_buf_size];
-	unsigned char temp_bytes[Ehbi_bi_buf_size];
-	unsigned char junk_bytes[Ehbi_bi_buf_size];
+	/* skip leading zeros */
+	while (len && bytes[0] == 0x00) {
+		++bytes;
+		--len;
+	}
 
-	rp = NULL;
-	ehbi_internal_clear_null_struct(&zero);
-	ehbi_internal_clear_null_struct(&one);
-	ehbi_internal_clear_null_struct(&two);
-	ehbi_internal_clear_null_struct(&guess);
-	ehbi_internal_clear_null_struct(&temp);
-	ehbi_internal_clear_null_struct(&junk);
+	if (!ehbi_reserve(bi, len, err)) {
+		goto ehbi_set_big_endian_error;
+	}
+	if (len > bi->bytes_len) {
+		Ehbi_log_error_s_ul_s_ul_s("Result byte[", bi->bytes_len,
+					   "] too small (", len, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		goto ehbi_set_big_endian_error;
+	}
 
-	zero.bytes = zbytes;
-	zero.bytes_len = 2;
-	ehbi_zero(&zero);
+	for (i = 0; i < len; ++i) {
+		bi->bytes[i] = bytes[(len - 1) - i];
+	}
+	bi->bytes_used = len;
+	if (bi->bytes_used == 0) {
+		bi->bytes[0] = 0x00;
+		bi->bytes_used = 1;
+	}
+	ehbi_sign_set(bi, 0);
 
-	one.bytes = obytes;
-	one.bytes_len = 2;
-	ehbi_zero(&one);
-	ehbi_inc_l(&one, 1, err);
+	return bi;
 
-	two.bytes = tbytes;
-	two.bytes_len = 2;
-	ehbi_zero(&two);
-	ehbi_inc_l(&two, 2, err);
+ehbi_set_big_endian_error:
+	ehbi_zero(bi);
+	return NULL;
+}
 
-	ehbi_zero(result);
+unsigned char *ehbi_to_big_endian(const struct ehbigint *bi,
+				  unsigned char *buf, size_t buf_len, int *err)
+{
+	size_t i, offset;
 
-	ehbi_zero(remainder);
+	Ehbi_assert_bi(bi);
 
-	if (ehbi_less_than(val, &zero)) {
-		Ehbi_log_error0("square root of a negative would be complex");
-		ehbi_set_error(err, EHBI_SQRT_NEGATIVE);
+	if (buf == NULL) {
+		Ehbi_log_error0("Null buffer");
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		return NULL;
+	}
+	if (buf_len < bi->bytes_used) {
+		Ehbi_log_error_s_ul_s_ul_s("buf[", buf_len, "] too small (",
+					   bi->bytes_used, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
 		return NULL;
 	}
 
-	if (ehbi_equals(val, &zero)) {
-		return result;
+	offset = buf_len - bi->bytes_used;
+	eembed_memset(buf, 0x00, offset);
+	for (i = 0; i < bi->bytes_used; ++i) {
+		buf[offset + i] = bi->bytes[(bi->bytes_used - 1) - i];
 	}
 
-	Ehbi_assert_bi(val);
+	return buf;
+}
 
-	rp = Ehbi_set_or_malloc(&guess, gues_bytes, Ehbi_bi_buf_size, val, err);
-	if (!rp) {
-		return NULL;
-	}
-	rp = Ehbi_set_or_malloc(&temp, temp_bytes, Ehbi_bi_buf_size, val, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
-	}
-	rp = Ehbi_set_or_malloc(&junk, junk_bytes, Ehbi_bi_buf_size, val, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
-	}
+/*
+   a serialized ehbigint is a header byte, holding the version in the high
+   nibble, a batch flag and the sign, followed by the count of magnitude
+   bytes as an unsigned LEB128 varint, then the bytes, least significant
+   first; zero has a count of zero, and thus no bytes
+*/
+#define Ehbi_serial_flag_sign 0x01
+#define Ehbi_serial_flag_batch 0x02
+#define Ehbi_serial_offset_size 4
 
-	/* odd cases below square root of 4 */
-	rp = ehbi_set_l(&temp, 4, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
-	}
-	if (ehbi_less_than(val, &temp)) {
-		rp = ehbi_set_l(result, 1, err);
-		if (!rp) {
-			goto ehbi_sqrt_end;
-		}
-		rp = ehbi_subtract(remainder, val, result, err);
-		goto ehbi_sqrt_end;
-	}
+/* seven bits a byte, least significant first, the high bit means more */
+static size_t ehbi_varint_size(size_t val)
+{
+	size_t size;
 
-	/* Initial estimate, never low */
-	/* result = (val / 2) + 1; */
-	rp = ehbi_div(result, &junk, val, &two, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
-	}
-	rp = ehbi_inc(result, &one, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
+	for (size = 1; val > 0x7F; ++size) {
+		val = val >> 7;
 	}
+	return size;
+}
 
-	/* guess = (result + (val / result)) / 2; */
-	rp = ehbi_div(&temp, &junk, val, result, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
-	}
-	rp = ehbi_inc(&temp, result, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
-	}
-	rp = ehbi_div(&guess, &junk, &temp, &two, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
+static size_t ehbi_varint_put(unsigned char *buf, size_t val)
+{
+	size_t i;
+
+	for (i = 0; val > 0x7F; ++i) {
+		buf[i] = (unsigned char)(0x80 | (val & 0x7F));
+		val = val >> 7;
 	}
+	buf[i++] = (unsigned char)val;
 
-	while (ehbi_less_than(&guess, result)) {
-		/* result = guess; */
-		rp = ehbi_set(result, &guess, err);
-		if (!rp) {
-			goto ehbi_sqrt_end;
-		}
+	return i;
+}
 
-		/* guess = (result + (val / result)) / 2; */
-		rp = ehbi_div(&temp, &junk, val, result, err);
-		if (!rp) {
-			goto ehbi_sqrt_end;
-		}
-		rp = ehbi_inc(&temp, result, err);
-		if (!rp) {
-			goto ehbi_sqrt_end;
+/* returns the bytes read, or 0 if truncated or too big for a size_t */
+static size_t ehbi_varint_get(const unsigned char *buf, size_t len,
+			      size_t *val)
+{
+	size_t i, shift, bits, part;
+
+	bits = sizeof(size_t) * EEMBED_CHAR_BIT;
+	*val = 0;
+	for (i = 0, shift = 0; i < len; ++i, shift += 7) {
+		part = buf[i] & 0x7F;
+		if (part) {
+			if (shift >= bits || (shift > (bits - 7)
+					      && (part >> (bits - shift)))) {
+				return 0;
+			}
+			*val = *val | (part << shift);
 		}
-		rp = ehbi_div(&guess, &junk, &temp, &two, err);
-		if (!rp) {
-			goto ehbi_sqrt_end;
+		if (!(buf[i] & 0x80)) {
+			return i + 1;
 		}
 	}
-	rp = ehbi_mul(&temp, result, result, err);
-	if (!rp) {
-		goto ehbi_sqrt_end;
-	}
-	rp = ehbi_subtract(remainder, val, &temp, err);
+	return 0;
+}
 
-ehbi_sqrt_end:
-	ehbi_set_or_malloc_free(&guess, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&temp, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&junk, Ehbi_bi_buf_size);
+static size_t ehbi_serial_count(const struct ehbigint *bi)
+{
+	return ehbi_is_zero(bi) ? 0 : bi->bytes_used;
+}
 
-	if (!rp) {
-		ehbi_zero(result);
-		ehbi_zero(remainder);
-		return NULL;
-	}
+size_t ehbi_serialized_size(const struct ehbigint *bi)
+{
+	size_t count;
 
-	return result;
+	Ehbi_assert_bi(bi);
+
+	count = ehbi_serial_count(bi);
+
+	return 1 + ehbi_varint_size(count) + count;
 }
 
-struct ehbigint *ehbi_exp(struct ehbigint *result, const struct ehbigint *base,
-			  const struct ehbigint *exponent, int *err)
+/* the caller has checked that the buf is big enough */
+static size_t ehbi_serial_put(const struct ehbigint *bi, unsigned char *buf)
 {
-	struct ehbigint loop;
-	struct ehbigint tmp;
-	struct ehbigint *rp;
-	unsigned char lbytes[Ehbi_bi_buf_size];
-	unsigned char tbytes[Ehbi_bi_buf_size];
+	size_t count, pos;
 
-	rp = NULL;
-	ehbi_internal_clear_null_struct(&loop);
-
-	rp = Ehbi_set_or_malloc(&loop, lbytes, Ehbi_bi_buf_size, exponent, err);
-	if (!rp) {
-		goto ehbi_exp_end;
+	count = ehbi_serial_count(bi);
+	pos = 0;
+	buf[pos] = (unsigned char)(EHBI_SERIAL_VERSION << 4);
+	if (ehbi_is_negative(bi)) {
+		buf[pos] |= Ehbi_serial_flag_sign;
 	}
-	rp = Ehbi_set_or_malloc(&tmp, tbytes, Ehbi_bi_buf_size, result, err);
-	if (!rp) {
-		goto ehbi_exp_end;
+	++pos;
+	pos += ehbi_varint_put(buf + pos, count);
+	if (count) {
+		eembed_memcpy(buf + pos, bi->bytes, count);
 	}
 
-	rp = ehbi_zero(&loop);
-	if (!rp) {
-		goto ehbi_exp_end;
-	}
-	rp = ehbi_set_l(result, 1, err);
-	if (!rp) {
-		goto ehbi_exp_end;
-	}
+	return pos + count;
+}
 
-	while (ehbi_less_than(&loop, exponent)) {
-		rp = ehbi_mul(&tmp, result, base, err);
-		if (!rp) {
-			goto ehbi_exp_end;
-		}
-		rp = ehbi_set(result, &tmp, err);
-		if (!rp) {
-			goto ehbi_exp_end;
-		}
-		rp = ehbi_inc_l(&loop, 1, err);
-		if (!rp) {
-			goto ehbi_exp_end;
-		}
-	}
+size_t ehbi_serialize(const struct ehbigint *bi, unsigned char *buf,
+		      size_t buf_len, int *err)
+{
+	size_t need;
 
-ehbi_exp_end:
-	ehbi_set_or_malloc_free(&loop, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&tmp, Ehbi_bi_buf_size);
+	Ehbi_assert_bi(bi);
 
-	if (!rp) {
-		ehbi_zero(result);
+	if (buf == NULL) {
+		Ehbi_log_error0("Null buffer");
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		return 0;
+	}
+	need = ehbi_serialized_size(bi);
+	if (buf_len < need) {
+		Ehbi_log_error_s_ul_s_ul_s("buf[", buf_len, "] too small (",
+					   need, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
 		return 0;
 	}
 
-	return result;
+	return ehbi_serial_put(bi, buf);
 }
 
-struct ehbigint *ehbi_exp_l(struct ehbigint *result,
-			    const struct ehbigint *base, long exp, int *err)
+/* checks the version and flags, returns the position after the header */
+static size_t ehbi_serial_header(const unsigned char *buf, size_t buf_len,
+				 unsigned char flags, size_t *count, int *err)
 {
-	unsigned char bytes[sizeof(unsigned long)];
-	struct ehbigint temp;
-
-	ehbi_internal_clear_null_struct(&temp);
+	size_t pos;
 
-	temp.bytes = bytes;
-	temp.bytes_len = sizeof(unsigned long);
-	ehbi_internal_struct_l(&temp, exp);
+	if (buf == NULL) {
+		Ehbi_log_error0("Null buffer");
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		return 0;
+	}
+	if (buf_len < 2 || (buf[0] >> 4) != EHBI_SERIAL_VERSION
+	    || (buf[0] & 0x0F & ~(Ehbi_serial_flag_sign
+				  | Ehbi_serial_flag_batch)) != 0
+	    || (buf[0] & Ehbi_serial_flag_batch) != flags) {
+		Ehbi_log_error_s_ul_s("Not a serialized ehbigint? (",
+				      buf_len ? buf[0] : 0UL, ")");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
+	}
+	pos = ehbi_varint_get(buf + 1, buf_len - 1, count);
+	if (pos == 0) {
+		Ehbi_log_error0("Bad count");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
+	}
 
-	return ehbi_exp(result, base, &temp, err);
+	return 1 + pos;
 }
 
-struct ehbigint *ehbi_exp_mod(struct ehbigint *result,
-			      const struct ehbigint *base,
-			      const struct ehbigint *exponent,
-			      const struct ehbigint *modulus, int *err)
+struct ehbigint *ehbi_deserialize(struct ehbigint *bi,
+				  const unsigned char *buf, size_t buf_len,
+				  size_t *used, int *err)
 {
-	size_t size;
-	struct ehbigint zero, tmp1, tjunk, texp, tbase;
-	struct ehbigint *rp;
-	unsigned char zero_bytes[2];
-	unsigned char t1_bytes[Ehbi_bi_buf_size];
-	unsigned char tb_bytes[Ehbi_bi_buf_size];
-	unsigned char te_bytes[Ehbi_bi_buf_size];
-	unsigned char tj_bytes[Ehbi_bi_buf_size];
-
-	ehbi_internal_clear_null_struct(&zero);
-	ehbi_internal_clear_null_struct(&tmp1);
-	ehbi_internal_clear_null_struct(&tbase);
-	ehbi_internal_clear_null_struct(&texp);
-	ehbi_internal_clear_null_struct(&tjunk);
-	rp = NULL;
-
-	Ehbi_assert_bi(result);
-	ehbi_zero(result);
-	Ehbi_assert_bi(base);
-	Ehbi_assert_bi(exponent);
-	Ehbi_assert_bi(modulus);
-	ehbi_init(&zero, zero_bytes, 2);
+	size_t pos, count, end;
 
-	/* cheating on result->bytes_used */
-	size = 8 + (4 * base->bytes_used) + (4 * exponent->bytes_used);
-	result->bytes_used = size;
+	Ehbi_assert_bi(bi);
 
-	rp = Ehbi_set_or_malloc(&tmp1, t1_bytes, Ehbi_bi_buf_size, result, err);
-	if (!rp) {
-		ehbi_zero(result);
-		return NULL;
+	pos = ehbi_serial_header(buf, buf_len, 0, &count, err);
+	if (pos == 0) {
+		goto ehbi_deserialize_error;
 	}
-	rp = Ehbi_set_or_malloc(&tbase, tb_bytes, Ehbi_bi_buf_size, result,
-				err);
-	if (!rp) {
-		goto ehbi_mod_exp_end;
+	if (count > buf_len - pos) {
+		Ehbi_log_error_s_ul_s_ul_s("buf[", buf_len, "] truncated (",
+					   pos + count, ")");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		goto ehbi_deserialize_error;
 	}
-	rp = Ehbi_set_or_malloc(&texp, te_bytes, Ehbi_bi_buf_size, result, err);
-	if (!rp) {
-		goto ehbi_mod_exp_end;
+	end = pos + count;
+
+	/* leading zero bytes are not written, but need not be trusted */
+	while (count && buf[pos + count - 1] == 0x00) {
+		--count;
 	}
-	rp = Ehbi_set_or_malloc(&tjunk, tj_bytes, Ehbi_bi_buf_size, result,
-				err);
-	if (!rp) {
-		goto ehbi_mod_exp_end;
+	if (!ehbi_reserve(bi, count, err)) {
+		goto ehbi_deserialize_error;
 	}
-	ehbi_zero(result);
-
-	/* prevent divide by zero */
-	ehbi_zero(&tmp1);
-	if (ehbi_equals(modulus, &tmp1)) {
-		Ehbi_log_error0("modulus == 0");
-		ehbi_set_error(err, EHBI_DIVIDE_BY_ZERO);
-		goto ehbi_mod_exp_end;
+	if (count > bi->bytes_len) {
+		Ehbi_log_error_s_ul_s_ul_s("Result byte[", bi->bytes_len,
+					   "] too small (", count, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		goto ehbi_deserialize_error;
 	}
 
-	/* prevent negative eponent */
-	if (ehbi_is_negative(exponent)) {
-		Ehbi_log_error0("exponent < 0");
-		ehbi_set_error(err, EHBI_BAD_DATA);
-		goto ehbi_mod_exp_end;
+	ehbi_zero(bi);
+	if (count) {
+		eembed_memcpy(bi->bytes, buf + pos, count);
+		bi->bytes_used = count;
+		ehbi_sign_set(bi, buf[0] & Ehbi_serial_flag_sign);
 	}
+	Ehbi_assert_normal(bi);
 
-	/*
-	   The following is an example in pseudocode based on Applied
-	   Cryptography: Protocols, Algorithms, and Source Code in C,
-	   Second Edition (2nd ed.), page 244.
-	   Schneier, Bruce (1996). Wiley. ISBN 978-0-471-11709-4.
+	if (used) {
+		*used = end;
+	}
+	return bi;
 
-	   function modular_pow(base, exponent, modulus)
-	   if modulus = 1 then return 0
-	   Assert :: (modulus - 1) * (modulus - 1) does not overflow base
-	   result := 1
-	   base := base mod modulus
-	   while exponent > 0
-	   if (exponent mod 2 == 1):
-	   result := (result * base) mod modulus
-	   exponent := exponent >> 1
-	   base := (base * base) mod modulus
-	   return result
+ehbi_deserialize_error:
+	ehbi_zero(bi);
+	return NULL;
+}
 
-	   See Also:
-	   https://en.wikipedia.org/wiki/Modular_exponentiation#Right-to-left_binary_method
-	 */
+/*
+   a batch is a header byte with the batch flag, the count of values as a
+   varint, then a table of 4 byte little-endian offsets from the start of
+   the buffer, one per value, followed by the values, each as serialized
+   by ehbi_serialize
+*/
+size_t ehbi_serialized_batch_size(const struct ehbigint *const *bis,
+				  size_t count)
+{
+	size_t i, size;
 
-	/* if modulus == 1 then return 0 */
-	rp = ehbi_set_l(&tmp1, 1, err);
-	if (!rp) {
-		goto ehbi_mod_exp_end;
+	size = 1 + ehbi_varint_size(count) + (count * Ehbi_serial_offset_size);
+	for (i = 0; i < count; ++i) {
+		size += ehbi_serialized_size(bis[i]);
 	}
 
-	if (ehbi_equals(modulus, &tmp1)) {
-		ehbi_zero(result);
-		goto ehbi_mod_exp_end;
-	}
+	return size;
+}
 
-	rp = ehbi_set(&tbase, base, err);
-	if (!rp) {
-		goto ehbi_mod_exp_end;
-	}
-	rp = ehbi_set(&texp, exponent, err);
-	if (!rp) {
-		goto ehbi_mod_exp_end;
-	}
+size_t ehbi_serialize_batch(const struct ehbigint *const *bis, size_t count,
+			    unsigned char *buf, size_t buf_len, int *err)
+{
+	size_t i, j, pos, table, need;
+	unsigned long offset;
 
-	/* result := 1 */
-	rp = ehbi_set_l(result, 1, err);
-	if (!rp) {
-		goto ehbi_mod_exp_end;
+	if (buf == NULL || (count && bis == NULL)) {
+		Ehbi_log_error0("Null Arguments(s)");
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		return 0;
 	}
-
-	/* base := base mod modulus */
-	rp = ehbi_div(&tjunk, &tbase, base, modulus, err);
-	if (!rp) {
-		goto ehbi_mod_exp_end;
+	need = ehbi_serialized_batch_size(bis, count);
+	if (buf_len < need) {
+		Ehbi_log_error_s_ul_s_ul_s("buf[", buf_len, "] too small (",
+					   need, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		return 0;
+	}
+	/* the last offset is what must fit in the table */
+	if (count && (need - ehbi_serialized_size(bis[count - 1]))
+	    > 0xFFFFFFFFUL) {
+		Ehbi_log_error0("Batch too big for the offsets");
+		ehbi_set_error(err, EHBI_BAD_INPUT);
+		return 0;
 	}
 
-	/* while exponent > 0 */
-	while (ehbi_greater_than(&texp, &zero)) {
-		/* if (exponent mod 2 == 1): */
-		if (ehbi_is_odd(&texp)) {
-			/* result := (result * base) mod modulus */
-			rp = ehbi_mul(&tmp1, result, &tbase, err);
-			if (!rp) {
-				goto ehbi_mod_exp_end;
-			}
-			rp = ehbi_div(&tjunk, result, &tmp1, modulus, err);
-			if (!rp) {
-				goto ehbi_mod_exp_end;
-			}
-		}
-
-		/* exponent := exponent >> 1 */
-		ehbi_shift_right(&texp, 1);
-
-		/* base := (base * base) mod modulus */
-		rp = ehbi_mul(&tmp1, &tbase, &tbase, err);
-		if (!rp) {
-			goto ehbi_mod_exp_end;
-		}
-		rp = ehbi_div(&tjunk, &tbase, &tmp1, modulus, err);
-		if (!rp) {
-			goto ehbi_mod_exp_end;
+	pos = 0;
+	buf[pos++] = (unsigned char)((EHBI_SERIAL_VERSION << 4)
+				     | Ehbi_serial_flag_batch);
+	pos += ehbi_varint_put(buf + pos, count);
+	table = pos;
+	pos += count * Ehbi_serial_offset_size;
+	for (i = 0; i < count; ++i) {
+		offset = (unsigned long)pos;
+		for (j = 0; j < Ehbi_serial_offset_size; ++j) {
+			buf[table++] = (unsigned char)(offset & 0xFF);
+			offset = offset >> EEMBED_CHAR_BIT;
 		}
+		pos += ehbi_serial_put(bis[i], buf + pos);
 	}
 
-	/* return result */
+	return pos;
+}
 
-ehbi_mod_exp_end:
-	ehbi_set_or_malloc_free(&tmp1, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&tbase, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&texp, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&tjunk, Ehbi_bi_buf_size);
+size_t ehbi_serialized_batch_count(const unsigned char *buf, size_t buf_len,
+				   int *err)
+{
+	size_t pos, count;
 
-	if (!rp) {
-		ehbi_zero(result);
-		return NULL;
+	pos = ehbi_serial_header(buf, buf_len, Ehbi_serial_flag_batch, &count,
+				 err);
+	if (pos == 0) {
+		return 0;
+	}
+	if (count > (buf_len - pos) / Ehbi_serial_offset_size) {
+		Ehbi_log_error_s_ul_s("Offset table truncated (", count, ")");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
 	}
 
-	return result;
+	return count;
 }
 
-struct ehbigint *ehbi_exp_mod_l(struct ehbigint *result,
-				const struct ehbigint *base,
-				const struct ehbigint *exponent, long modulus,
-				int *err)
+struct ehbigint *ehbi_deserialize_batch(struct ehbigint *bi,
+					const unsigned char *buf,
+					size_t buf_len, size_t index, int *err)
 {
-	unsigned char bytes[sizeof(unsigned long)];
-	struct ehbigint temp;
+	size_t i, pos, count;
+	unsigned long offset;
 
-	ehbi_internal_clear_null_struct(&temp);
+	Ehbi_assert_bi(bi);
 
-	temp.bytes = bytes;
-	temp.bytes_len = sizeof(unsigned long);
+	pos = ehbi_serial_header(buf, buf_len, Ehbi_serial_flag_batch, &count,
+				 err);
+	if (pos == 0) {
+		goto ehbi_deserialize_batch_error;
+	}
+	if (index >= count) {
+		Ehbi_log_error_s_ul_s_ul_s("index ", index, " not less than ",
+					   count, "");
+		ehbi_set_error(err, EHBI_BAD_INPUT);
+		goto ehbi_deserialize_batch_error;
+	}
+	if (index >= (buf_len - pos) / Ehbi_serial_offset_size) {
+		Ehbi_log_error_s_ul_s("Offset table truncated (", count, ")");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		goto ehbi_deserialize_batch_error;
+	}
 
-	ehbi_internal_struct_l(&temp, modulus);
+	pos += index * Ehbi_serial_offset_size;
+	offset = 0;
+	for (i = Ehbi_serial_offset_size; i > 0; --i) {
+		offset = (offset << EEMBED_CHAR_BIT) | buf[pos + i - 1];
+	}
+	if (offset >= buf_len) {
+		Ehbi_log_error_s_ul_s("Offset out of bounds (", offset, ")");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		goto ehbi_deserialize_batch_error;
+	}
 
-	return ehbi_exp_mod(result, base, exponent, &temp, err);
+	return ehbi_deserialize(bi, buf + offset, buf_len - offset, NULL,
+				err);
+
+ehbi_deserialize_batch_error:
+	ehbi_zero(bi);
+	return NULL;
 }
 
-struct ehbigint *ehbi_exp_mod_ll(struct ehbigint *result,
-				 const struct ehbigint *base, long exponent,
-				 long modulus, int *err)
+/* checks the arguments of ehbi_import and ehbi_export, and resolves 0 */
+static int ehbi_words_layout(int order, size_t size, int *endian,
+			     size_t nails, int *err)
 {
-	unsigned char bytes1[sizeof(unsigned long)];
-	struct ehbigint temp1;
-	unsigned char bytes2[sizeof(unsigned long)];
-	struct ehbigint temp2;
+	const unsigned int one = 1;
 
-	ehbi_internal_clear_null_struct(&temp1);
-	ehbi_internal_clear_null_struct(&temp2);
+	if ((order != 1 && order != -1) || size == 0
+	    || (*endian != 1 && *endian != -1 && *endian != 0)
+	    || nails >= (size * EEMBED_CHAR_BIT)) {
+		Ehbi_log_error_s_ul_s_ul_s("Bad word layout, size ", size,
+					   ", nails ", nails, "");
+		ehbi_set_error(err, EHBI_BAD_INPUT);
+		return 0;
+	}
+	if (*endian == 0) {
+		*endian = (*(const unsigned char *)&one) ? -1 : 1;
+	}
+	return 1;
+}
 
-	temp1.bytes = bytes1;
-	temp1.bytes_len = sizeof(unsigned long);
+/* the offset in data of the first byte of word w, least significant 0 */
+static size_t ehbi_word_offset(size_t count, int order, size_t size, size_t w)
+{
+	return ((order < 0) ? w : ((count - 1) - w)) * size;
+}
 
-	temp2.bytes = bytes2;
-	temp2.bytes_len = sizeof(unsigned long);
-
-	ehbi_internal_struct_l(&temp1, exponent);
-	ehbi_internal_struct_l(&temp2, modulus);
+/*
+   with nails, each word holds fewer bits than bytes, thus the bits of
+   the words are streamed through an accumulator, eight at a time
+*/
+static size_t ehbi_import_nails(unsigned char *bytes, size_t bytes_len,
+				size_t count, int order, size_t size,
+				int endian, size_t nails,
+				const unsigned char *src, int *overflow)
+{
+	size_t w, b, j, base, wbits, nb;
+	unsigned acc, bits, byte;
 
-	return ehbi_exp_mod(result, base, &temp1, &temp2, err);
+	wbits = (size * EEMBED_CHAR_BIT) - nails;
+	acc = 0;
+	bits = 0;
+	j = 0;
+	for (w = 0; w < count; ++w) {
+		base = ehbi_word_offset(count, order, size, w);
+		for (b = 0; (b * EEMBED_CHAR_BIT) < wbits; ++b) {
+			byte = src[base + ((endian < 0) ? b : (size - 1 - b))];
+			nb = wbits - (b * EEMBED_CHAR_BIT);
+			if (nb < EEMBED_CHAR_BIT) {
+				byte = byte & ((1U << nb) - 1);
+			} else {
+				nb = EEMBED_CHAR_BIT;
+			}
+			acc = acc | (byte << bits);
+			bits += (unsigned)nb;
+			if (bits >= EEMBED_CHAR_BIT) {
+				if (j < bytes_len) {
+					bytes[j++] = (unsigned char)acc;
+				} else if (acc & 0xFF) {
+					*overflow = 1;
+				}
+				acc = acc >> EEMBED_CHAR_BIT;
+				bits -= EEMBED_CHAR_BIT;
+			}
+		}
+	}
+	if (bits) {
+		if (j < bytes_len) {
+			bytes[j++] = (unsigned char)acc;
+		} else if (acc) {
+			*overflow = 1;
+		}
+	}
+	return j;
 }
 
-struct ehbigint *ehbi_inc(struct ehbigint *bi, const struct ehbigint *val,
-			  int *err)
+struct ehbigint *ehbi_import(struct ehbigint *bi, size_t count, int order,
+			     size_t size, int endian, size_t nails,
+			     const void *data, int *err)
 {
-	struct ehbigint temp;
-	struct ehbigint *rp;
-	unsigned char bytes[Ehbi_bi_buf_size];
-
-	ehbi_internal_clear_null_struct(&temp);
+	const unsigned char *src = (const unsigned char *)data;
+	size_t w, b, j, len, base;
+	int overflow;
 
 	Ehbi_assert_bi(bi);
-	Ehbi_assert_bi(val);
-	if (val->bytes_used > bi->bytes_len) {
-		Ehbi_log_error_s_ul_s_ul_s("byte[",
-					   bi->bytes_len,
-					   "] too small (",
-					   val->bytes_used, ")");
-		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
-		return NULL;
+
+	if (!ehbi_words_layout(order, size, &endian, nails, err)) {
+		goto ehbi_import_error;
+	}
+	if (count && !data) {
+		Ehbi_log_error0("Null data");
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		goto ehbi_import_error;
 	}
 
-	rp = Ehbi_set_or_malloc(&temp, bytes, Ehbi_bi_buf_size, bi, err);
-	if (!rp) {
-		return NULL;
+	len = count * ((size * EEMBED_CHAR_BIT) - nails);
+	len = (len / EEMBED_CHAR_BIT) + ((len % EEMBED_CHAR_BIT) ? 1 : 0);
+	if (!ehbi_reserve(bi, len, err)) {
+		goto ehbi_import_error;
 	}
-	rp = ehbi_add(bi, &temp, val, err);
+	ehbi_zero(bi);
 
-	ehbi_set_or_malloc_free(&temp, Ehbi_bi_buf_size);
-	if (!rp) {
-		return NULL;
+	/* high zero bytes need not fit, so long as they are zero */
+	overflow = 0;
+	if (nails) {
+		j = ehbi_import_nails(bi->bytes, bi->bytes_len, count, order,
+				      size, endian, nails, src, &overflow);
+	} else if (order < 0 && endian < 0) {
+		/* the same layout as the bytes of an ehbigint */
+		j = (len < bi->bytes_len) ? len : bi->bytes_len;
+		eembed_memcpy(bi->bytes, src, j);
+		for (w = j; w < len && !overflow; ++w) {
+			overflow = src[w] != 0x00;
+		}
+	} else {
+		/* each word is copied, reversed if big-endian */
+		for (j = 0, w = 0; w < count; ++w) {
+			base = ehbi_word_offset(count, order, size, w);
+			for (b = 0; b < size; ++b, ++j) {
+				src = (const unsigned char *)data + base
+				    + ((endian < 0) ? b : ((size - 1) - b));
+				if (j < bi->bytes_len) {
+					bi->bytes[j] = *src;
+				} else if (*src) {
+					overflow = 1;
+				}
+			}
+		}
+		if (j > bi->bytes_len) {
+			j = bi->bytes_len;
+		}
+	}
+	if (overflow) {
+		Ehbi_log_error_s_ul_s("Result byte[", bi->bytes_len,
+				      "] too small");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		goto ehbi_import_error;
+	}
+
+	while (j > 1 && bi->bytes[j - 1] == 0x00) {
+		--j;
+	}
+	bi->bytes_used = j ? j : 1;
+	if (j == 0) {
+		bi->bytes[0] = 0x00;
 	}
+	Ehbi_assert_normal(bi);
+
 	return bi;
+
+ehbi_import_error:
+	ehbi_zero(bi);
+	return NULL;
 }
 
-struct ehbigint *ehbi_inc_l(struct ehbigint *bi, long val, int *err)
+size_t ehbi_export_count(const struct ehbigint *bi, size_t size, size_t nails)
 {
-	unsigned char bytes[sizeof(unsigned long)];
-	struct ehbigint temp;
-
-	ehbi_internal_clear_null_struct(&temp);
+	size_t wbits;
 
-	temp.bytes = bytes;
-	temp.bytes_len = sizeof(unsigned long);
+	Ehbi_assert_bi(bi);
 
-	ehbi_internal_struct_l(&temp, val);
+	if (size == 0 || nails >= (size * EEMBED_CHAR_BIT)) {
+		return 0;
+	}
+	wbits = (size * EEMBED_CHAR_BIT) - nails;
 
-	return ehbi_inc(bi, &temp, err);
+	return (ehbi_bit_length(bi) + wbits - 1) / wbits;
 }
 
-struct ehbigint *ehbi_dec(struct ehbigint *bi, const struct ehbigint *val,
-			  int *err)
+void *ehbi_export(void *data, size_t data_len, size_t *countp, int order,
+		  size_t size, int endian, size_t nails,
+		  const struct ehbigint *bi, int *err)
 {
-	struct ehbigint temp;
-	struct ehbigint *rp;
-	unsigned char bytes[Ehbi_bi_buf_size];
-
-	ehbi_internal_clear_null_struct(&temp);
+	unsigned char *dest = (unsigned char *)data;
+	size_t w, b, k, count, base, wbits, nb, used;
+	unsigned acc, bits;
 
 	Ehbi_assert_bi(bi);
-	Ehbi_assert_bi(val);
 
-	rp = Ehbi_set_or_malloc(&temp, bytes, Ehbi_bi_buf_size, bi, err);
-	if (!rp) {
+	if (countp) {
+		*countp = 0;
+	}
+	if (!ehbi_words_layout(order, size, &endian, nails, err)) {
+		return NULL;
+	}
+	count = ehbi_export_count(bi, size, nails);
+	if (count && !data) {
+		Ehbi_log_error0("Null data");
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		return NULL;
+	}
+	if (count > data_len / size) {
+		Ehbi_log_error_s_ul_s_ul_s("data[", data_len, "] too small (",
+					   count * size, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
 		return NULL;
 	}
-	ehbi_zero(&temp);
 
-	rp = ehbi_subtract(&temp, bi, val, err);
-	if (!rp) {
-		goto ehbi_dec_end;
+	used = ehbi_is_zero(bi) ? 0 : bi->bytes_used;
+	if (nails) {
+		wbits = (size * EEMBED_CHAR_BIT) - nails;
+		acc = 0;
+		bits = 0;
+		k = 0;
+		for (w = 0; w < count; ++w) {
+			base = ehbi_word_offset(count, order, size, w);
+			for (b = 0; b < size; ++b) {
+				nb = 0;
+				if ((b * EEMBED_CHAR_BIT) < wbits) {
+					nb = wbits - (b * EEMBED_CHAR_BIT);
+				}
+				if (nb > EEMBED_CHAR_BIT) {
+					nb = EEMBED_CHAR_BIT;
+				}
+				if (bits < nb) {
+					acc = acc | (((unsigned)((k < used)
+								 ? bi->bytes[k]
+								 : 0)) << bits);
+					++k;
+					bits += EEMBED_CHAR_BIT;
+				}
+				dest[base + ((endian < 0) ? b : (size - 1 - b))]
+				    = (unsigned char)(acc & ((1U << nb) - 1));
+				acc = acc >> nb;
+				bits -= (unsigned)nb;
+			}
+		}
+	} else if (order < 0 && endian < 0) {
+		/* the same layout as the bytes of an ehbigint */
+		eembed_memcpy(dest, bi->bytes, used);
+		eembed_memset(dest + used, 0x00, (count * size) - used);
+	} else {
+		/* each word is copied, reversed if big-endian */
+		for (k = 0, w = 0; w < count; ++w) {
+			base = ehbi_word_offset(count, order, size, w);
+			for (b = 0; b < size; ++b, ++k) {
+				dest[base + ((endian < 0) ? b : (size - 1 - b))]
+				    = (k < used) ? bi->bytes[k] : 0x00;
+			}
+		}
+	}
+
+	if (countp) {
+		*countp = count;
 	}
-	rp = ehbi_set(bi, &temp, err);
+	return data;
+}
+
+int ehbi_is_zero(const struct ehbigint *bi)
+{
+	Ehbi_assert_bi(bi);
 
-ehbi_dec_end:
-	ehbi_set_or_malloc_free(&temp, Ehbi_bi_buf_size);
+	return (bi->bytes_used <= 1 && bi->bytes[0] == 0x00);
+}
 
-	if (!rp) {
+static unsigned char *ehbi_scratch_take(struct ehbi_scratch *s, size_t need)
+{
+	unsigned char *bytes;
+
+	if (!s) {
+		return NULL;
+	}
+	if (s->bytes_peak < s->bytes_used + s->bytes_spilled + need) {
+		s->bytes_peak = s->bytes_used + s->bytes_spilled + need;
+	}
+	if (!s->bytes || need > (s->bytes_len - s->bytes_used)) {
 		return NULL;
 	}
+	bytes = s->bytes + s->bytes_used;
+	s->bytes_used += need;
+	return bytes;
+}
 
-	return bi;
+#ifndef EHBI_SKIP_THREAD_CACHE
+/* when no scratch is passed in, temporaries which do not fit in the stack
+   buffer are taken from this cache rather than from malloc; the cache is
+   grown to the peak usage at a moment when none of its bytes are in use;
+   the allocator which first allocated the bytes is kept, and is used for
+   each realloc and free, as the eembed_global_allocator may be changed,
+   e.g.: to the ehbi_pool_allocator, after the cache is in use */
+struct ehbi_thread_cache {
+	struct ehbi_scratch s;
+	struct eembed_allocator *ea;
+};
+
+static EHBI_THREAD_LOCAL struct ehbi_thread_cache ehbi_thread_cache;
+#define Ehbi_thread_cache (&ehbi_thread_cache.s)
+
+static struct ehbi_scratch *ehbi_thread_cache_get(size_t need)
+{
+	struct ehbi_scratch *c = &ehbi_thread_cache.s;
+	struct eembed_allocator *ea;
+	unsigned char *bytes;
+	size_t len;
+
+	len = (c->bytes_peak > need) ? c->bytes_peak : need;
+	if (c->bytes_used == 0 && c->bytes_spilled == 0 && c->bytes_len < len) {
+		if (!c->bytes) {
+			ehbi_thread_cache.ea = eembed_global_allocator;
+		}
+		ea = ehbi_thread_cache.ea;
+		bytes = (unsigned char *)ea->realloc(ea, c->bytes, len);
+		if (bytes) {
+			c->bytes = bytes;
+			c->bytes_len = len;
+		}
+	}
+	return c;
 }
 
-struct ehbigint *ehbi_dec_l(struct ehbigint *bi, long val, int *err)
+void ehbi_thread_cache_release(void)
 {
-	unsigned char bytes[sizeof(unsigned long)];
-	struct ehbigint temp;
+	struct eembed_allocator *ea = ehbi_thread_cache.ea;
+	struct ehbi_scratch *c = &ehbi_thread_cache.s;
 
-	ehbi_internal_clear_null_struct(&temp);
+	eembed_assert(c->bytes_used == 0);
 
-	temp.bytes = bytes;
-	temp.bytes_len = sizeof(unsigned long);
-	ehbi_internal_struct_l(&temp, val);
+	if (c->bytes) {
+		ea->free(ea, c->bytes);
+	}
+	ehbi_scratch_init(c, NULL, 0);
+	ehbi_thread_cache.ea = NULL;
+}
 
-	return ehbi_dec(bi, &temp, err);
+size_t ehbi_thread_cache_size(void)
+{
+	return ehbi_thread_cache.s.bytes_len;
 }
+#else
+#define Ehbi_thread_cache NULL
+#define ehbi_thread_cache_get(need) NULL
+#endif /* EHBI_SKIP_THREAD_CACHE */
 
-struct ehbigint *ehbi_subtract(struct ehbigint *res, const struct ehbigint *bi1,
-			       const struct ehbigint *bi2, int *err)
+/*
+   populates tmp as a zero valued temporary with room for at least "need"
+   bytes, taken from the scratch, the bbuf on the stack, or the heap;
+   nothing is copied or cleared, so the caller sizes the temporary for
+   the largest value it will hold, which for each operation is:
+	add, subtract:  (larger bytes_used) + 1
+	mul:            bi1->bytes_used + bi2->bytes_used
+	div:            quotient and remainder: numerator->bytes_used
+   a growable temporary is always taken from the heap, so that it may be
+   realloc'd by ehbi_reserve
+*/
+static struct ehbigint *ehbi_tmp_reserve(struct ehbi_scratch *s,
+					 struct ehbigint *tmp,
+					 unsigned char *bbuf, size_t bbuf_len,
+					 size_t need, int grow, int *err,
+					 int line)
 {
-	size_t i, j;
-	unsigned char a, b, c, negate;
-	const struct ehbigint *swp;
-	struct ehbigint *bi1a;
-	struct ehbigint tmp;
-	struct ehbigint *rp;
-	unsigned char bytes[Ehbi_bi_buf_size];
-	/* char buf[80]; */
+	struct eembed_allocator *ea = eembed_global_allocator;
+	struct ehbi_scratch *from = s;
+	size_t take;
 
-	ehbi_internal_clear_null_struct(&tmp);
+	ehbi_internal_clear_null_struct(tmp);
+	if (need == 0) {
+		need = 1;
+	}
+	take = (need > bbuf_len) ? need : bbuf_len;
+	if (!s && !grow && bbuf_len < need) {
+		from = ehbi_thread_cache_get(need);
+	}
+	if (!grow) {
+		tmp->bytes = ehbi_scratch_take(from, take);
+	}
+	if (tmp->bytes) {
+		tmp->bytes_len = take;
+		ehbi_flag_set(tmp, ehbi_flag_scratch, 1);
+	} else if (!grow && bbuf_len >= need) {
+		tmp->bytes = bbuf;
+		tmp->bytes_len = bbuf_len;
+	} else {
+		tmp->bytes = (unsigned char *)ea->malloc(ea, need);
+		if (!tmp->bytes) {
+			Ehbi_log_error_s_ul_s_ul_s("Line ", line,
+						   ". Could not allocate ",
+						   need, " bytes?");
+			ehbi_set_error(err, EHBI_NOMEM);
+			return NULL;
+		}
+		tmp->bytes_len = need;
+		ehbi_flag_set(tmp, ehbi_flag_heap, 1);
+		ehbi_flag_set(tmp, ehbi_flag_grow, grow ? 1 : 0);
+	}
+	if (from && !grow && !ehbi_flag(tmp, ehbi_flag_scratch)) {
+		from->bytes_spilled += tmp->bytes_len;
+	}
+	return ehbi_zero(tmp);
+}
 
-	Ehbi_assert_bi(res);
-	Ehbi_assert_bi(bi1);
-	Ehbi_assert_bi(bi2);
-	rp = res;
+#define Ehbi_tmp_reserve(s, tmp, bbuf, bbuf_len, need, err) \
+	ehbi_tmp_reserve(s, tmp, bbuf, bbuf_len, need, 0, err, __LINE__)
+
+#define Ehbi_tmp_reserve_grow(s, tmp, bbuf, bbuf_len, need, grow, err) \
+	ehbi_tmp_reserve(s, tmp, bbuf, bbuf_len, need, grow, err, __LINE__)
 
-	/* subtract zero */
-	if (ehbi_is_zero(bi2)) {
-		rp = ehbi_set(res, bi1, err);
-		goto ehbi_subtract_end;
+/* a temporary copy of val, for when the value itself is needed */
+static struct ehbigint *ehbi_set_or_malloc(struct ehbi_scratch *s,
+					   struct ehbigint *tmp,
+					   unsigned char *bbuf, size_t bbuf_len,
+					   const struct ehbigint *val, int *err,
+					   int line)
+{
+	if (!ehbi_tmp_reserve(s, tmp, bbuf, bbuf_len, val->bytes_used, 0, err,
+			      line)) {
+		return NULL;
 	}
+	return ehbi_set(tmp, val, err);
+}
 
-	/* subtract from 0 */
-	if (ehbi_is_zero(bi1)) {
-		rp = ehbi_set(res, bi2, err);
-		if (!rp) {
-			goto ehbi_subtract_end;
+#define Ehbi_set_or_malloc(s, tmp, bbuf, bbuf_len, val, err) \
+	ehbi_set_or_malloc(s, tmp, bbuf, bbuf_len, val, err, __LINE__)
+
+/* temporaries taken from a scratch are released in bulk: releasing one
+   also releases everything which was taken from the scratch after it */
+static void ehbi_set_or_malloc_free(struct ehbi_scratch *s,
+				    struct ehbigint *tmp)
+{
+	struct eembed_allocator *ea = eembed_global_allocator;
+	struct ehbi_scratch *from = s;
+	int spilled;
+
+	/* without a scratch, only the heap is counted against the cache */
+	spilled = (tmp->bytes && !ehbi_flag(tmp, ehbi_flag_scratch)
+		   && !ehbi_flag(tmp, ehbi_flag_grow)
+		   && (s || ehbi_flag(tmp, ehbi_flag_heap)));
+	if (!s) {
+		from = Ehbi_thread_cache;
+	}
+	if (from && spilled) {
+		from->bytes_spilled -= tmp->bytes_len;
+	}
+	if (ehbi_flag(tmp, ehbi_flag_heap)) {
+		ea->free(ea, tmp->bytes);
+	} else if (ehbi_flag(tmp, ehbi_flag_scratch)) {
+		eembed_assert(from);
+		eembed_assert(tmp->bytes >= from->bytes);
+		if (from->bytes_used > (size_t)(tmp->bytes - from->bytes)) {
+			from->bytes_used = (size_t)(tmp->bytes - from->bytes);
 		}
-		rp = ehbi_negate(res);
-		goto ehbi_subtract_end;
 	}
+	ehbi_internal_clear_null_struct(tmp);
+}
 
-	/* subtracting a negative */
-	if (ehbi_sign(bi1) == 0 && ehbi_sign(bi2) != 0) {
-		rp = Ehbi_set_or_malloc(&tmp, bytes, Ehbi_bi_buf_size, bi2,
-					err);
-		if (!rp) {
-			goto ehbi_subtract_end;
-		}
-		ehbi_negate(&tmp);
-		rp = ehbi_add(res, bi1, &tmp, err);
-		goto ehbi_subtract_end;
+/* could writing to res change the value of op? that is, do the bytes
+   overlap, which they may in part, as with an ehbi_view_slice */
+static int ehbi_aliases(const struct ehbigint *res, const struct ehbigint *op)
+{
+	return (res->bytes < op->bytes + op->bytes_len
+		&& op->bytes < res->bytes + res->bytes_len);
+}
+
+/*
+   the in place kernels read each byte of an operand before writing the
+   same byte of the result, which is safe if they are the same bytes, but
+   not if they overlap at an offset; then the operand is copied to tmp,
+   which the caller frees with ehbi_set_or_malloc_free
+   returns op, or the copy, or NULL on error
+*/
+static const struct ehbigint *ehbi_unalias(struct ehbi_scratch *s,
+					   const struct ehbigint *res,
+					   const struct ehbigint *op,
+					   struct ehbigint *tmp,
+					   unsigned char *bbuf, size_t bbuf_len,
+					   int *err)
+{
+	if (res->bytes == op->bytes || !ehbi_aliases(res, op)) {
+		return op;
 	}
+	return Ehbi_set_or_malloc(s, tmp, bbuf, bbuf_len, op, err);
+}
 
-	/* negative subtracting a positive */
-	if (ehbi_sign(bi1) != 0 && ehbi_sign(bi2) == 0) {
-		rp = Ehbi_set_or_malloc(&tmp, bytes, Ehbi_bi_buf_size, bi1,
-					err);
-		if (!rp) {
-			goto ehbi_subtract_end;
-		}
-		ehbi_negate(&tmp);
-		rp = ehbi_add(res, &tmp, bi2, err);
-		if (!rp) {
-			goto ehbi_subtract_end;
+static int ehbi_compare_magnitude(const struct ehbigint *bi1,
+				  const struct ehbigint *bi2)
+{
+	size_t i;
+
+	if (bi1->bytes_used != bi2->bytes_used) {
+		return (bi1->bytes_used > bi2->bytes_used) ? 1 : -1;
+	}
+	for (i = bi1->bytes_used; i > 0; --i) {
+		if (bi1->bytes[i - 1] != bi2->bytes[i - 1]) {
+			return (bi1->bytes[i - 1] > bi2->bytes[i - 1]) ? 1 : -1;
 		}
-		rp = ehbi_negate(res);
-		goto ehbi_subtract_end;
 	}
+	return 0;
+}
 
-	if ((ehbi_sign(bi1) == 0 && ehbi_sign(bi2) == 0
-	     && ehbi_greater_than(bi2, bi1))
-	    || (ehbi_sign(bi1) != 0 && ehbi_sign(bi2) != 0
-		&& ehbi_less_than(bi2, bi1))) {
-		/* subtracting a bigger number */
-		negate = 1;
-		swp = bi1;
-		bi1 = bi2;
-		bi2 = swp;
+/*
+   res = bi1 + bi2, where bi2 is taken as having the sign "sign2"
+   each byte of the operands is read before the same byte of the result
+   is written, thus res may be the same as either operand, but must not
+   overlap one at an offset, see ehbi_add_signed_x
+*/
+static struct ehbigint *ehbi_add_signed(struct ehbigint *res,
+					const struct ehbigint *bi1,
+					const struct ehbigint *bi2,
+					unsigned sign2, int *err)
+{
+	size_t i, top, big_used, small_used;
+	unsigned int a, b, c;
+	unsigned sign;
+	int subtract;
+	const struct ehbigint *big, *small;
+
+	Ehbi_assert_bi(res);
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+
+	/* the larger magnitude decides the sign */
+	subtract = (ehbi_sign(bi1) != sign2);
+	if (ehbi_compare_magnitude(bi1, bi2) >= 0) {
+		big = bi1;
+		small = bi2;
+		sign = ehbi_sign(bi1);
 	} else {
-		/* subtracting normally */
-		negate = 0;
+		big = bi2;
+		small = bi1;
+		sign = sign2;
 	}
+	big_used = big->bytes_used;
+	small_used = small->bytes_used;
 
-	/* we don't wish to modify the real bi1, so use tmp */
-	rp = Ehbi_set_or_malloc(&tmp, bytes, Ehbi_bi_buf_size, bi1, err);
-	if (!rp) {
-		goto ehbi_subtract_end;
+	if (!ehbi_reserve(res, big_used + (subtract ? 0 : 1), err)) {
+		goto ehbi_add_signed_error;
+	}
+	if (big_used > res->bytes_len) {
+		Ehbi_log_error_s_ul_s_ul_s("Result byte[", res->bytes_len,
+					   "] too small (", big_used, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		goto ehbi_add_signed_error;
 	}
-	bi1a = &tmp;
-	res->bytes_used = 0;
+
+	/* c is the carry, or when subtracting, the borrow; top is one past
+	   the most significant non-zero byte written */
 	c = 0;
-	for (i = 1; i <= bi1a->bytes_used; ++i) {
-		if (bi1a->bytes_used < i) {
-			a = 0;
+	top = 1;
+	for (i = 0; i < big_used; ++i) {
+		a = big->bytes[i];
+		b = (i < small_used) ? small->bytes[i] : 0;
+		if (subtract) {
+			b += c;
+			c = (b > a) ? 1 : 0;
+			a = (unsigned char)(a - b);
 		} else {
-			a = bi1a->bytes[bi1a->bytes_len - i];
+			a += b + c;
+			c = a >> EEMBED_CHAR_BIT;
+			a = (unsigned char)a;
 		}
-		if ((bi2->bytes_used < i)
-		    || (i > bi2->bytes_len)) {
-			b = 0;
-		} else {
-			b = bi2->bytes[bi2->bytes_len - i];
+		res->bytes[i] = (unsigned char)a;
+		if (a) {
+			top = i + 1;
 		}
-		c = (a - b);
-		if (i > res->bytes_len) {
-			Ehbi_log_error0("Result byte[] too small");
-			ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
-			rp = NULL;
-			goto ehbi_subtract_end;
-		}
-		res->bytes[res->bytes_len - i] = c;
-		res->bytes_used++;
-		/* need to borrow */
-		if (b > a) {
-			c = 0x01;
-			j = i + 1;
-			while (c == 0x01) {
-				if (j > bi1a->bytes_used) {
-					Ehbi_log_error0("bytes for borrow");
-					ehbi_set_error(err, EHBI_CORRUPT_DATA);
-					rp = NULL;
-					goto ehbi_subtract_end;
-				}
-				c = (bi1a->bytes[bi1a->bytes_len - j] ==
-				     0x00) ? 0x01 : 0x00;
-				--(bi1a->bytes[bi1a->bytes_len - j]);
-				++j;
-			}
-			ehbi_internal_reset_bytes_used(bi1a,
-						       bi1a->bytes_used
-						       + 1 + j);
+	}
+
+	/* |big| >= |small|, so there is never a borrow out */
+	if (subtract) {
+		eembed_assert(c == 0);
+		res->bytes_used = top;
+	} else if (c) {
+		if (big_used >= res->bytes_len) {
+			Ehbi_log_error_s_ul_s("Result byte[", res->bytes_len,
+					      "] too small for carry");
+			ehbi_set_error(err, EHBI_BYTES_TOO_SMALL_FOR_CARRY);
+			goto ehbi_add_signed_error;
 		}
+		res->bytes[big_used] = (unsigned char)c;
+		res->bytes_used = big_used + 1;
+	} else {
+		res->bytes_used = big_used;
 	}
 
-	ehbi_sign_set(res, (negate) ? !ehbi_sign(bi1) : ehbi_sign(bi1));
-	if (ehbi_is_zero(res)) {
-		ehbi_sign_set(res, 0);
+	ehbi_sign_set(res, ehbi_is_zero(res) ? 0 : sign);
+	Ehbi_assert_normal(res);
+
+	return res;
+
+ehbi_add_signed_error:
+	ehbi_zero(res);
+	return NULL;
+}
+
+/* as ehbi_add_signed, but an operand overlapping res is copied first */
+static struct ehbigint *ehbi_add_signed_x(struct ehbigint *res,
+					  const struct ehbigint *bi1,
+					  const struct ehbigint *bi2,
+					  unsigned sign2,
+					  struct ehbi_scratch *s, int *err)
+{
+	struct ehbigint tmp1, tmp2;
+	struct ehbigint *rp;
+	const struct ehbigint *op1, *op2;
+	unsigned char bytes1[Ehbi_bi_buf_size];
+	unsigned char bytes2[Ehbi_bi_buf_size];
+
+	ehbi_internal_clear_null_struct(&tmp1);
+	ehbi_internal_clear_null_struct(&tmp2);
+
+	Ehbi_assert_bi(res);
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+
+	rp = NULL;
+	op1 = ehbi_unalias(s, res, bi1, &tmp1, bytes1, Ehbi_bi_buf_size, err);
+	if (!op1) {
+		goto ehbi_add_signed_x_end;
+	}
+	op2 = (bi2 == bi1) ? op1 : ehbi_unalias(s, res, bi2, &tmp2, bytes2,
+						  Ehbi_bi_buf_size, err);
+	if (!op2) {
+		goto ehbi_add_signed_x_end;
 	}
-	ehbi_internal_reset_bytes_used(res, res->bytes_used + 1);
-ehbi_subtract_end:
-	ehbi_set_or_malloc_free(&tmp, Ehbi_bi_buf_size);
+	rp = ehbi_add_signed(res, op1, op2, sign2, err);
 
+ehbi_add_signed_x_end:
+	ehbi_set_or_malloc_free(s, &tmp2);
+	ehbi_set_or_malloc_free(s, &tmp1);
 	if (!rp) {
-		if (res) {
-			ehbi_zero(res);
-		}
-		return NULL;
+		ehbi_zero(res);
 	}
+	return rp;
+}
 
-	return res;
+struct ehbigint *ehbi_add_x(struct ehbigint *res,
+			    const struct ehbigint *bi1,
+			    const struct ehbigint *bi2, struct ehbi_scratch *s,
+			    int *err)
+{
+	Ehbi_assert_bi(bi2);
+
+	return ehbi_add_signed_x(res, bi1, bi2, ehbi_sign(bi2), s, err);
 }
 
-struct ehbigint *ehbi_subtract_l(struct ehbigint *res,
-				 const struct ehbigint *bi1, long v2, int *err)
+struct ehbigint *ehbi_add(struct ehbigint *res,
+			  const struct ehbigint *bi1,
+			  const struct ehbigint *bi2, int *err)
+{
+	return ehbi_add_x(res, bi1, bi2, NULL, err);
+}
+
+struct ehbigint *ehbi_add_l(struct ehbigint *res, const struct ehbigint *bi1,
+			    long v2, int *err)
 {
 	unsigned char bytes[sizeof(unsigned long)];
 	struct ehbigint temp;
@@ -1324,244 +1707,508 @@ struct ehbigint *ehbi_subtract_l(struct ehbigint *res,
 	temp.bytes_len = sizeof(unsigned long);
 	ehbi_internal_struct_l(&temp, v2);
 
-	return ehbi_subtract(res, bi1, &temp, err);
+	return ehbi_add(res, bi1, &temp, err);
 }
 
-struct ehbigint *ehbi_shift_right(struct ehbigint *bi, unsigned long num_bits)
+struct ehbigint *ehbi_add_u64(struct ehbigint *res, const struct ehbigint *bi1,
+			      uint64_t v2, int *err)
 {
-	struct eba eba;
-
-	eba.endian = eba_big_endian;
-	eba.bits = NULL;
-	eba.size_bytes = 0;
-
-	Ehbi_assert_bi(bi);
-	eba.bits = bi->bytes + (bi->bytes_len - bi->bytes_used);
-	eba.size_bytes = bi->bytes_used;
+	unsigned char bytes[sizeof(uint64_t)];
+	struct ehbigint temp;
 
-	eba_shift_right(&eba, num_bits);
+	ehbi_internal_clear_null_struct(&temp);
 
-	ehbi_internal_reset_bytes_used(bi, bi->bytes_used + 1);
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(uint64_t);
+	ehbi_internal_struct_u64(&temp, v2);
 
-	return bi;
+	return ehbi_add(res, bi1, &temp, err);
 }
 
-static unsigned char ehbi_msb8(register unsigned char in)
+#ifdef EHBI_HAVE_U128
+struct ehbigint *ehbi_add_u128(struct ehbigint *res,
+			       const struct ehbigint *bi1, ehbi_u128 v2,
+			       int *err)
 {
-	if (in & (1 << 7)) {
-		return 8;
+	unsigned char bytes[sizeof(ehbi_u128)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(ehbi_u128);
+	ehbi_internal_struct_u128(&temp, v2);
+
+	return ehbi_add(res, bi1, &temp, err);
+}
+#endif
+
+struct ehbigint *ehbi_mul_x(struct ehbigint *res, const struct ehbigint *bi1,
+			    const struct ehbigint *bi2, struct ehbi_scratch *s,
+			    int *err)
+{
+	size_t i, j, k, size;
+	const struct ehbigint *t;
+	unsigned int a, b, r;
+	struct ehbigint tmp1, tmp2;
+	unsigned char bytes1[Ehbi_bi_buf_size];
+	unsigned char bytes2[Ehbi_bi_buf_size];
+
+	ehbi_internal_clear_null_struct(&tmp1);
+	ehbi_internal_clear_null_struct(&tmp2);
+
+	Ehbi_assert_bi(res);
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+
+	/* the product is accumulated in res, so an operand which shares
+	   its bytes is copied, only then */
+	if (ehbi_aliases(res, bi1)) {
+		if (!Ehbi_set_or_malloc(s, &tmp1, bytes1, Ehbi_bi_buf_size, bi1,
+					err)) {
+			goto ehbi_mul_error;
+		}
+		bi2 = (bi2 == bi1) ? &tmp1 : bi2;
+		bi1 = &tmp1;
 	}
-	if (in & (1 << 6)) {
-		return 7;
+	if (ehbi_aliases(res, bi2)) {
+		if (!Ehbi_set_or_malloc(s, &tmp2, bytes2, Ehbi_bi_buf_size, bi2,
+					err)) {
+			goto ehbi_mul_error;
+		}
+		bi2 = &tmp2;
 	}
-	if (in & (1 << 5)) {
-		return 6;
+
+	if (bi1->bytes_used < bi2->bytes_used) {
+		t = bi1;
+		bi1 = bi2;
+		bi2 = t;
 	}
-	if (in & (1 << 4)) {
-		return 5;
+
+	size = bi1->bytes_used + bi2->bytes_used;
+	if (!ehbi_reserve(res, size, err)) {
+		goto ehbi_mul_error;
 	}
-	if (in & (1 << 3)) {
-		return 4;
+	if (size > res->bytes_len) {
+		size = res->bytes_len;
 	}
-	if (in & (1 << 2)) {
-		return 3;
+	eembed_memset(res->bytes, 0x00, size);
+	ehbi_sign_set(res, 0);
+
+	/* base 256 long multiplication, directly into the result bytes */
+	for (i = 0; i < bi2->bytes_used; ++i) {
+		a = bi2->bytes[i];
+		if (a == 0) {
+			continue;
+		}
+		r = 0;
+		for (j = 0; j < bi1->bytes_used || r; ++j) {
+			b = (j < bi1->bytes_used) ? bi1->bytes[j] : 0;
+			r += (a * b);
+			if ((i + j) >= res->bytes_len) {
+				if (r) {
+					Ehbi_log_error_s_ul_s("Result byte[",
+							      res->bytes_len,
+							      "] too small");
+					ehbi_set_error(err,
+						       EHBI_BYTES_TOO_SMALL);
+					goto ehbi_mul_error;
+				}
+				continue;
+			}
+			k = i + j;
+			r += res->bytes[k];
+			res->bytes[k] = (unsigned char)r;
+			r = r >> EEMBED_CHAR_BIT;
+		}
 	}
-	if (in & (1 << 1)) {
-		return 2;
+
+	/* a product of m and n bytes is m + n or m + n - 1 bytes, or zero */
+	res->bytes_used = size;
+	if (size > 1 && res->bytes[size - 1] == 0x00) {
+		res->bytes_used = size - 1;
 	}
-	if (in & (1 << 0)) {
-		return 1;
+	if (ehbi_is_zero(bi1) || ehbi_is_zero(bi2)) {
+		res->bytes_used = 1;
 	}
-	return 0;
+
+	if (!ehbi_is_zero(res) && ehbi_sign(bi1) != ehbi_sign(bi2)) {
+		ehbi_sign_set(res, 1);
+	}
+	Ehbi_assert_normal(res);
+
+	ehbi_set_or_malloc_free(s, &tmp2);
+	ehbi_set_or_malloc_free(s, &tmp1);
+
+	return res;
+
+ehbi_mul_error:
+	ehbi_set_or_malloc_free(s, &tmp2);
+	ehbi_set_or_malloc_free(s, &tmp1);
+	ehbi_zero(res);
+	return NULL;
+}
+
+struct ehbigint *ehbi_mul(struct ehbigint *res, const struct ehbigint *bi1,
+			  const struct ehbigint *bi2, int *err)
+{
+	return ehbi_mul_x(res, bi1, bi2, NULL, err);
 }
 
-static unsigned long ehbi_shift_left_overflow(struct ehbigint *bi,
-					      unsigned long num_bits)
+struct ehbigint *ehbi_mul_l(struct ehbigint *res, const struct ehbigint *bi1,
+			    long v2, int *err)
 {
-	unsigned long overflow, avail;
-	unsigned char top;
+	unsigned char bytes[sizeof(unsigned long)];
+	struct ehbigint temp;
 
-	Ehbi_assert_bi(bi);
+	ehbi_internal_clear_null_struct(&temp);
 
-	overflow = 0;
-	avail = 8 * (bi->bytes_len - bi->bytes_used);
-	top = bi->bytes[bi->bytes_len - bi->bytes_used];
-	avail += (8 - ehbi_msb8(top));
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(unsigned long);
+	ehbi_internal_struct_l(&temp, v2);
 
-	if (avail < num_bits) {
-		overflow = (num_bits - avail);
-	}
+	return ehbi_mul(res, bi1, &temp, err);
+}
+
+struct ehbigint *ehbi_mul_u64(struct ehbigint *res, const struct ehbigint *bi1,
+			      uint64_t v2, int *err)
+{
+	unsigned char bytes[sizeof(uint64_t)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(uint64_t);
+	ehbi_internal_struct_u64(&temp, v2);
 
-	return overflow;
+	return ehbi_mul(res, bi1, &temp, err);
 }
 
-struct ehbigint *ehbi_shift_left(struct ehbigint *bi, unsigned long num_bits,
-				 unsigned long *overflow)
+#ifdef EHBI_HAVE_U128
+struct ehbigint *ehbi_mul_u128(struct ehbigint *res,
+			       const struct ehbigint *bi1, ehbi_u128 v2,
+			       int *err)
 {
-	struct eba eba;
-	size_t add_size, avail_bytes;
+	unsigned char bytes[sizeof(ehbi_u128)];
+	struct ehbigint temp;
 
-	Ehbi_assert_bi(bi);
-	eba.endian = eba_big_endian;
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(ehbi_u128);
+	ehbi_internal_struct_u128(&temp, v2);
 
-	add_size = 2 + (num_bits / EEMBED_CHAR_BIT);
-	avail_bytes = bi->bytes_len - bi->bytes_used;
-	if (avail_bytes > add_size) {
-		eba.bits = bi->bytes + (avail_bytes - add_size);
-		eba.size_bytes = bi->bytes_len - (avail_bytes - add_size);
-		if (overflow) {
-			*overflow = 0;
+	return ehbi_mul(res, bi1, &temp, err);
+}
+#endif
+
+/*
+   short division, a byte at a time from the top, with the running
+   remainder in a word: the remainder is less than d, thus less than 2^56,
+   and with the next byte brought down still fits in 64 bits;
+   each byte of the numerator is read before the same byte of the quotient
+   is written, thus the quotient may be the same as the numerator, but
+   must not overlap it at an offset, see ehbi_unalias
+*/
+static struct ehbigint *ehbi_div_small(struct ehbigint *quotient,
+				       const struct ehbigint *numerator,
+				       uint64_t d, uint64_t *remainder,
+				       int *err)
+{
+	size_t i, top;
+	uint64_t r;
+	unsigned char q;
+
+	eembed_assert(d != 0);
+
+	r = 0;
+	top = 0;
+	for (i = numerator->bytes_used; i > 0; --i) {
+		r = (r << EEMBED_CHAR_BIT) | numerator->bytes[i - 1];
+		q = (unsigned char)(r / d);
+		r = r % d;
+		if (q && !top) {
+			if (i > quotient->bytes_len) {
+				Ehbi_log_error_s_ul_s_ul_s("Quotient byte[",
+							   quotient->bytes_len,
+							   "] too small (", i,
+							   ")");
+				ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+				return NULL;
+			}
+			top = i;
 		}
-	} else {
-		eba.bits = bi->bytes;
-		eba.size_bytes = bi->bytes_len;
-		if (overflow) {
-			*overflow = ehbi_shift_left_overflow(bi, num_bits);
+		if (i <= quotient->bytes_len) {
+			quotient->bytes[i - 1] = q;
 		}
 	}
+	quotient->bytes_used = top ? top : 1;
+	ehbi_sign_set(quotient, 0);
+	*remainder = r;
 
-	eba_shift_left(&eba, num_bits);
-
-	ehbi_internal_reset_bytes_used(bi, bi->bytes_used + add_size);
-
-	return bi;
+	return quotient;
 }
 
-struct ehbigint *ehbi_n_choose_k(struct ehbigint *result,
-				 const struct ehbigint *n,
-				 const struct ehbigint *k, int *err)
+/*
+   long division, as Knuth's Algorithm D (TAOCP Vol 2, 4.3.1) with bytes
+   as the digits: both values are first shifted so that the top bit of the
+   denominator is set, then each byte of the quotient is estimated from the
+   top two bytes of the running remainder and the top byte of the
+   denominator; the estimate is at most 2 too big, and is corrected with
+   the next byte of the denominator, then rarely, by adding back
+*/
+static struct ehbigint *ehbi_div_long(struct ehbigint *quotient,
+				      struct ehbigint *remainder,
+				      const struct ehbigint *numerator,
+				      const struct ehbigint *denominator,
+				      struct ehbi_scratch *s, int *err)
 {
-	size_t i, size;
-	int local_error;
-	struct ehbigint sum_n, sum_k, tmp;
+	size_t i, j, m, n, top;
+	unsigned shift;
+	unsigned long qhat, rhat, p, carry, borrow;
+	unsigned char *un, *vn;
+	struct ehbigint u, v;
 	struct ehbigint *rp;
-	unsigned char tbytes[Ehbi_bi_buf_size];
-	unsigned char nbytes[Ehbi_bi_buf_size];
-	unsigned char kbytes[Ehbi_bi_buf_size];
-
-	Ehbi_assert_bi(result);
-	Ehbi_assert_bi(n);
-	Ehbi_assert_bi(k);
-	if (!err) {
-		local_error = EHBI_SUCCESS;
-		err = &local_error;
-	}
-	rp = ehbi_zero(result);
+	unsigned char u_bytes[Ehbi_bi_buf_size];
+	unsigned char v_bytes[Ehbi_bi_buf_size];
 
-	if (ehbi_greater_than(k, n) || ehbi_less_than_l(k, 0)) {
-		rp = ehbi_set_l(result, 0, err);
-		goto ehbi_n_choose_k_end;
-	}
+	ehbi_internal_clear_null_struct(&u);
+	ehbi_internal_clear_null_struct(&v);
 
-	if (ehbi_equals_l(k, 0) || ehbi_equals(k, n)) {
-		rp = ehbi_set_l(result, 1, err);
-		goto ehbi_n_choose_k_end;
-	}
+	n = denominator->bytes_used;
+	m = numerator->bytes_used - n;
+	eembed_assert(n >= 2);
+	eembed_assert(numerator->bytes_used >= n);
 
-	if (ehbi_equals_l(k, 1)) {
-		rp = ehbi_set(result, n, err);
-		goto ehbi_n_choose_k_end;
+	rp = Ehbi_tmp_reserve(s, &u, u_bytes, Ehbi_bi_buf_size, n + m + 1, err);
+	if (!rp) {
+		goto ehbi_div_long_end;
 	}
-
-	if (ehbi_greater_than_l(k, LONG_MAX)) {
-		Ehbi_log_error_s_ul_s("k larger than ", LONG_MAX, "");
-		ehbi_set_error(err, EHBI_BAD_DATA);
-		rp = NULL;
-		goto ehbi_n_choose_k_end;
+	rp = Ehbi_tmp_reserve(s, &v, v_bytes, Ehbi_bi_buf_size, n, err);
+	if (!rp) {
+		goto ehbi_div_long_end;
 	}
+	un = u.bytes;
+	vn = v.bytes;
 
-	size = result->bytes_len;
-	if (size < n->bytes_len) {
-		size = n->bytes_len;
+	/* normalize, the operands are copied, thus may be the outputs */
+	shift = EEMBED_CHAR_BIT - ehbi_msb8(denominator->bytes[n - 1]);
+	carry = 0;
+	for (i = 0; i < n; ++i) {
+		p = ((unsigned long)denominator->bytes[i]) << shift;
+		vn[i] = (unsigned char)(p | carry);
+		carry = p >> EEMBED_CHAR_BIT;
 	}
-	if (size < k->bytes_len) {
-		size = k->bytes_len;
+	carry = 0;
+	for (i = 0; i < n + m; ++i) {
+		p = ((unsigned long)numerator->bytes[i]) << shift;
+		un[i] = (unsigned char)(p | carry);
+		carry = p >> EEMBED_CHAR_BIT;
 	}
+	un[n + m] = (unsigned char)carry;
 
-	/* cheating on result */
-	result->bytes_used = size;
-	rp = Ehbi_set_or_malloc(&tmp, tbytes, Ehbi_bi_buf_size, result, err);
+	rp = ehbi_reserve(quotient, m + 1, err);
 	if (!rp) {
-		goto ehbi_n_choose_k_end;
+		goto ehbi_div_long_end;
+	}
+
+	top = 0;
+	for (j = m + 1; j > 0; --j) {
+		p = (((unsigned long)un[j - 1 + n]) << EEMBED_CHAR_BIT)
+		    | un[j - 2 + n];
+		qhat = p / vn[n - 1];
+		rhat = p % vn[n - 1];
+		while (qhat > 0xFF
+		       || (qhat * vn[n - 2])
+		       > ((rhat << EEMBED_CHAR_BIT) | un[j - 3 + n])) {
+			--qhat;
+			rhat += vn[n - 1];
+			if (rhat > 0xFF) {
+				break;
+			}
+		}
+
+		/* multiply and subtract */
+		carry = 0;
+		borrow = 0;
+		for (i = 0; i < n; ++i) {
+			p = (qhat * vn[i]) + carry;
+			carry = p >> EEMBED_CHAR_BIT;
+			p = (p & 0xFF) + borrow;
+			borrow = (un[i + j - 1] < p) ? 1 : 0;
+			un[i + j - 1] = (unsigned char)(un[i + j - 1] - p);
+		}
+		p = carry + borrow;
+		borrow = (un[j - 1 + n] < p) ? 1 : 0;
+		un[j - 1 + n] = (unsigned char)(un[j - 1 + n] - p);
+
+		/* the estimate was one too big, add back */
+		if (borrow) {
+			--qhat;
+			carry = 0;
+			for (i = 0; i < n; ++i) {
+				p = un[i + j - 1] + (unsigned long)vn[i] + carry;
+				un[i + j - 1] = (unsigned char)p;
+				carry = p >> EEMBED_CHAR_BIT;
+			}
+			un[j - 1 + n] = (unsigned char)(un[j - 1 + n] + carry);
+		}
+
+		if (qhat && !top) {
+			if (j > quotient->bytes_len) {
+				Ehbi_log_error_s_ul_s_ul_s("Quotient byte[",
+							   quotient->bytes_len,
+							   "] too small (", j,
+							   ")");
+				ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+				rp = NULL;
+				goto ehbi_div_long_end;
+			}
+			top = j;
+		}
+		if (j <= quotient->bytes_len) {
+			quotient->bytes[j - 1] = (unsigned char)qhat;
+		}
 	}
-	rp = Ehbi_set_or_malloc(&sum_n, nbytes, Ehbi_bi_buf_size, result, err);
-	if (!rp) {
-		goto ehbi_n_choose_k_end;
+	quotient->bytes_used = top ? top : 1;
+	ehbi_sign_set(quotient, 0);
+
+	/* un-normalize the remainder, which is in the low n bytes */
+	for (i = 0; i < n; ++i) {
+		p = un[i] >> shift;
+		if (shift && i + 1 < n) {
+			p |= ((unsigned long)un[i + 1]) << (EEMBED_CHAR_BIT
+							    - shift);
+		}
+		un[i] = (unsigned char)p;
 	}
-	rp = Ehbi_set_or_malloc(&sum_k, kbytes, Ehbi_bi_buf_size, result, err);
+	for (top = n; top > 1 && un[top - 1] == 0x00; --top) ;
+	rp = ehbi_reserve(remainder, top, err);
 	if (!rp) {
-		goto ehbi_n_choose_k_end;
+		goto ehbi_div_long_end;
 	}
-	ehbi_zero(result);
-
-	rp = ehbi_inc(&sum_n, n, err);
-	if (!rp) {
-		goto ehbi_n_choose_k_end;
+	if (top > remainder->bytes_len) {
+		Ehbi_log_error_s_ul_s_ul_s("Remainder byte[",
+					   remainder->bytes_len,
+					   "] too small (", top, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		rp = NULL;
+		goto ehbi_div_long_end;
 	}
-	rp = ehbi_inc(&sum_k, k, err);
-	if (!rp) {
-		goto ehbi_n_choose_k_end;
+	eembed_memcpy(remainder->bytes, un, top);
+	remainder->bytes_used = top;
+	ehbi_sign_set(remainder, 0);
+
+ehbi_div_long_end:
+	ehbi_set_or_malloc_free(s, &v);
+	ehbi_set_or_malloc_free(s, &u);
+
+	return rp;
+}
+
+struct ehbigint *ehbi_div_x(struct ehbigint *quotient,
+			    struct ehbigint *remainder,
+			    const struct ehbigint *numerator,
+			    const struct ehbigint *denominator,
+			    struct ehbi_scratch *s, int *err)
+{
+	size_t i;
+	unsigned numer_sign, denom_sign;
+	uint64_t d, r;
+	struct ehbigint tmp;
+	struct ehbigint *rp;
+	const struct ehbigint *numer;
+	unsigned char tmp_bytes[Ehbi_bi_buf_size];
+
+	ehbi_internal_clear_null_struct(&tmp);
+
+	Ehbi_assert_bi(numerator);
+	Ehbi_assert_bi(denominator);
+	Ehbi_assert_bi(quotient);
+	Ehbi_assert_bi(remainder);
+
+	rp = NULL;
+	if (ehbi_is_zero(denominator)) {
+		Ehbi_log_error0("denominator == 0");
+		ehbi_set_error(err, EHBI_DIVIDE_BY_ZERO);
+		goto ehbi_div_end;
 	}
-	for (i = 1; ehbi_greater_than_l(k, i); ++i) {
-		/* sum_n *= (n - i); */
-		rp = ehbi_set_l(&tmp, -((long)i), err);
-		if (!rp) {
-			goto ehbi_n_choose_k_end;
-		}
-		rp = ehbi_set_l(&tmp, -((long)i), err);
-		if (!rp) {
-			goto ehbi_n_choose_k_end;
-		}
-		rp = ehbi_inc(&tmp, n, err);
-		if (!rp) {
-			goto ehbi_n_choose_k_end;
-		}
-		rp = ehbi_mul(result, &sum_n, &tmp, err);
+
+	/* the signs are captured before an output can change an operand */
+	numer_sign = ehbi_sign(numerator);
+	denom_sign = ehbi_sign(denominator);
+
+	if (ehbi_compare_magnitude(numerator, denominator) < 0) {
+		rp = ehbi_set(remainder, numerator, err);
 		if (!rp) {
-			goto ehbi_n_choose_k_end;
+			goto ehbi_div_end;
 		}
-		rp = ehbi_set(&sum_n, result, err);
-		if (!rp) {
-			goto ehbi_n_choose_k_end;
+		ehbi_sign_set(remainder, 0);
+		if (quotient != remainder) {
+			ehbi_zero(quotient);
 		}
+		return quotient;
+	}
 
-		/* sum_k *= (k - i) */
-		rp = ehbi_set_l(&tmp, -((long)i), err);
-		if (!rp) {
-			goto ehbi_n_choose_k_end;
+	/* a denominator of up to 7 bytes can be a word */
+	if (denominator->bytes_used < sizeof(uint64_t)) {
+		d = 0;
+		for (i = denominator->bytes_used; i > 0; --i) {
+			d = (d << EEMBED_CHAR_BIT) | denominator->bytes[i - 1];
 		}
-		rp = ehbi_inc(&tmp, k, err);
-		if (!rp) {
-			goto ehbi_n_choose_k_end;
+		numer = ehbi_unalias(s, quotient, numerator, &tmp, tmp_bytes,
+				     Ehbi_bi_buf_size, err);
+		if (!numer) {
+			rp = NULL;
+			goto ehbi_div_end;
 		}
-		rp = ehbi_mul(result, &sum_k, &tmp, err);
+		rp = ehbi_reserve(quotient, numer->bytes_used, err);
 		if (!rp) {
-			goto ehbi_n_choose_k_end;
+			goto ehbi_div_end;
 		}
-		rp = ehbi_set(&sum_k, result, err);
+		rp = ehbi_div_small(quotient, numer, d, &r, err);
 		if (!rp) {
-			goto ehbi_n_choose_k_end;
+			goto ehbi_div_end;
 		}
+		rp = ehbi_set_u64(remainder, r, err);
+	} else {
+		rp = ehbi_div_long(quotient, remainder, numerator, denominator,
+				   s, err);
+	}
+	if (!rp) {
+		goto ehbi_div_end;
 	}
-	/* result = (sum_n / sum_k); */
-	rp = ehbi_div(result, &tmp, &sum_n, &sum_k, err);
 
-ehbi_n_choose_k_end:
-	ehbi_set_or_malloc_free(&tmp, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&sum_n, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&sum_k, Ehbi_bi_buf_size);
+	if (numer_sign != denom_sign && !ehbi_is_zero(quotient)) {
+		ehbi_sign_set(quotient, 1);
+	}
+	Ehbi_assert_normal(quotient);
+	Ehbi_assert_normal(remainder);
 
+ehbi_div_end:
+	ehbi_set_or_malloc_free(s, &tmp);
+	/* if error, let's not return garbage or 1/2 an answer */
 	if (!rp) {
-		Ehbi_log_error_s_l_s("error ", *err, ", setting result = 0");
-		ehbi_zero(result);
+		ehbi_zero(quotient);
+		ehbi_zero(remainder);
 		return NULL;
 	}
+	return quotient;
+}
 
-	return result;
+struct ehbigint *ehbi_div(struct ehbigint *quotient, struct ehbigint *remainder,
+			  const struct ehbigint *numerator,
+			  const struct ehbigint *denominator, int *err)
+{
+	return ehbi_div_x(quotient, remainder, numerator, denominator, NULL,
+			  err);
 }
 
-struct ehbigint *ehbi_n_choose_k_l(struct ehbigint *result,
-				   const struct ehbigint *n, long k, int *err)
+struct ehbigint *ehbi_div_l(struct ehbigint *quotient,
+			    struct ehbigint *remainder,
+			    const struct ehbigint *numerator, long denominator,
+			    int *err)
 {
 	unsigned char bytes[sizeof(unsigned long)];
 	struct ehbigint temp;
@@ -1570,594 +2217,2456 @@ struct ehbigint *ehbi_n_choose_k_l(struct ehbigint *result,
 
 	temp.bytes = bytes;
 	temp.bytes_len = sizeof(unsigned long);
-	ehbi_internal_struct_l(&temp, k);
+	ehbi_internal_struct_l(&temp, denominator);
 
-	return ehbi_mul(result, n, &temp, err);
+	return ehbi_div(quotient, remainder, numerator, &temp, err);
 }
 
-struct ehbigint *ehbi_n_choose_k_ll(struct ehbigint *result, long n, long k,
-				    int *err)
+struct ehbigint *ehbi_div_u64(struct ehbigint *quotient,
+			      struct ehbigint *remainder,
+			      const struct ehbigint *numerator,
+			      uint64_t denominator, int *err)
 {
-	unsigned char n_bytes[sizeof(unsigned long)];
-	struct ehbigint temp_n;
-	unsigned char k_bytes[sizeof(unsigned long)];
-	struct ehbigint temp_k;
-
-	ehbi_internal_clear_null_struct(&temp_n);
-	ehbi_internal_clear_null_struct(&temp_k);
+	unsigned char bytes[sizeof(uint64_t)];
+	struct ehbigint temp;
 
-	temp_n.bytes = n_bytes;
-	temp_n.bytes_len = sizeof(unsigned long);
-	ehbi_internal_struct_l(&temp_n, n);
+	ehbi_internal_clear_null_struct(&temp);
 
-	temp_k.bytes = k_bytes;
-	temp_k.bytes_len = sizeof(unsigned long);
-	ehbi_internal_struct_l(&temp_k, k);
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(uint64_t);
+	ehbi_internal_struct_u64(&temp, denominator);
 
-	return ehbi_mul(result, &temp_n, &temp_k, err);
+	return ehbi_div(quotient, remainder, numerator, &temp, err);
 }
 
-#ifndef EHBI_SKIP_IS_PROBABLY_PRIME
-
-static struct ehbigint *ehbi_get_witness(size_t i, struct ehbigint *a,
-					 struct ehbigint *max_witness, int *err)
+#ifdef EHBI_HAVE_U128
+struct ehbigint *ehbi_div_u128(struct ehbigint *quotient,
+			       struct ehbigint *remainder,
+			       const struct ehbigint *numerator,
+			       ehbi_u128 denominator, int *err)
 {
-	int e;
-	size_t j, max_rnd, shift;
-	struct ehbigint *rp;
+	unsigned char bytes[sizeof(ehbi_u128)];
+	struct ehbigint temp;
 
-	long Small_primes[] = {
-		2, 3, 5, 7, 11, 13, 17, 19, 23, 29,
-#if EEMBED_HOSTED
-		31, 37, 41, 43, 47, 53, 59, 61, 67, 71,
-		73, 79, 83, 89, 97, 101, 103, 107, 109, 113,
-		127, 131, 137, 139, 149, 151, 157, 163, 167,
-		173, 179, 181, 191, 193, 197, 199, 211, 223,
-		227, 229, 233, 239, 241, 251, 257, 263, 269,
-		271, 277, 281, 283, 293, 307, 311, 313, 317,
-		331, 337, 347, 349, 353, 359, 367, 373, 379,
-		383, 389, 397, 401, 409, 419, 421, 431, 433,
-		439, 443, 449, 457, 461, 463, 467, 479, 487,
-		491, 499, 503, 509, 521, 523, 541, 547, 557,
-		563, 569, 571, 577, 587, 593, 599, 601, 607,
-		613, 617, 619, 631, 641, 643, 647, 653, 659,
-		661, 673, 677, 683, 691, 701, 709, 719, 727,
-		733, 739, 743, 751, 757, 761, 769, 773, 787,
-		797, 809, 811, 821, 823, 827, 829, 839, 853,
-		857, 859, 863, 877, 881, 883, 887, 907, 911,
-		919, 929, 937, 941, 947, 953, 967, 971, 977,
-#endif
-		983, 991, 997,
-		0		/* ZERO terminated */
-	};
+	ehbi_internal_clear_null_struct(&temp);
 
-	size_t Small_primes_len = (sizeof(Small_primes) / sizeof(long)) - 1;
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(ehbi_u128);
+	ehbi_internal_struct_u128(&temp, denominator);
 
-	rp = a;
-	if (i < EHBI_NUM_SMALL_PRIME_WITNESSES && i < Small_primes_len) {
-		rp = ehbi_set_l(a, Small_primes[i], err);
-	} else {
-		j = 0;
-		max_rnd = EHBI_MAX_TRIES_TO_GRAB_RANDOM_BYTES;
-		/* pick a random integer a in the range [2, n-2] */
-		do {
-			e = eembed_random_bytes(a->bytes, a->bytes_len);
-			if (e) {
-				Ehbi_log_error_s_l_s
-				    ("eembed_random_bytes returned error ", e,
-				     ", continuing with poor confidence!");
-				ehbi_set_error(err, EHBI_PRNG_ERROR);
-			}
-			a->bytes_used = a->bytes_len;
-			shift = a->bytes_len - max_witness->bytes_used;
-			rp = ehbi_shift_right(a, shift * EEMBED_CHAR_BIT);
-			ehbi_internal_reset_bytes_used(a, a->bytes_used + 1);
-		} while ((ehbi_greater_than(a, max_witness)
-			  || ehbi_less_than_l(a, 2)) && (j++ < max_rnd));
-	}
-	if (ehbi_greater_than(a, max_witness)
-	    || ehbi_less_than_l(a, 2)) {
-		/* but, too big, so do something totally bogus: */
-		rp = ehbi_set_l(a, 2 + i, err);
-	}
-	return rp;
+	return ehbi_div(quotient, remainder, numerator, &temp, err);
 }
+#endif
 
-/*
-   From:
-   https://en.wikipedia.org/wiki/Miller%E2%80%93Rabin_primality_test
+struct ehbigint *ehbi_sqrt_x(struct ehbigint *result,
+			     struct ehbigint *remainder,
+			     const struct ehbigint *val, struct ehbi_scratch *s,
+			     int *err)
+{
+	size_t size;
+	struct ehbigint zero, one, two;
+	struct ehbigint guess, temp, junk;
+	struct ehbigint *cur, *next, *swp;
+	unsigned char zbytes[2];
+	unsigned char obytes[2];
+	unsigned char tbytes[2];
+	struct ehbigint *rp;
+	unsigned char gues_bytes[Ehbi_bi_buf_size];
+	unsigned char temp_bytes[Ehbi_bi_buf_size];
+	unsigned char junk_bytes[Ehbi_bi_buf_size];
 
-   The algorithm can be written in pseudocode as follows:
+	rp = NULL;
+	ehbi_internal_clear_null_struct(&zero);
+	ehbi_internal_clear_null_struct(&one);
+	ehbi_internal_clear_null_struct(&two);
+	ehbi_internal_clear_null_struct(&guess);
+	ehbi_internal_clear_null_struct(&temp);
+	ehbi_internal_clear_null_struct(&junk);
 
-	Input #1: n > 3, an odd integer to be tested for primality;
-	Input #2: k, a parameter that determines the accuracy of the test
-	Output: composite if n is composite, otherwise probably prime
+	zero.bytes = zbytes;
+	zero.bytes_len = 2;
+	ehbi_zero(&zero);
 
-	write n-1 as (2^r)*d with d odd by factoring powers of 2 from n-1
-	WitnessLoop: repeat k times:
-		pick a random integer a in the range [2, n-2]
-		x := (a^d) mod n
-		if x = 1 or x = n-1 then
-			continue WitnessLoop
-		repeat r-1 times:
-			x := (x^2) mod n
-			if x = 1 then
-				return composite
-			if x = n-1 then
-				continue WitnessLoop
-		return composite
-	return probably prime
-*/
-int ehbi_is_probably_prime(const struct ehbigint *bi, unsigned int accuracy,
-			   int *err)
-{
-	size_t i, k;
-	int is_probably_prime, stop, local_err;
-	struct ehbigint bimin1, a, d, x, y, max_witness;
-	struct ehbigint *rp;
-	unsigned long r, c;
+	one.bytes = obytes;
+	one.bytes_len = 2;
+	ehbi_zero(&one);
+	ehbi_inc_l(&one, 1, err);
 
-	unsigned char bbytes[Ehbi_bi_buf_size];
-	unsigned char abytes[Ehbi_bi_buf_size];
-	unsigned char dbytes[Ehbi_bi_buf_size];
-	unsigned char xbytes[Ehbi_bi_buf_size];
-	unsigned char ybytes[Ehbi_bi_buf_size];
-	unsigned char wbytes[Ehbi_bi_buf_size];
+	two.bytes = tbytes;
+	two.bytes_len = 2;
+	ehbi_zero(&two);
+	ehbi_inc_l(&two, 2, err);
 
-	ehbi_internal_clear_null_struct(&bimin1);
-	ehbi_internal_clear_null_struct(&a);
-	ehbi_internal_clear_null_struct(&d);
-	ehbi_internal_clear_null_struct(&x);
-	ehbi_internal_clear_null_struct(&y);
-	ehbi_internal_clear_null_struct(&max_witness);
+	ehbi_zero(result);
 
-	rp = NULL;
+	ehbi_zero(remainder);
 
-	Ehbi_assert_bi(bi);
-	if (!err) {
-		local_err = EHBI_SUCCESS;
-		err = &local_err;
+	if (ehbi_less_than(val, &zero)) {
+		Ehbi_log_error0("square root of a negative would be complex");
+		ehbi_set_error(err, EHBI_SQRT_NEGATIVE);
+		return NULL;
 	}
 
-	is_probably_prime = 0;
-	if (ehbi_is_negative(bi)) {
-		return 0;
+	if (ehbi_equals(val, &zero)) {
+		return result;
 	}
 
-	rp = Ehbi_set_or_malloc(&bimin1, bbytes, Ehbi_bi_buf_size, bi, err);
-	if (!bi) {
-		goto ehbi_is_probably_prime_end;
-	}
-	rp = Ehbi_set_or_malloc(&max_witness, wbytes, Ehbi_bi_buf_size, bi,
-				err);
-	if (!rp) {
-		goto ehbi_is_probably_prime_end;
-	}
+	Ehbi_assert_bi(val);
 
-	rp = Ehbi_set_or_malloc(&a, abytes, Ehbi_bi_buf_size, bi, err);
+	/* (result + (val / result)) may carry a byte past val */
+	size = val->bytes_used + 1;
+	rp = Ehbi_tmp_reserve(s, &guess, gues_bytes, Ehbi_bi_buf_size, size,
+			      err);
 	if (!rp) {
-		goto ehbi_is_probably_prime_end;
-	}
-	rp = Ehbi_set_or_malloc(&d, dbytes, Ehbi_bi_buf_size, bi, err);
-	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+		return NULL;
 	}
-
-	/* cheating on d bytes used */
-	d.bytes_used = 2 + (bi->bytes_used * 2);
-	rp = Ehbi_set_or_malloc(&x, xbytes, Ehbi_bi_buf_size, &d, err);
+	rp = Ehbi_tmp_reserve(s, &temp, temp_bytes, Ehbi_bi_buf_size, size,
+			      err);
 	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+		goto ehbi_sqrt_end;
 	}
-	rp = Ehbi_set_or_malloc(&y, ybytes, Ehbi_bi_buf_size, &d, err);
+	rp = Ehbi_tmp_reserve(s, &junk, junk_bytes, Ehbi_bi_buf_size, size,
+			      err);
 	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+		goto ehbi_sqrt_end;
 	}
-	ehbi_zero(&d);
 
-	/* set d to 2, the first prime */
-	rp = ehbi_set_l(&d, 2, err);
+	/* odd cases below square root of 4 */
+	rp = ehbi_set_l(&temp, 4, err);
 	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+		goto ehbi_sqrt_end;
 	}
-
-	if (ehbi_less_than(bi, &d)) {
-		is_probably_prime = 0;
-		goto ehbi_is_probably_prime_end;
+	if (ehbi_less_than(val, &temp)) {
+		rp = ehbi_set_l(result, 1, err);
+		if (!rp) {
+			goto ehbi_sqrt_end;
+		}
+		rp = ehbi_subtract_x(remainder, val, result, s, err);
+		goto ehbi_sqrt_end;
 	}
 
-	/* 2 is the only even prime */
-	if (!ehbi_is_odd(bi)) {
-		is_probably_prime = ehbi_equals(bi, &d);
-		goto ehbi_is_probably_prime_end;
+	/* Initial estimate, never low */
+	/* result = (val / 2) + 1; */
+	rp = ehbi_div_x(result, &junk, val, &two, s, err);
+	if (!rp) {
+		goto ehbi_sqrt_end;
 	}
-
-	is_probably_prime = 1;
-	/*
-	   write n-1 as 2^r * d;
-	   with d odd by factoring powers of 2 from n-1
-	 */
-	rp = ehbi_subtract_l(&d, bi, 1, err);
+	rp = ehbi_inc_x(result, &one, s, err);
 	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+		goto ehbi_sqrt_end;
 	}
-	/* d is now bi-1 */
-	for (i = 0; 1; ++i) {
-		if (ehbi_is_odd(&d)) {
+
+	/* the guesses ping-pong between the result and guess */
+	cur = result;
+	next = &guess;
+	for (;;) {
+		/* next = (cur + (val / cur)) / 2; */
+		rp = ehbi_div_x(&temp, &junk, val, cur, s, err);
+		if (!rp) {
+			goto ehbi_sqrt_end;
+		}
+		rp = ehbi_inc_x(&temp, cur, s, err);
+		if (!rp) {
+			goto ehbi_sqrt_end;
+		}
+		rp = ehbi_div_x(next, &junk, &temp, &two, s, err);
+		if (!rp) {
+			goto ehbi_sqrt_end;
+		}
+		if (!ehbi_less_than(next, cur)) {
 			break;
 		}
-		ehbi_shift_right(&d, 1);
+		swp = cur;
+		cur = next;
+		next = swp;
 	}
-	r = i;
-
-	/* (bi-1) == 2^(r) * d */
-	rp = ehbi_set(&bimin1, bi, err);
+	if (cur != result) {
+		rp = ehbi_set(result, cur, err);
+		if (!rp) {
+			goto ehbi_sqrt_end;
+		}
+	}
+	rp = ehbi_mul_x(&temp, result, result, s, err);
 	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+		goto ehbi_sqrt_end;
 	}
-	rp = ehbi_dec_l(&bimin1, 1, err);
+	rp = ehbi_subtract_x(remainder, val, &temp, s, err);
+
+ehbi_sqrt_end:
+	ehbi_set_or_malloc_free(s, &guess);
+	ehbi_set_or_malloc_free(s, &temp);
+	ehbi_set_or_malloc_free(s, &junk);
+
 	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+		ehbi_zero(result);
+		ehbi_zero(remainder);
+		return NULL;
+	}
+
+	return result;
+}
+
+struct ehbigint *ehbi_sqrt(struct ehbigint *result, struct ehbigint *remainder,
+			   const struct ehbigint *val, int *err)
+{
+	return ehbi_sqrt_x(result, remainder, val, NULL, err);
+}
+
+struct ehbigint *ehbi_exp_x(struct ehbigint *result,
+			    const struct ehbigint *base,
+			    const struct ehbigint *exponent,
+			    struct ehbi_scratch *s, int *err)
+{
+	struct ehbigint loop;
+	struct ehbigint tmp;
+	struct ehbigint *rp, *cur, *next, *swp;
+	unsigned char lbytes[Ehbi_bi_buf_size];
+	unsigned char tbytes[Ehbi_bi_buf_size];
+
+	rp = NULL;
+	ehbi_internal_clear_null_struct(&loop);
+	ehbi_internal_clear_null_struct(&tmp);
+
+	/* counts up to the exponent */
+	rp = Ehbi_tmp_reserve(s, &loop, lbytes, Ehbi_bi_buf_size,
+			      exponent->bytes_used, err);
+	if (!rp) {
+		goto ehbi_exp_end;
+	}
+	/* the product must fit the result, and if it may grow, so may tmp */
+	rp = Ehbi_tmp_reserve_grow(s, &tmp, tbytes, Ehbi_bi_buf_size,
+				   result->bytes_len, ehbi_is_growable(result),
+				   err);
+	if (!rp) {
+		goto ehbi_exp_end;
+	}
+
+	rp = ehbi_set_l(result, 1, err);
+	if (!rp) {
+		goto ehbi_exp_end;
+	}
+
+	/* the products ping-pong between the result and tmp */
+	cur = result;
+	next = &tmp;
+	while (ehbi_less_than(&loop, exponent)) {
+		rp = ehbi_mul_x(next, cur, base, s, err);
+		if (!rp) {
+			goto ehbi_exp_end;
+		}
+		swp = cur;
+		cur = next;
+		next = swp;
+		rp = ehbi_inc_l_x(&loop, 1, s, err);
+		if (!rp) {
+			goto ehbi_exp_end;
+		}
+	}
+	if (cur != result) {
+		rp = ehbi_set(result, cur, err);
+	}
+
+ehbi_exp_end:
+	ehbi_set_or_malloc_free(s, &loop);
+	ehbi_set_or_malloc_free(s, &tmp);
+
+	if (!rp) {
+		ehbi_zero(result);
+		return 0;
+	}
+
+	return result;
+}
+
+struct ehbigint *ehbi_exp(struct ehbigint *result, const struct ehbigint *base,
+			  const struct ehbigint *exponent, int *err)
+{
+	return ehbi_exp_x(result, base, exponent, NULL, err);
+}
+
+struct ehbigint *ehbi_exp_l(struct ehbigint *result,
+			    const struct ehbigint *base, long exp, int *err)
+{
+	unsigned char bytes[sizeof(unsigned long)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(unsigned long);
+	ehbi_internal_struct_l(&temp, exp);
+
+	return ehbi_exp(result, base, &temp, err);
+}
+
+struct ehbigint *ehbi_exp_mod_x(struct ehbigint *result,
+				const struct ehbigint *base,
+				const struct ehbigint *exponent,
+				const struct ehbigint *modulus,
+				struct ehbi_scratch *s, int *err)
+{
+	size_t i, bits, size, product_size;
+	struct ehbigint tmp1, tjunk, tbase;
+	struct ehbigint *rp;
+	unsigned char t1_bytes[Ehbi_bi_buf_size];
+	unsigned char tb_bytes[Ehbi_bi_buf_size];
+	unsigned char tj_bytes[Ehbi_bi_buf_size];
+
+	ehbi_internal_clear_null_struct(&tmp1);
+	ehbi_internal_clear_null_struct(&tbase);
+	ehbi_internal_clear_null_struct(&tjunk);
+	rp = NULL;
+
+	Ehbi_assert_bi(result);
+	ehbi_zero(result);
+	Ehbi_assert_bi(base);
+	Ehbi_assert_bi(exponent);
+	Ehbi_assert_bi(modulus);
+
+	/* the products are of two values reduced mod the modulus */
+	product_size = 2 * modulus->bytes_used;
+	/* tbase and tjunk hold the remainder and quotient of base / modulus,
+	   then of each product / modulus */
+	size = base->bytes_used;
+	if (size < product_size) {
+		size = product_size;
+	}
+
+	rp = Ehbi_tmp_reserve(s, &tmp1, t1_bytes, Ehbi_bi_buf_size,
+			      product_size, err);
+	if (!rp) {
+		ehbi_zero(result);
+		return NULL;
+	}
+	rp = Ehbi_tmp_reserve(s, &tbase, tb_bytes, Ehbi_bi_buf_size, size, err);
+	if (!rp) {
+		goto ehbi_mod_exp_end;
+	}
+	rp = Ehbi_tmp_reserve(s, &tjunk, tj_bytes, Ehbi_bi_buf_size, size, err);
+	if (!rp) {
+		goto ehbi_mod_exp_end;
+	}
+
+	/* prevent divide by zero */
+	ehbi_zero(&tmp1);
+	if (ehbi_equals(modulus, &tmp1)) {
+		Ehbi_log_error0("modulus == 0");
+		ehbi_set_error(err, EHBI_DIVIDE_BY_ZERO);
+		goto ehbi_mod_exp_end;
+	}
+
+	/* prevent negative eponent */
+	if (ehbi_is_negative(exponent)) {
+		Ehbi_log_error0("exponent < 0");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		goto ehbi_mod_exp_end;
+	}
+
+	/*
+	   The following is an example in pseudocode based on Applied
+	   Cryptography: Protocols, Algorithms, and Source Code in C,
+	   Second Edition (2nd ed.), page 244.
+	   Schneier, Bruce (1996). Wiley. ISBN 978-0-471-11709-4.
+
+	   function modular_pow(base, exponent, modulus)
+	   if modulus = 1 then return 0
+	   Assert :: (modulus - 1) * (modulus - 1) does not overflow base
+	   result := 1
+	   base := base mod modulus
+	   while exponent > 0
+	   if (exponent mod 2 == 1):
+	   result := (result * base) mod modulus
+	   exponent := exponent >> 1
+	   base := (base * base) mod modulus
+	   return result
+
+	   See Also:
+	   https://en.wikipedia.org/wiki/Modular_exponentiation#Right-to-left_binary_method
+	 */
+
+	/* if modulus == 1 then return 0 */
+	rp = ehbi_set_l(&tmp1, 1, err);
+	if (!rp) {
+		goto ehbi_mod_exp_end;
+	}
+
+	if (ehbi_equals(modulus, &tmp1)) {
+		ehbi_zero(result);
+		goto ehbi_mod_exp_end;
+	}
+
+	/* result := 1 */
+	rp = ehbi_set_l(result, 1, err);
+	if (!rp) {
+		goto ehbi_mod_exp_end;
+	}
+
+	/* base := base mod modulus */
+	rp = ehbi_div_x(&tjunk, &tbase, base, modulus, s, err);
+	if (!rp) {
+		goto ehbi_mod_exp_end;
+	}
+
+	/* the bits of the exponent are read in place, low to high */
+	bits = ehbi_bit_length(exponent);
+	for (i = 0; i < bits; ++i) {
+		/* if (exponent mod 2 == 1): */
+		if (ehbi_test_bit(exponent, i)) {
+			/* result := (result * base) mod modulus */
+			rp = ehbi_mul_x(&tmp1, result, &tbase, s, err);
+			if (!rp) {
+				goto ehbi_mod_exp_end;
+			}
+			rp = ehbi_div_x(&tjunk, result, &tmp1, modulus, s, err);
+			if (!rp) {
+				goto ehbi_mod_exp_end;
+			}
+		}
+
+		/* after the top bit, the square would not be used */
+		if (i + 1 == bits) {
+			break;
+		}
+
+		/* base := (base * base) mod modulus */
+		rp = ehbi_mul_x(&tmp1, &tbase, &tbase, s, err);
+		if (!rp) {
+			goto ehbi_mod_exp_end;
+		}
+		rp = ehbi_div_x(&tjunk, &tbase, &tmp1, modulus, s, err);
+		if (!rp) {
+			goto ehbi_mod_exp_end;
+		}
+	}
+
+	/* return result */
+
+ehbi_mod_exp_end:
+	ehbi_set_or_malloc_free(s, &tmp1);
+	ehbi_set_or_malloc_free(s, &tbase);
+	ehbi_set_or_malloc_free(s, &tjunk);
+
+	if (!rp) {
+		ehbi_zero(result);
+		return NULL;
+	}
+
+	return result;
+}
+
+struct ehbigint *ehbi_exp_mod(struct ehbigint *result,
+			      const struct ehbigint *base,
+			      const struct ehbigint *exponent,
+			      const struct ehbigint *modulus, int *err)
+{
+	return ehbi_exp_mod_x(result, base, exponent, modulus, NULL, err);
+}
+
+struct ehbigint *ehbi_exp_mod_l(struct ehbigint *result,
+				const struct ehbigint *base,
+				const struct ehbigint *exponent, long modulus,
+				int *err)
+{
+	unsigned char bytes[sizeof(unsigned long)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(unsigned long);
+
+	ehbi_internal_struct_l(&temp, modulus);
+
+	return ehbi_exp_mod(result, base, exponent, &temp, err);
+}
+
+struct ehbigint *ehbi_exp_mod_ll(struct ehbigint *result,
+				 const struct ehbigint *base, long exponent,
+				 long modulus, int *err)
+{
+	unsigned char bytes1[sizeof(unsigned long)];
+	struct ehbigint temp1;
+	unsigned char bytes2[sizeof(unsigned long)];
+	struct ehbigint temp2;
+
+	ehbi_internal_clear_null_struct(&temp1);
+	ehbi_internal_clear_null_struct(&temp2);
+
+	temp1.bytes = bytes1;
+	temp1.bytes_len = sizeof(unsigned long);
+
+	temp2.bytes = bytes2;
+	temp2.bytes_len = sizeof(unsigned long);
+
+	ehbi_internal_struct_l(&temp1, exponent);
+	ehbi_internal_struct_l(&temp2, modulus);
+
+	return ehbi_exp_mod(result, base, &temp1, &temp2, err);
+}
+
+struct ehbigint *ehbi_exp_mod_u64(struct ehbigint *result,
+				  const struct ehbigint *base,
+				  const struct ehbigint *exponent,
+				  uint64_t modulus, int *err)
+{
+	unsigned char bytes[sizeof(uint64_t)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(uint64_t);
+	ehbi_internal_struct_u64(&temp, modulus);
+
+	return ehbi_exp_mod(result, base, exponent, &temp, err);
+}
+
+#ifdef EHBI_HAVE_U128
+struct ehbigint *ehbi_exp_mod_u128(struct ehbigint *result,
+				   const struct ehbigint *base,
+				   const struct ehbigint *exponent,
+				   ehbi_u128 modulus, int *err)
+{
+	unsigned char bytes[sizeof(ehbi_u128)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(ehbi_u128);
+	ehbi_internal_struct_u128(&temp, modulus);
+
+	return ehbi_exp_mod(result, base, exponent, &temp, err);
+}
+#endif
+
+struct ehbigint *ehbi_inc_x(struct ehbigint *bi, const struct ehbigint *val,
+			    struct ehbi_scratch *s, int *err)
+{
+	/* the add is alias-safe, so no copy of bi is needed */
+	return ehbi_add_x(bi, bi, val, s, err);
+}
+
+struct ehbigint *ehbi_inc(struct ehbigint *bi, const struct ehbigint *val,
+			  int *err)
+{
+	return ehbi_inc_x(bi, val, NULL, err);
+}
+
+static struct ehbigint *ehbi_inc_l_x(struct ehbigint *bi, long val,
+				     struct ehbi_scratch *s, int *err)
+{
+	unsigned char bytes[sizeof(unsigned long)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(unsigned long);
+
+	ehbi_internal_struct_l(&temp, val);
+
+	return ehbi_inc_x(bi, &temp, s, err);
+}
+
+struct ehbigint *ehbi_inc_l(struct ehbigint *bi, long val, int *err)
+{
+	return ehbi_inc_l_x(bi, val, NULL, err);
+}
+
+struct ehbigint *ehbi_dec_x(struct ehbigint *bi, const struct ehbigint *val,
+			    struct ehbi_scratch *s, int *err)
+{
+	/* the subtract is alias-safe, so no copy of bi is needed */
+	return ehbi_subtract_x(bi, bi, val, s, err);
+}
+
+struct ehbigint *ehbi_dec(struct ehbigint *bi, const struct ehbigint *val,
+			  int *err)
+{
+	return ehbi_dec_x(bi, val, NULL, err);
+}
+
+static struct ehbigint *ehbi_dec_l_x(struct ehbigint *bi, long val,
+				     struct ehbi_scratch *s, int *err)
+{
+	unsigned char bytes[sizeof(unsigned long)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(unsigned long);
+	ehbi_internal_struct_l(&temp, val);
+
+	return ehbi_dec_x(bi, &temp, s, err);
+}
+
+struct ehbigint *ehbi_dec_l(struct ehbigint *bi, long val, int *err)
+{
+	return ehbi_dec_l_x(bi, val, NULL, err);
+}
+
+struct ehbigint *ehbi_subtract_x(struct ehbigint *res,
+				 const struct ehbigint *bi1,
+				 const struct ehbigint *bi2,
+				 struct ehbi_scratch *s, int *err)
+{
+	Ehbi_assert_bi(bi2);
+
+	return ehbi_add_signed_x(res, bi1, bi2, ehbi_sign(bi2) ? 0 : 1, s,
+				 err);
+}
+
+struct ehbigint *ehbi_subtract(struct ehbigint *res, const struct ehbigint *bi1,
+			       const struct ehbigint *bi2, int *err)
+{
+	return ehbi_subtract_x(res, bi1, bi2, NULL, err);
+}
+
+static struct ehbigint *ehbi_subtract_l_x(struct ehbigint *res,
+					  const struct ehbigint *bi1, long v2,
+					  struct ehbi_scratch *s, int *err)
+{
+	unsigned char bytes[sizeof(unsigned long)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(unsigned long);
+	ehbi_internal_struct_l(&temp, v2);
+
+	return ehbi_subtract_x(res, bi1, &temp, s, err);
+}
+
+struct ehbigint *ehbi_subtract_l(struct ehbigint *res,
+				 const struct ehbigint *bi1, long v2, int *err)
+{
+	return ehbi_subtract_l_x(res, bi1, v2, NULL, err);
+}
+
+struct ehbigint *ehbi_subtract_u64(struct ehbigint *res,
+				   const struct ehbigint *bi1, uint64_t v2,
+				   int *err)
+{
+	unsigned char bytes[sizeof(uint64_t)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(uint64_t);
+	ehbi_internal_struct_u64(&temp, v2);
+
+	return ehbi_subtract(res, bi1, &temp, err);
+}
+
+#ifdef EHBI_HAVE_U128
+struct ehbigint *ehbi_subtract_u128(struct ehbigint *res,
+				    const struct ehbigint *bi1, ehbi_u128 v2,
+				    int *err)
+{
+	unsigned char bytes[sizeof(ehbi_u128)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(ehbi_u128);
+	ehbi_internal_struct_u128(&temp, v2);
+
+	return ehbi_subtract(res, bi1, &temp, err);
+}
+#endif
+
+/*
+   the shifts move whole bytes with a memmove, or if there is a remainder
+   of bits, in a single pass which funnels the bits from the neighbouring
+   byte; moving up, the high bytes are written first, moving down, the low
+   bytes are written first, so each byte is read before it is written
+*/
+struct ehbigint *ehbi_shift_right(struct ehbigint *bi, unsigned long num_bits)
+{
+	size_t i, bits, bytes, used;
+	unsigned shift;
+	unsigned char hi;
+
+	Ehbi_assert_bi(bi);
+
+	bits = ehbi_bit_length(bi);
+	if (num_bits >= bits) {
+		return ehbi_zero(bi);
+	}
+
+	bytes = num_bits / EEMBED_CHAR_BIT;
+	shift = num_bits % EEMBED_CHAR_BIT;
+	used = ((bits - num_bits) + EEMBED_CHAR_BIT - 1) / EEMBED_CHAR_BIT;
+
+	if (shift == 0) {
+		eembed_memmove(bi->bytes, bi->bytes + bytes, used);
+	} else {
+		for (i = 0; i < used; ++i) {
+			hi = (i + bytes + 1 < bi->bytes_used)
+			    ? bi->bytes[i + bytes + 1] : 0x00;
+			bi->bytes[i] = (unsigned char)
+			    ((bi->bytes[i + bytes] >> shift)
+			     | (hi << (EEMBED_CHAR_BIT - shift)));
+		}
+	}
+
+	/* the new length follows from the bit length, no scan needed */
+	bi->bytes_used = used;
+	Ehbi_assert_normal(bi);
+
+	return bi;
+}
+
+struct ehbigint *ehbi_shift_left(struct ehbigint *bi, unsigned long num_bits,
+				 unsigned long *overflow)
+{
+	size_t i, bits, avail, bytes, used;
+	unsigned shift;
+	unsigned long lost;
+	unsigned char hi, lo;
+
+	Ehbi_assert_bi(bi);
+
+	if (overflow) {
+		*overflow = 0;
+	}
+	bits = ehbi_bit_length(bi);
+	if (bits == 0 || num_bits == 0) {
+		return bi;
+	}
+
+	/* the bits which would go past the end are lost */
+	avail = (EEMBED_CHAR_BIT * bi->bytes_len) - bits;
+	lost = (num_bits > avail) ? (num_bits - avail) : 0;
+	if (overflow) {
+		*overflow = lost;
+	}
+	if (num_bits / EEMBED_CHAR_BIT >= bi->bytes_len) {
+		return ehbi_zero(bi);
+	}
+
+	bytes = num_bits / EEMBED_CHAR_BIT;
+	shift = num_bits % EEMBED_CHAR_BIT;
+	if (lost) {
+		used = bi->bytes_len;
+	} else {
+		used = (bits + num_bits + EEMBED_CHAR_BIT - 1)
+		    / EEMBED_CHAR_BIT;
+	}
+
+	if (shift == 0) {
+		i = used - bytes;
+		if (i > bi->bytes_used) {
+			i = bi->bytes_used;
+		}
+		eembed_memmove(bi->bytes + bytes, bi->bytes, i);
+	} else {
+		for (i = used; i > bytes; --i) {
+			hi = (i - 1 - bytes < bi->bytes_used)
+			    ? bi->bytes[i - 1 - bytes] : 0x00;
+			lo = (i - 1 - bytes > 0
+			      && i - 2 - bytes < bi->bytes_used)
+			    ? bi->bytes[i - 2 - bytes] : 0x00;
+			bi->bytes[i - 1] = (unsigned char)
+			    ((hi << shift) | (lo >> (EEMBED_CHAR_BIT - shift)));
+		}
+	}
+	eembed_memset(bi->bytes, 0x00, bytes);
+
+	bi->bytes_used = used;
+	if (lost) {
+		/* the high bits are gone, and only a scan can find the top */
+		while (bi->bytes_used > 1
+		       && bi->bytes[bi->bytes_used - 1] == 0x00) {
+			--(bi->bytes_used);
+		}
+		if (ehbi_is_zero(bi)) {
+			ehbi_sign_set(bi, 0);
+		}
+	}
+	Ehbi_assert_normal(bi);
+
+	return bi;
+}
+
+struct ehbigint *ehbi_n_choose_k_x(struct ehbigint *result,
+				   const struct ehbigint *n,
+				   const struct ehbigint *k,
+				   struct ehbi_scratch *s, int *err)
+{
+	size_t i, size;
+	int local_error;
+	struct ehbigint sum_n, sum_k, tmp, n_min_k;
+	struct ehbigint *rp, *cur_n, *cur_k, *spare, *swp;
+	unsigned char tbytes[Ehbi_bi_buf_size];
+	unsigned char nbytes[Ehbi_bi_buf_size];
+	unsigned char kbytes[Ehbi_bi_buf_size];
+	unsigned char nkbytes[Ehbi_bi_buf_size];
+	int grow;
+
+	ehbi_internal_clear_null_struct(&sum_n);
+	ehbi_internal_clear_null_struct(&sum_k);
+	ehbi_internal_clear_null_struct(&tmp);
+	ehbi_internal_clear_null_struct(&n_min_k);
+
+	Ehbi_assert_bi(result);
+	Ehbi_assert_bi(n);
+	Ehbi_assert_bi(k);
+	if (!err) {
+		local_error = EHBI_SUCCESS;
+		err = &local_error;
+	}
+	rp = ehbi_zero(result);
+
+	if (ehbi_greater_than(k, n) || ehbi_less_than_l(k, 0)) {
+		rp = ehbi_set_l(result, 0, err);
+		goto ehbi_n_choose_k_end;
+	}
+
+	if (ehbi_equals_l(k, 0) || ehbi_equals(k, n)) {
+		rp = ehbi_set_l(result, 1, err);
+		goto ehbi_n_choose_k_end;
+	}
+
+	if (ehbi_equals_l(k, 1)) {
+		rp = ehbi_set(result, n, err);
+		goto ehbi_n_choose_k_end;
+	}
+
+	/* (n choose k) == (n choose (n - k)), fewer terms keep products small */
+	rp = Ehbi_tmp_reserve(s, &n_min_k, nkbytes, Ehbi_bi_buf_size,
+			      n->bytes_used, err);
+	if (!rp) {
+		goto ehbi_n_choose_k_end;
+	}
+	rp = ehbi_subtract_x(&n_min_k, n, k, s, err);
+	if (!rp) {
+		goto ehbi_n_choose_k_end;
+	}
+	if (ehbi_less_than(&n_min_k, k)) {
+		k = &n_min_k;
+	}
+
+	if (ehbi_greater_than_l(k, LONG_MAX)) {
+		Ehbi_log_error_s_ul_s("k larger than ", LONG_MAX, "");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		rp = NULL;
+		goto ehbi_n_choose_k_end;
+	}
+
+	/* the running products are computed in the result, so the
+	   temporaries need not be larger, but must hold n - i and k - i */
+	size = result->bytes_len;
+	if (size < n->bytes_used + 1) {
+		size = n->bytes_used + 1;
+	}
+
+	/* the running products may grow larger than the result */
+	grow = ehbi_is_growable(result);
+
+	rp = Ehbi_tmp_reserve_grow(s, &tmp, tbytes, Ehbi_bi_buf_size, size,
+				   grow, err);
+	if (!rp) {
+		goto ehbi_n_choose_k_end;
+	}
+	rp = Ehbi_tmp_reserve_grow(s, &sum_n, nbytes, Ehbi_bi_buf_size, size,
+				   grow, err);
+	if (!rp) {
+		goto ehbi_n_choose_k_end;
+	}
+	rp = Ehbi_tmp_reserve_grow(s, &sum_k, kbytes, Ehbi_bi_buf_size, size,
+				   grow, err);
+	if (!rp) {
+		goto ehbi_n_choose_k_end;
+	}
+
+	rp = ehbi_set(&sum_n, n, err);
+	if (!rp) {
+		goto ehbi_n_choose_k_end;
+	}
+	rp = ehbi_set(&sum_k, k, err);
+	if (!rp) {
+		goto ehbi_n_choose_k_end;
+	}
+
+	/* each product goes to the spare, which then swaps places with the
+	   running product, so the three buffers rotate without copies */
+	cur_n = &sum_n;
+	cur_k = &sum_k;
+	spare = result;
+	for (i = 1; ehbi_greater_than_l(k, i); ++i) {
+		/* sum_n *= (n - i); */
+		rp = ehbi_set_l(&tmp, -((long)i), err);
+		if (!rp) {
+			goto ehbi_n_choose_k_end;
+		}
+		rp = ehbi_inc_x(&tmp, n, s, err);
+		if (!rp) {
+			goto ehbi_n_choose_k_end;
+		}
+		rp = ehbi_mul_x(spare, cur_n, &tmp, s, err);
+		if (!rp) {
+			goto ehbi_n_choose_k_end;
+		}
+		swp = cur_n;
+		cur_n = spare;
+		spare = swp;
+
+		/* sum_k *= (k - i) */
+		rp = ehbi_set_l(&tmp, -((long)i), err);
+		if (!rp) {
+			goto ehbi_n_choose_k_end;
+		}
+		rp = ehbi_inc_x(&tmp, k, s, err);
+		if (!rp) {
+			goto ehbi_n_choose_k_end;
+		}
+		rp = ehbi_mul_x(spare, cur_k, &tmp, s, err);
+		if (!rp) {
+			goto ehbi_n_choose_k_end;
+		}
+		swp = cur_k;
+		cur_k = spare;
+		spare = swp;
+	}
+
+	/* the quotient goes to the result, thus neither operand may be it */
+	if (spare != result) {
+		swp = (cur_n == result) ? cur_n : cur_k;
+		rp = ehbi_set(spare, swp, err);
+		if (!rp) {
+			goto ehbi_n_choose_k_end;
+		}
+		if (cur_n == result) {
+			cur_n = spare;
+		} else {
+			cur_k = spare;
+		}
+	}
+
+	/* result = (sum_n / sum_k); */
+	rp = ehbi_div_x(result, &tmp, cur_n, cur_k, s, err);
+
+ehbi_n_choose_k_end:
+	ehbi_set_or_malloc_free(s, &tmp);
+	ehbi_set_or_malloc_free(s, &sum_n);
+	ehbi_set_or_malloc_free(s, &sum_k);
+	ehbi_set_or_malloc_free(s, &n_min_k);
+
+	if (!rp) {
+		Ehbi_log_error_s_l_s("error ", *err, ", setting result = 0");
+		ehbi_zero(result);
+		return NULL;
+	}
+
+	return result;
+}
+
+struct ehbigint *ehbi_n_choose_k(struct ehbigint *result,
+				 const struct ehbigint *n,
+				 const struct ehbigint *k, int *err)
+{
+	return ehbi_n_choose_k_x(result, n, k, NULL, err);
+}
+
+struct ehbigint *ehbi_n_choose_k_l(struct ehbigint *result,
+				   const struct ehbigint *n, long k, int *err)
+{
+	unsigned char bytes[sizeof(unsigned long)];
+	struct ehbigint temp;
+
+	ehbi_internal_clear_null_struct(&temp);
+
+	temp.bytes = bytes;
+	temp.bytes_len = sizeof(unsigned long);
+	ehbi_internal_struct_l(&temp, k);
+
+	return ehbi_mul(result, n, &temp, err);
+}
+
+struct ehbigint *ehbi_n_choose_k_ll(struct ehbigint *result, long n, long k,
+				    int *err)
+{
+	unsigned char n_bytes[sizeof(unsigned long)];
+	struct ehbigint temp_n;
+	unsigned char k_bytes[sizeof(unsigned long)];
+	struct ehbigint temp_k;
+
+	ehbi_internal_clear_null_struct(&temp_n);
+	ehbi_internal_clear_null_struct(&temp_k);
+
+	temp_n.bytes = n_bytes;
+	temp_n.bytes_len = sizeof(unsigned long);
+	ehbi_internal_struct_l(&temp_n, n);
+
+	temp_k.bytes = k_bytes;
+	temp_k.bytes_len = sizeof(unsigned long);
+	ehbi_internal_struct_l(&temp_k, k);
+
+	return ehbi_mul(result, &temp_n, &temp_k, err);
+}
+
+#ifndef EHBI_SKIP_IS_PROBABLY_PRIME
+
+static struct ehbigint *ehbi_get_witness(size_t i, struct ehbigint *a,
+					 struct ehbigint *max_witness, int *err)
+{
+	int e;
+	size_t j, max_rnd;
+	struct ehbigint *rp;
+
+	long Small_primes[] = {
+		2, 3, 5, 7, 11, 13, 17, 19, 23, 29,
+#if EEMBED_HOSTED
+		31, 37, 41, 43, 47, 53, 59, 61, 67, 71,
+		73, 79, 83, 89, 97, 101, 103, 107, 109, 113,
+		127, 131, 137, 139, 149, 151, 157, 163, 167,
+		173, 179, 181, 191, 193, 197, 199, 211, 223,
+		227, 229, 233, 239, 241, 251, 257, 263, 269,
+		271, 277, 281, 283, 293, 307, 311, 313, 317,
+		331, 337, 347, 349, 353, 359, 367, 373, 379,
+		383, 389, 397, 401, 409, 419, 421, 431, 433,
+		439, 443, 449, 457, 461, 463, 467, 479, 487,
+		491, 499, 503, 509, 521, 523, 541, 547, 557,
+		563, 569, 571, 577, 587, 593, 599, 601, 607,
+		613, 617, 619, 631, 641, 643, 647, 653, 659,
+		661, 673, 677, 683, 691, 701, 709, 719, 727,
+		733, 739, 743, 751, 757, 761, 769, 773, 787,
+		797, 809, 811, 821, 823, 827, 829, 839, 853,
+		857, 859, 863, 877, 881, 883, 887, 907, 911,
+		919, 929, 937, 941, 947, 953, 967, 971, 977,
+#endif
+		983, 991, 997,
+		0		/* ZERO terminated */
+	};
+
+	size_t Small_primes_len = (sizeof(Small_primes) / sizeof(long)) - 1;
+
+	rp = a;
+	if (i < EHBI_NUM_SMALL_PRIME_WITNESSES && i < Small_primes_len) {
+		rp = ehbi_set_l(a, Small_primes[i], err);
+	} else {
+		j = 0;
+		max_rnd = EHBI_MAX_TRIES_TO_GRAB_RANDOM_BYTES;
+		eembed_assert(a->bytes_len >= max_witness->bytes_used);
+		/* pick a random integer a in the range [2, n-2], from as many
+		   random bytes as n-2 has, with the zero top bytes trimmed */
+		do {
+			e = eembed_random_bytes(a->bytes,
+						max_witness->bytes_used);
+			if (e) {
+				Ehbi_log_error_s_l_s
+				    ("eembed_random_bytes returned error ", e,
+				     ", continuing with poor confidence!");
+				ehbi_set_error(err, EHBI_PRNG_ERROR);
+			}
+			a->bytes_used = max_witness->bytes_used;
+			while (a->bytes_used > 1
+			       && a->bytes[a->bytes_used - 1] == 0x00) {
+				--a->bytes_used;
+			}
+			ehbi_sign_set(a, 0);
+			Ehbi_assert_normal(a);
+			rp = a;
+		} while ((ehbi_greater_than(a, max_witness)
+			  || ehbi_less_than_l(a, 2)) && (j++ < max_rnd));
+	}
+	if (ehbi_greater_than(a, max_witness)
+	    || ehbi_less_than_l(a, 2)) {
+		/* but, too big, so do something totally bogus: */
+		rp = ehbi_set_l(a, 2 + i, err);
+	}
+	return rp;
+}
+
+/*
+   From:
+   https://en.wikipedia.org/wiki/Miller%E2%80%93Rabin_primality_test
+
+   The algorithm can be written in pseudocode as follows:
+
+	Input #1: n > 3, an odd integer to be tested for primality;
+	Input #2: k, a parameter that determines the accuracy of the test
+	Output: composite if n is composite, otherwise probably prime
+
+	write n-1 as (2^r)*d with d odd by factoring powers of 2 from n-1
+	WitnessLoop: repeat k times:
+		pick a random integer a in the range [2, n-2]
+		x := (a^d) mod n
+		if x = 1 or x = n-1 then
+			continue WitnessLoop
+		repeat r-1 times:
+			x := (x^2) mod n
+			if x = 1 then
+				return composite
+			if x = n-1 then
+				continue WitnessLoop
+		return composite
+	return probably prime
+*/
+int ehbi_is_probably_prime_x(const struct ehbigint *bi, unsigned int accuracy,
+			     struct ehbi_scratch *s, int *err)
+{
+	size_t i, k, size;
+	int is_probably_prime, stop, local_err;
+	struct ehbigint bimin1, a, d, x, y, max_witness;
+	struct ehbigint *rp;
+	unsigned long r, c;
+
+	unsigned char bbytes[Ehbi_bi_buf_size];
+	unsigned char abytes[Ehbi_bi_buf_size];
+	unsigned char dbytes[Ehbi_bi_buf_size];
+	unsigned char xbytes[Ehbi_bi_buf_size];
+	unsigned char ybytes[Ehbi_bi_buf_size];
+	unsigned char wbytes[Ehbi_bi_buf_size];
+
+	ehbi_internal_clear_null_struct(&bimin1);
+	ehbi_internal_clear_null_struct(&a);
+	ehbi_internal_clear_null_struct(&d);
+	ehbi_internal_clear_null_struct(&x);
+	ehbi_internal_clear_null_struct(&y);
+	ehbi_internal_clear_null_struct(&max_witness);
+
+	rp = NULL;
+
+	Ehbi_assert_bi(bi);
+	if (!err) {
+		local_err = EHBI_SUCCESS;
+		err = &local_err;
+	}
+
+	is_probably_prime = 0;
+	if (ehbi_is_negative(bi)) {
+		return 0;
+	}
+
+	size = bi->bytes_used;
+	rp = Ehbi_tmp_reserve(s, &bimin1, bbytes, Ehbi_bi_buf_size, size, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+	rp = Ehbi_tmp_reserve(s, &max_witness, wbytes, Ehbi_bi_buf_size, size,
+			      err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+	rp = Ehbi_tmp_reserve(s, &a, abytes, Ehbi_bi_buf_size, size, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+	rp = Ehbi_tmp_reserve(s, &d, dbytes, Ehbi_bi_buf_size, size, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+
+	/* x and y are the results of exp_mod, which squares values mod bi */
+	size = 2 + (bi->bytes_used * 2);
+	rp = Ehbi_tmp_reserve(s, &x, xbytes, Ehbi_bi_buf_size, size, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+	rp = Ehbi_tmp_reserve(s, &y, ybytes, Ehbi_bi_buf_size, size, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+
+	/* set d to 2, the first prime */
+	rp = ehbi_set_l(&d, 2, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+
+	if (ehbi_less_than(bi, &d)) {
+		is_probably_prime = 0;
+		goto ehbi_is_probably_prime_end;
+	}
+
+	/* 2 is the only even prime */
+	if (!ehbi_is_odd(bi)) {
+		is_probably_prime = ehbi_equals(bi, &d);
+		goto ehbi_is_probably_prime_end;
+	}
+
+	is_probably_prime = 1;
+	/*
+	   write n-1 as 2^r * d;
+	   with d odd by factoring powers of 2 from n-1
+	 */
+	rp = ehbi_subtract_l_x(&d, bi, 1, s, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+	/* d is now bi-1, the factors of 2 are removed in one shift */
+	r = ehbi_count_trailing_zeros(&d);
+	ehbi_shift_right(&d, r);
+
+	/* (bi-1) == 2^(r) * d */
+	rp = ehbi_set(&bimin1, bi, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+	rp = ehbi_dec_l_x(&bimin1, 1, s, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+
+	/* we will set max_witness at n-2 */
+	rp = ehbi_set(&max_witness, bi, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+	rp = ehbi_dec_l_x(&max_witness, 2, s, err);
+	if (!rp) {
+		goto ehbi_is_probably_prime_end;
+	}
+
+	if (accuracy == 0) {
+		k = EHBI_DEFAULT_TRIALS_FOR_IS_PROBABLY_PRIME;
+	} else if (accuracy < EHBI_MIN_TRIALS_FOR_IS_PROBABLY_PRIME) {
+		k = EHBI_MIN_TRIALS_FOR_IS_PROBABLY_PRIME;
+	} else {
+		k = accuracy;
+	}
+
+	/*
+	   WitnessLoop: repeat k times:
+	 */
+	for (i = 0; i < k; ++i) {
+		rp = ehbi_get_witness(i, &a, &max_witness, err);
+		if (!rp) {
+			goto ehbi_is_probably_prime_end;
+		}
+
+		/* still too big, we are done */
+		if (ehbi_greater_than(&a, &max_witness)) {
+			is_probably_prime = 1;
+			goto ehbi_is_probably_prime_end;
+		}
+
+		/* x := a^d mod n */
+		rp = ehbi_exp_mod_x(&x, &a, &d, bi, s, err);
+		if (!rp) {
+			goto ehbi_is_probably_prime_end;
+		}
+
+		/* if x == 1 or x == n-1 then continue WitnessLoop */
+		if (ehbi_equals_l(&x, 1)) {
+			continue;
+		}
+		if (ehbi_equals(&x, &bimin1)) {
+			continue;
+		}
+
+		/* repeat r-1 times: */
+		stop = 0;
+		for (c = r - 1; !stop && c > 0; --c) {
+			/* x := x^2 mod n */
+			rp = ehbi_set(&y, &x, err);
+			if (!rp) {
+				goto ehbi_is_probably_prime_end;
+			} else {
+				struct ehbigint exp;
+				unsigned char exp_bytes[sizeof(unsigned long)];
+
+				ehbi_internal_clear_null_struct(&exp);
+				exp.bytes = exp_bytes;
+				exp.bytes_len = sizeof(unsigned long);
+
+				ehbi_internal_struct_l(&exp, 2);
+
+				rp = ehbi_exp_mod_x(&x, &y, &exp, bi, s, err);
+				if (!rp) {
+					goto ehbi_is_probably_prime_end;
+				}
+			}
+
+			/* if x == 1 then return composite */
+			if (ehbi_equals_l(&x, 1)) {
+				is_probably_prime = 0;
+				goto ehbi_is_probably_prime_end;
+			}
+
+			/* if x == n-1 then continue WitnessLoop */
+			if (ehbi_equals(&x, &bimin1)) {
+				stop = 1;
+				break;
+			}
+		}
+		if (!stop) {
+			is_probably_prime = 0;
+			goto ehbi_is_probably_prime_end;
+		}
+	}
+
+	/* return probably prime */
+	is_probably_prime = 1;
+
+ehbi_is_probably_prime_end:
+	if (!rp) {
+		Ehbi_log_error_s_l_s("error ", *err,
+				     ", setting is_probably_prime = 0");
+		is_probably_prime = 0;
+	}
+
+	ehbi_set_or_malloc_free(s, &y);
+	ehbi_set_or_malloc_free(s, &x);
+	ehbi_set_or_malloc_free(s, &d);
+	ehbi_set_or_malloc_free(s, &a);
+	ehbi_set_or_malloc_free(s, &max_witness);
+	ehbi_set_or_malloc_free(s, &bimin1);
+
+	return is_probably_prime;
+}
+
+int ehbi_is_probably_prime(const struct ehbigint *bi, unsigned int accuracy,
+			   int *err)
+{
+	return ehbi_is_probably_prime_x(bi, accuracy, NULL, err);
+}
+
+#endif /* EHBI_SKIP_IS_PROBABLY_PRIME */
+
+struct ehbigint *ehbi_negate(struct ehbigint *bi)
+{
+	Ehbi_assert_bi(bi);
+
+	ehbi_sign_set(bi, (ehbi_sign(bi) == 0) ? 1 : 0);
+
+	return bi;
+}
+
+int ehbi_is_negative(const struct ehbigint *bi)
+{
+	Ehbi_assert_bi(bi);
+	if (ehbi_is_zero(bi)) {
+		eembed_assert(ehbi_sign(bi) == 0);
+	}
+
+	return (ehbi_sign(bi) == 0) ? 0 : 1;
+}
+
+int ehbi_compare(const struct ehbigint *bi1, const struct ehbigint *bi2)
+{
+	size_t i;
+	unsigned char a, b;
+	int rv, b1_pos, b2_pos;
+
+	rv = 0;
+
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+	b1_pos = !ehbi_is_negative(bi1);
+	b2_pos = !ehbi_is_negative(bi2);
+
+	if (b1_pos != b2_pos) {
+		rv = b1_pos ? 1 : -1;
+		return rv;
+	}
+
+	if (bi1->bytes_used > bi2->bytes_used) {
+		rv = b1_pos ? 1 : -1;
+		return rv;
+	} else if (bi1->bytes_used < bi2->bytes_used) {
+		rv = b1_pos ? -1 : 1;
+		return rv;
+	}
+
+	for (i = bi1->bytes_used; i > 0; --i) {
+		a = bi1->bytes[i - 1];
+		b = bi2->bytes[i - 1];
+		if (a > b) {
+			rv = b1_pos ? 1 : -1;
+			return rv;
+		} else if (a < b) {
+			rv = b1_pos ? -1 : 1;
+			return rv;
+		}
+	}
+
+	return rv;
+}
+
+int ehbi_compare_l(const struct ehbigint *bi1, long i2)
+{
+	struct ehbigint bi2;
+	unsigned char bytes[sizeof(long)];
+
+	ehbi_internal_clear_null_struct(&bi2);
+
+	ehbi_init_l(&bi2, bytes, sizeof(long), i2, NULL);
+
+	return ehbi_compare(bi1, &bi2);
+}
+
+int ehbi_compare_u64(const struct ehbigint *bi1, uint64_t i2)
+{
+	struct ehbigint bi2;
+	unsigned char bytes[sizeof(uint64_t)];
+
+	ehbi_internal_clear_null_struct(&bi2);
+
+	bi2.bytes = bytes;
+	bi2.bytes_len = sizeof(uint64_t);
+	ehbi_internal_struct_u64(&bi2, i2);
+
+	return ehbi_compare(bi1, &bi2);
+}
+
+#ifdef EHBI_HAVE_U128
+int ehbi_compare_u128(const struct ehbigint *bi1, ehbi_u128 i2)
+{
+	struct ehbigint bi2;
+	unsigned char bytes[sizeof(ehbi_u128)];
+
+	ehbi_internal_clear_null_struct(&bi2);
+
+	bi2.bytes = bytes;
+	bi2.bytes_len = sizeof(ehbi_u128);
+	ehbi_internal_struct_u128(&bi2, i2);
+
+	return ehbi_compare(bi1, &bi2);
+}
+#endif
+
+#if (0)
+struct eembed_log *ehbi_log(struct eembed_log *log, const struct ehbigint *bi,
+			    int *err)
+{
+	char *buf = NULL;
+	char sbuf[80];
+	size_t size = (3 + (bi->bytes_len * 3));
+	if (size > 80) {
+		buf = (char *)eembed_malloc(size);
+	} else {
+		buf = sbuf;
+	}
+	if (buf) {
+		ehbi_to_decimal_string(bi, buf, size, &err);
+		log->append_s(log, buf);
+	} else {
+		log->append_s(log, "XXX");
+	}
+	if (size > 80) {
+		eembed_free(buf);
+	}
+	return log;
+}
+#endif
+
+int ehbi_equals(const struct ehbigint *bi1, const struct ehbigint *bi2)
+{
+	int rv = 0;
+
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+	rv = (ehbi_compare(bi1, bi2) == 0);
+
+	return rv;
+}
+
+int ehbi_equals_l(const struct ehbigint *bi1, long i2)
+{
+	struct ehbigint bi2;
+	unsigned char bytes[sizeof(long)];
+
+	ehbi_internal_clear_null_struct(&bi2);
+
+	ehbi_init_l(&bi2, bytes, sizeof(long), i2, NULL);
+
+	return ehbi_equals(bi1, &bi2);
+}
+
+int ehbi_less_than(const struct ehbigint *bi1, const struct ehbigint *bi2)
+{
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+	return (ehbi_compare(bi1, bi2) < 0);
+}
+
+int ehbi_less_than_l(const struct ehbigint *bi1, long i2)
+{
+	struct ehbigint bi2;
+	unsigned char bytes[sizeof(long)];
+
+	ehbi_internal_clear_null_struct(&bi2);
+	ehbi_init_l(&bi2, bytes, sizeof(long), i2, NULL);
+
+	return ehbi_less_than(bi1, &bi2);
+}
+
+int ehbi_greater_than(const struct ehbigint *bi1, const struct ehbigint *bi2)
+{
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+	return (ehbi_compare(bi1, bi2) > 0);
+}
+
+int ehbi_greater_than_l(const struct ehbigint *bi1, long i2)
+{
+	struct ehbigint bi2;
+	unsigned char bytes[sizeof(long)];
+
+	ehbi_internal_clear_null_struct(&bi2);
+	ehbi_init_l(&bi2, bytes, sizeof(long), i2, NULL);
+
+	return ehbi_greater_than(bi1, &bi2);
+}
+
+int ehbi_is_odd(const struct ehbigint *bi)
+{
+	unsigned char bit;
+
+	Ehbi_assert_bi(bi);
+	bit = 0x01 & bi->bytes[0];
+
+	return bit ? 1 : 0;
+}
+
+int ehbi_test_bit(const struct ehbigint *bi, size_t bit)
+{
+	size_t i;
+
+	Ehbi_assert_bi(bi);
+
+	i = bit / EEMBED_CHAR_BIT;
+	if (i >= bi->bytes_used) {
+		return 0;
+	}
+
+	return (bi->bytes[i] >> (bit % EEMBED_CHAR_BIT)) & 0x01;
+}
+
+struct ehbigint *ehbi_set_bit(struct ehbigint *bi, size_t bit, int *err)
+{
+	size_t i;
+
+	Ehbi_assert_bi(bi);
+
+	i = bit / EEMBED_CHAR_BIT;
+	if (!ehbi_reserve(bi, i + 1, err)) {
+		return NULL;
+	}
+	if (i >= bi->bytes_len) {
+		Ehbi_log_error_s_ul_s_ul_s("byte[", bi->bytes_len,
+					   "] too small for bit (", bit, ")");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		return NULL;
+	}
+
+	if (i >= bi->bytes_used) {
+		eembed_memset(bi->bytes + bi->bytes_used, 0x00,
+			      1 + i - bi->bytes_used);
+		bi->bytes_used = i + 1;
+	}
+	bi->bytes[i] |= (unsigned char)(1 << (bit % EEMBED_CHAR_BIT));
+	Ehbi_assert_normal(bi);
+
+	return bi;
+}
+
+struct ehbigint *ehbi_clear_bit(struct ehbigint *bi, size_t bit)
+{
+	size_t i;
+
+	Ehbi_assert_bi(bi);
+
+	i = bit / EEMBED_CHAR_BIT;
+	if (i >= bi->bytes_used) {
+		return bi;
+	}
+
+	bi->bytes[i] &= (unsigned char)~(1 << (bit % EEMBED_CHAR_BIT));
+	if (i == bi->bytes_used - 1) {
+		/* only clearing the top byte can expose leading zeros */
+		while (bi->bytes_used > 1
+		       && bi->bytes[bi->bytes_used - 1] == 0x00) {
+			--(bi->bytes_used);
+		}
+		if (ehbi_is_zero(bi)) {
+			ehbi_sign_set(bi, 0);
+		}
+	}
+	Ehbi_assert_normal(bi);
+
+	return bi;
+}
+
+size_t ehbi_popcount(const struct ehbigint *bi)
+{
+	size_t i, bits;
+
+	Ehbi_assert_bi(bi);
+
+	bits = 0;
+	for (i = 0; i < bi->bytes_used; ++i) {
+		bits += ehbi_popcount8(bi->bytes[i]);
+	}
+
+	return bits;
+}
+
+enum ehbi_bit_op {
+	ehbi_bit_and,
+	ehbi_bit_or,
+	ehbi_bit_xor,
+	ehbi_bit_andnot,
+	ehbi_bit_not
+};
+
+static unsigned char ehbi_bit_op_byte(enum ehbi_bit_op op, unsigned char a,
+				      unsigned char b)
+{
+	switch (op) {
+	case ehbi_bit_and:
+		return a & b;
+	case ehbi_bit_or:
+		return a | b;
+	case ehbi_bit_xor:
+		return a ^ b;
+	case ehbi_bit_andnot:
+		return a & (unsigned char)~b;
+	case ehbi_bit_not:
+	default:
+		return (unsigned char)~a;
+	}
+}
+
+/*
+   with both values non-negative, each byte of the result depends only on
+   the same bytes of the operands, and these simple loops over contiguous
+   bytes are left for the compiler to vectorize
+*/
+static void ehbi_bitwise_positive(struct ehbigint *res,
+				  const struct ehbigint *bi1,
+				  const struct ehbigint *bi2,
+				  enum ehbi_bit_op op, size_t len)
+{
+	size_t i, shorter;
+	const struct ehbigint *longer;
+	unsigned char *r;
+	const unsigned char *b1, *b2;
+
+	/* locals, so that the stores can not be seen to change the pointers */
+	r = res->bytes;
+	b1 = bi1->bytes;
+	b2 = bi2->bytes;
+	shorter = bi1->bytes_used < bi2->bytes_used
+	    ? bi1->bytes_used : bi2->bytes_used;
+	longer = (op == ehbi_bit_andnot || bi1->bytes_used > bi2->bytes_used)
+	    ? bi1 : bi2;
+
+	switch (op) {
+	case ehbi_bit_and:
+		for (i = 0; i < shorter; ++i) {
+			r[i] = b1[i] & b2[i];
+		}
+		break;
+	case ehbi_bit_or:
+		for (i = 0; i < shorter; ++i) {
+			r[i] = b1[i] | b2[i];
+		}
+		break;
+	case ehbi_bit_xor:
+		for (i = 0; i < shorter; ++i) {
+			r[i] = b1[i] ^ b2[i];
+		}
+		break;
+	case ehbi_bit_andnot:
+	case ehbi_bit_not:
+	default:
+		for (i = 0; i < shorter; ++i) {
+			r[i] = b1[i] & (unsigned char)~b2[i];
+		}
+		break;
+	}
+	if (len > shorter && res->bytes != longer->bytes) {
+		eembed_memmove(res->bytes + shorter, longer->bytes + shorter,
+			       len - shorter);
+	}
+
+	res->bytes_used = len;
+	while (res->bytes_used > 1 && res->bytes[res->bytes_used - 1] == 0x00) {
+		--(res->bytes_used);
+	}
+	ehbi_sign_set(res, 0);
+}
+
+/*
+   negative values act as if stored in an infinitely sign-extended two's
+   complement, as mpz does: the bytes of ~(|x| - 1) followed by 0xFF bytes;
+   each operand is converted a byte at a time with a running borrow, and a
+   negative result is converted back to a magnitude with a running carry;
+   every byte is read before the same byte of the result is written, thus
+   the result may be the same as either operand, but must not overlap one
+   at an offset, see ehbi_bitwise_x
+*/
+static struct ehbigint *ehbi_bitwise(struct ehbigint *res,
+				     const struct ehbigint *bi1,
+				     const struct ehbigint *bi2,
+				     enum ehbi_bit_op op, int *err)
+{
+	size_t i, len, used1, used2, top;
+	unsigned neg1, neg2, neg, borrow1, borrow2, carry;
+	unsigned char b1, b2, r;
+
+	Ehbi_assert_bi(res);
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+
+	used1 = bi1->bytes_used;
+	used2 = bi2->bytes_used;
+	neg1 = ehbi_is_negative(bi1) ? 1 : 0;
+	neg2 = ehbi_is_negative(bi2) ? 1 : 0;
+
+	if (!neg1 && !neg2 && op != ehbi_bit_not) {
+		if (op == ehbi_bit_and) {
+			len = used1 < used2 ? used1 : used2;
+		} else if (op == ehbi_bit_andnot) {
+			len = used1;
+		} else {
+			len = used1 > used2 ? used1 : used2;
+		}
+		if (!ehbi_reserve(res, len, err)) {
+			goto ehbi_bitwise_error;
+		}
+		if (len <= res->bytes_len) {
+			ehbi_bitwise_positive(res, bi1, bi2, op, len);
+			Ehbi_assert_normal(res);
+			return res;
+		}
+	}
+
+	/* the sign of the result is the op applied to the sign extensions */
+	neg = ehbi_bit_op_byte(op, neg1 ? 0xFF : 0x00, neg2 ? 0xFF : 0x00)
+	    ? 1 : 0;
+	len = (used1 > used2 ? used1 : used2) + neg;
+	if (!ehbi_reserve(res, len, err)) {
+		goto ehbi_bitwise_error;
+	}
+
+	borrow1 = neg1;
+	borrow2 = neg2;
+	carry = neg;
+	top = 0;
+	for (i = 0; i < len; ++i) {
+		b1 = (i < used1) ? bi1->bytes[i] : 0x00;
+		if (neg1) {
+			r = (unsigned char)(b1 - borrow1);
+			borrow1 = (b1 < borrow1) ? 1 : 0;
+			b1 = (unsigned char)~r;
+		}
+		b2 = (i < used2) ? bi2->bytes[i] : 0x00;
+		if (neg2) {
+			r = (unsigned char)(b2 - borrow2);
+			borrow2 = (b2 < borrow2) ? 1 : 0;
+			b2 = (unsigned char)~r;
+		}
+
+		r = ehbi_bit_op_byte(op, b1, b2);
+		if (neg) {
+			r = (unsigned char)~r;
+			r = (unsigned char)(r + carry);
+			carry = (carry && r == 0x00) ? 1 : 0;
+		}
+
+		if (r) {
+			if (i >= res->bytes_len) {
+				Ehbi_log_error_s_ul_s_ul_s("Result byte[",
+							   res->bytes_len,
+							   "] too small (",
+							   i + 1, ")");
+				ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+				goto ehbi_bitwise_error;
+			}
+			top = i + 1;
+		}
+		if (i < res->bytes_len) {
+			res->bytes[i] = r;
+		}
+	}
+
+	/* a negative result has a non-zero magnitude */
+	res->bytes_used = top ? top : 1;
+	ehbi_sign_set(res, top ? neg : 0);
+	Ehbi_assert_normal(res);
+
+	return res;
+
+ehbi_bitwise_error:
+	ehbi_zero(res);
+	return NULL;
+}
+
+/* as ehbi_bitwise, but an operand overlapping res is copied first */
+static struct ehbigint *ehbi_bitwise_x(struct ehbigint *res,
+				       const struct ehbigint *bi1,
+				       const struct ehbigint *bi2,
+				       enum ehbi_bit_op op,
+				       struct ehbi_scratch *s, int *err)
+{
+	struct ehbigint tmp1, tmp2;
+	struct ehbigint *rp;
+	const struct ehbigint *op1, *op2;
+	unsigned char bytes1[Ehbi_bi_buf_size];
+	unsigned char bytes2[Ehbi_bi_buf_size];
+
+	ehbi_internal_clear_null_struct(&tmp1);
+	ehbi_internal_clear_null_struct(&tmp2);
+
+	Ehbi_assert_bi(res);
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
+
+	rp = NULL;
+	op1 = ehbi_unalias(s, res, bi1, &tmp1, bytes1, Ehbi_bi_buf_size, err);
+	if (!op1) {
+		goto ehbi_bitwise_x_end;
+	}
+	op2 = (bi2 == bi1) ? op1 : ehbi_unalias(s, res, bi2, &tmp2, bytes2,
+						  Ehbi_bi_buf_size, err);
+	if (!op2) {
+		goto ehbi_bitwise_x_end;
+	}
+	rp = ehbi_bitwise(res, op1, op2, op, err);
+
+ehbi_bitwise_x_end:
+	ehbi_set_or_malloc_free(s, &tmp2);
+	ehbi_set_or_malloc_free(s, &tmp1);
+	if (!rp) {
+		ehbi_zero(res);
+	}
+	return rp;
+}
+
+struct ehbigint *ehbi_and(struct ehbigint *res, const struct ehbigint *bi1,
+			  const struct ehbigint *bi2, int *err)
+{
+	return ehbi_bitwise_x(res, bi1, bi2, ehbi_bit_and, NULL, err);
+}
+
+struct ehbigint *ehbi_or(struct ehbigint *res, const struct ehbigint *bi1,
+			 const struct ehbigint *bi2, int *err)
+{
+	return ehbi_bitwise_x(res, bi1, bi2, ehbi_bit_or, NULL, err);
+}
+
+struct ehbigint *ehbi_xor(struct ehbigint *res, const struct ehbigint *bi1,
+			  const struct ehbigint *bi2, int *err)
+{
+	return ehbi_bitwise_x(res, bi1, bi2, ehbi_bit_xor, NULL, err);
+}
+
+struct ehbigint *ehbi_andnot(struct ehbigint *res, const struct ehbigint *bi1,
+			     const struct ehbigint *bi2, int *err)
+{
+	return ehbi_bitwise_x(res, bi1, bi2, ehbi_bit_andnot, NULL, err);
+}
+
+struct ehbigint *ehbi_not(struct ehbigint *res, const struct ehbigint *bi,
+			  int *err)
+{
+	return ehbi_bitwise_x(res, bi, bi, ehbi_bit_not, NULL, err);
+}
+
+/* the struct and its bytes are allocated as a single block */
+struct ehbigint *ehbi_alloc_l(size_t bytes_len, long val, int *err)
+{
+	struct ehbigint *bi = NULL;
+	struct eembed_allocator *ea = eembed_global_allocator;
+	struct ehbigint *rp = NULL;
+	size_t size = 0;
+
+	size = sizeof(struct ehbigint) + bytes_len;
+	bi = (struct ehbigint *)ea->calloc(ea, 1, size);
+	if (!bi) {
+		Ehbi_log_error_s_ul_s("could not allocate ", size, " bytes?");
+		ehbi_set_error(err, EHBI_NULL_STRUCT);
+		return NULL;
+	}
+
+	rp = ehbi_init_l(bi, (unsigned char *)(bi + 1), bytes_len, val, err);
+	if (!rp) {
+		Ehbi_log_error0("error from ehbi_init?");
+		ehbi_free(bi);
+		return NULL;
+	}
+
+	return bi;
+}
+
+struct ehbigint *ehbi_alloc(size_t bytes_len, int *err)
+{
+	return ehbi_alloc_l(bytes_len, 0, err);
+}
+
+void ehbi_free(struct ehbigint *bi)
+{
+	struct eembed_allocator *ea = eembed_global_allocator;
+	if (bi) {
+		/* bytes which outgrew the block were allocated on their own */
+		if (ehbi_flag(bi, ehbi_flag_heap)) {
+			ea->free(ea, bi->bytes);
+		}
+		ea->free(ea, bi);
+	}
+}
+
+#ifndef EHBI_SKIP_POOL
+/*
+   each pooled block is preceded by a header which records the capacity,
+   and which links the block into a free list while it is cached;
+   the union keeps the memory after the header suitably aligned
+*/
+union ehbi_pool_header {
+	struct {
+		size_t capacity;
+		union ehbi_pool_header *next;
+	} h;
+	double align_d;
+	long align_l;
+	void *align_p;
+};
+
+struct ehbi_pool_thread {
+	union ehbi_pool_header *free_list[EHBI_POOL_NUM_CLASSES];
+	size_t free_count[EHBI_POOL_NUM_CLASSES];
+	struct ehbi_pool_stats stats;
+};
+
+static EHBI_THREAD_LOCAL struct ehbi_pool_thread ehbi_pool_thread;
+
+static struct eembed_allocator ehbi_pool_ea;
+
+/* returns EHBI_POOL_NUM_CLASSES if the size is too big to be pooled */
+static size_t ehbi_pool_class(size_t size, size_t *capacity)
+{
+	size_t cls, cap;
+
+	cap = ((size_t)1) << EHBI_POOL_MIN_CLASS_BITS;
+	for (cls = 0; cls < EHBI_POOL_NUM_CLASSES; ++cls) {
+		if (size <= cap) {
+			*capacity = cap;
+			return cls;
+		}
+		cap = cap << 1;
+	}
+	*capacity = size;
+	return EHBI_POOL_NUM_CLASSES;
+}
+
+static void *ehbi_pool_malloc(struct eembed_allocator *ea, size_t size)
+{
+	struct eembed_allocator *backing;
+	struct ehbi_pool_thread *t = &ehbi_pool_thread;
+	union ehbi_pool_header *block;
+	size_t cls, capacity;
+
+	cls = ehbi_pool_class(size, &capacity);
+	if (cls < EHBI_POOL_NUM_CLASSES && t->free_list[cls]) {
+		block = t->free_list[cls];
+		t->free_list[cls] = block->h.next;
+		--(t->free_count[cls]);
+		++(t->stats.hits);
+		t->stats.bytes_cached -= capacity;
+		return block + 1;
+	}
+
+	++(t->stats.misses);
+	if (capacity > ((size_t)-1) - sizeof(union ehbi_pool_header)) {
+		return NULL;
+	}
+	backing = (struct eembed_allocator *)ea->context;
+	block = (union ehbi_pool_header *)
+	    backing->malloc(backing, sizeof(union ehbi_pool_header) + capacity);
+	if (!block) {
+		return NULL;
+	}
+	block->h.capacity = capacity;
+	block->h.next = NULL;
+	return block + 1;
+}
+
+static void ehbi_pool_free(struct eembed_allocator *ea, void *ptr)
+{
+	struct eembed_allocator *backing;
+	struct ehbi_pool_thread *t = &ehbi_pool_thread;
+	union ehbi_pool_header *block;
+	size_t cls, capacity;
+
+	if (!ptr) {
+		return;
+	}
+	block = ((union ehbi_pool_header *)ptr) - 1;
+
+	cls = ehbi_pool_class(block->h.capacity, &capacity);
+	if (cls < EHBI_POOL_NUM_CLASSES
+	    && t->free_count[cls] < EHBI_POOL_MAX_CACHED) {
+		block->h.next = t->free_list[cls];
+		t->free_list[cls] = block;
+		++(t->free_count[cls]);
+		t->stats.bytes_cached += capacity;
+		return;
+	}
+
+	backing = (struct eembed_allocator *)ea->context;
+	backing->free(backing, block);
+}
+
+static void *ehbi_pool_calloc(struct eembed_allocator *ea, size_t nmemb,
+			      size_t size)
+{
+	void *ptr;
+
+	if (size && nmemb > ((size_t)-1) / size) {
+		return NULL;
 	}
+	ptr = ehbi_pool_malloc(ea, nmemb * size);
+	if (ptr) {
+		eembed_memset(ptr, 0x00, nmemb * size);
+	}
+	return ptr;
+}
 
-	/* we will set max_witness at n-2 */
-	rp = ehbi_set(&max_witness, bi, err);
-	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+static void *ehbi_pool_realloc(struct eembed_allocator *ea, void *ptr,
+			       size_t size)
+{
+	union ehbi_pool_header *block;
+	void *new_ptr;
+
+	if (!ptr) {
+		return ehbi_pool_malloc(ea, size);
 	}
-	rp = ehbi_dec_l(&max_witness, 2, err);
-	if (!rp) {
-		goto ehbi_is_probably_prime_end;
+	block = ((union ehbi_pool_header *)ptr) - 1;
+	if (size <= block->h.capacity) {
+		return ptr;
 	}
 
-	if (accuracy == 0) {
-		k = EHBI_DEFAULT_TRIALS_FOR_IS_PROBABLY_PRIME;
-	} else if (accuracy < EHBI_MIN_TRIALS_FOR_IS_PROBABLY_PRIME) {
-		k = EHBI_MIN_TRIALS_FOR_IS_PROBABLY_PRIME;
-	} else {
-		k = accuracy;
+	new_ptr = ehbi_pool_malloc(ea, size);
+	if (!new_ptr) {
+		return NULL;
 	}
+	eembed_memcpy(new_ptr, ptr, block->h.capacity);
+	ehbi_pool_free(ea, ptr);
 
-	/*
-	   WitnessLoop: repeat k times:
-	 */
-	for (i = 0; i < k; ++i) {
-		rp = ehbi_get_witness(i, &a, &max_witness, err);
-		if (!rp) {
-			goto ehbi_is_probably_prime_end;
-		}
+	return new_ptr;
+}
 
-		/* still too big, we are done */
-		if (ehbi_greater_than(&a, &max_witness)) {
-			is_probably_prime = 1;
-			goto ehbi_is_probably_prime_end;
-		}
+struct eembed_allocator *ehbi_pool_allocator(void)
+{
+	struct eembed_allocator *backing = eembed_global_allocator;
 
-		/* x := a^d mod n */
-		rp = ehbi_exp_mod(&x, &a, &d, bi, err);
-		if (!rp) {
-			goto ehbi_is_probably_prime_end;
-		}
+	if (backing == &ehbi_pool_ea) {
+		return &ehbi_pool_ea;
+	}
 
-		/* if x == 1 or x == n-1 then continue WitnessLoop */
-		if (ehbi_equals_l(&x, 1)) {
-			continue;
-		}
-		if (ehbi_equals(&x, &bimin1)) {
-			continue;
+	/* copy first, in case the interface has members not handled here */
+	ehbi_pool_ea = *backing;
+	ehbi_pool_ea.context = backing;
+	ehbi_pool_ea.malloc = ehbi_pool_malloc;
+	ehbi_pool_ea.calloc = ehbi_pool_calloc;
+	ehbi_pool_ea.realloc = ehbi_pool_realloc;
+	ehbi_pool_ea.free = ehbi_pool_free;
+
+	return &ehbi_pool_ea;
+}
+
+void ehbi_pool_release(void)
+{
+	struct eembed_allocator *backing;
+	struct ehbi_pool_thread *t = &ehbi_pool_thread;
+	union ehbi_pool_header *block;
+	size_t cls;
+
+	backing = (struct eembed_allocator *)ehbi_pool_ea.context;
+	for (cls = 0; cls < EHBI_POOL_NUM_CLASSES; ++cls) {
+		while (t->free_list[cls]) {
+			block = t->free_list[cls];
+			t->free_list[cls] = block->h.next;
+			backing->free(backing, block);
 		}
+		t->free_count[cls] = 0;
+	}
+	t->stats.bytes_cached = 0;
+}
 
-		/* repeat r-1 times: */
-		stop = 0;
-		for (c = r - 1; !stop && c > 0; --c) {
-			/* x := x^2 mod n */
-			rp = ehbi_set(&y, &x, err);
-			if (!rp) {
-				goto ehbi_is_probably_prime_end;
-			} else {
-				struct ehbigint exp;
-				unsigned char exp_bytes[sizeof(unsigned long)];
+struct ehbi_pool_stats *ehbi_pool_stats(struct ehbi_pool_stats *stats)
+{
+	eembed_assert(stats);
 
-				ehbi_internal_clear_null_struct(&exp);
-				exp.bytes = exp_bytes;
-				exp.bytes_len = sizeof(unsigned long);
+	*stats = ehbi_pool_thread.stats;
 
-				ehbi_internal_struct_l(&exp, 2);
+	return stats;
+}
+#endif /* EHBI_SKIP_POOL */
 
-				rp = ehbi_exp_mod(&x, &y, &exp, bi, err);
-				if (!rp) {
-					goto ehbi_is_probably_prime_end;
-				}
-			}
+struct ehbi_scratch *ehbi_scratch_init(struct ehbi_scratch *s,
+				       unsigned char *bytes, size_t len)
+{
+	eembed_assert(s);
 
-			/* if x == 1 then return composite */
-			if (ehbi_equals_l(&x, 1)) {
-				is_probably_prime = 0;
-				goto ehbi_is_probably_prime_end;
-			}
+	s->bytes = bytes;
+	s->bytes_len = bytes ? len : 0;
+	s->bytes_used = 0;
+	s->bytes_spilled = 0;
+	s->bytes_peak = 0;
 
-			/* if x == n-1 then continue WitnessLoop */
-			if (ehbi_equals(&x, &bimin1)) {
-				stop = 1;
-				break;
-			}
-		}
-		if (!stop) {
-			is_probably_prime = 0;
-			goto ehbi_is_probably_prime_end;
-		}
+	return s;
+}
+
+struct ehbi_scratch *ehbi_scratch_alloc(size_t len, int *err)
+{
+	struct ehbi_scratch *s = NULL;
+	struct eembed_allocator *ea = eembed_global_allocator;
+	size_t size = 0;
+
+	size = sizeof(struct ehbi_scratch) + len;
+	s = (struct ehbi_scratch *)ea->calloc(ea, 1, size);
+	if (!s) {
+		Ehbi_log_error_s_ul_s("could not allocate ", size, " bytes?");
+		ehbi_set_error(err, EHBI_NOMEM);
+		return NULL;
 	}
 
-	/* return probably prime */
-	is_probably_prime = 1;
+	return ehbi_scratch_init(s, (unsigned char *)(s + 1), len);
+}
 
-ehbi_is_probably_prime_end:
-	if (!rp) {
-		Ehbi_log_error_s_l_s("error ", *err,
-				     ", setting is_probably_prime = 0");
-		is_probably_prime = 0;
+void ehbi_scratch_free(struct ehbi_scratch *s)
+{
+	struct eembed_allocator *ea = eembed_global_allocator;
+	if (s) {
+		ea->free(ea, s);
 	}
+}
 
-	ehbi_set_or_malloc_free(&y, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&x, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&d, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&a, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&max_witness, Ehbi_bi_buf_size);
-	ehbi_set_or_malloc_free(&bimin1, Ehbi_bi_buf_size);
+void ehbi_scratch_reset(struct ehbi_scratch *s)
+{
+	eembed_assert(s);
 
-	return is_probably_prime;
+	s->bytes_used = 0;
+	s->bytes_spilled = 0;
+	s->bytes_peak = 0;
 }
 
-#endif /* EHBI_SKIP_IS_PROBABLY_PRIME */
+size_t ehbi_scratch_peak(const struct ehbi_scratch *s)
+{
+	return s ? s->bytes_peak : 0;
+}
 
-struct ehbigint *ehbi_negate(struct ehbigint *bi)
+static size_t ehbi_bits_to_bytes(size_t bits)
 {
-	Ehbi_assert_bi(bi);
+	size_t bytes;
 
-	ehbi_sign_set(bi, (ehbi_sign(bi) == 0) ? 1 : 0);
+	bytes = (bits / EEMBED_CHAR_BIT) + ((bits % EEMBED_CHAR_BIT) ? 1 : 0);
 
-	return bi;
+	return bytes ? bytes : 1;
 }
 
-int ehbi_is_negative(const struct ehbigint *bi)
+/*
+   an upper bound of 256 * log2(bi) for bi > 1, from the top 16 bits:
+   the bits of the fraction are found by repeated squaring, rounding up
+*/
+static size_t ehbi_log2_256_upper(const struct ehbigint *bi)
 {
-	Ehbi_assert_bi(bi);
-	if (ehbi_is_zero(bi)) {
-		eembed_assert(ehbi_sign(bi) == 0);
+	size_t bits, top, top_bits, i, frac;
+	uint64_t y;
+	int truncated;
+
+	bits = ehbi_bit_length(bi);
+
+	/* y is the top 16 bits, rounded up, as a fraction in [2^15, 2^16] */
+	top = (bi->bytes_used < 3) ? bi->bytes_used : 3;
+	y = 0;
+	for (i = 1; i <= top; ++i) {
+		y = (y << EEMBED_CHAR_BIT) | bi->bytes[bi->bytes_used - i];
+	}
+	truncated = (bi->bytes_used > top);
+	top_bits = bits - (EEMBED_CHAR_BIT * (bi->bytes_used - top));
+	if (top_bits > 16) {
+		if (y & ((((uint64_t)1) << (top_bits - 16)) - 1)) {
+			truncated = 1;
+		}
+		y = y >> (top_bits - 16);
+	} else {
+		y = y << (16 - top_bits);
+	}
+	if (truncated) {
+		y += 1;
 	}
 
-	return (ehbi_sign(bi) == 0) ? 0 : 1;
+	frac = 0;
+	for (i = 0; i < 8; ++i) {
+		y = ((y * y) + (((uint64_t)1) << 15) - 1) >> 15;
+		frac = frac << 1;
+		if (y >= (((uint64_t)1) << 16)) {
+			frac |= 1;
+			y = (y + 1) >> 1;
+		}
+	}
+
+	return (256 * (bits - 1)) + frac + 1;
 }
 
-int ehbi_compare(const struct ehbigint *bi1, const struct ehbigint *bi2)
+size_t ehbi_add_size(const struct ehbigint *bi1, const struct ehbigint *bi2)
 {
-	size_t i;
-	unsigned char a, b;
-	int rv, b1_pos, b2_pos;
-
-	rv = 0;
+	size_t bits1, bits2;
 
 	Ehbi_assert_bi(bi1);
 	Ehbi_assert_bi(bi2);
-	b1_pos = !ehbi_is_negative(bi1);
-	b2_pos = !ehbi_is_negative(bi2);
 
-	if (b1_pos != b2_pos) {
-		rv = b1_pos ? 1 : -1;
-		return rv;
-	}
+	bits1 = ehbi_bit_length(bi1);
+	bits2 = ehbi_bit_length(bi2);
 
-	if (bi1->bytes_used > bi2->bytes_used) {
-		rv = b1_pos ? 1 : -1;
-		return rv;
-	} else if (bi1->bytes_used < bi2->bytes_used) {
-		rv = b1_pos ? -1 : 1;
-		return rv;
-	}
+	/* the carry adds at most one bit */
+	return ehbi_bits_to_bytes(1 + ((bits1 > bits2) ? bits1 : bits2));
+}
 
-	for (i = 0; i < bi1->bytes_used; ++i) {
-		a = bi1->bytes[(bi1->bytes_len - bi1->bytes_used) + i];
-		b = bi2->bytes[(bi2->bytes_len - bi2->bytes_used) + i];
-		if (a > b) {
-			rv = b1_pos ? 1 : -1;
-			return rv;
-		} else if (a < b) {
-			rv = b1_pos ? -1 : 1;
-			return rv;
-		}
-	}
+size_t ehbi_mul_size(const struct ehbigint *bi1, const struct ehbigint *bi2)
+{
+	Ehbi_assert_bi(bi1);
+	Ehbi_assert_bi(bi2);
 
-	return rv;
+	return ehbi_bits_to_bytes(ehbi_bit_length(bi1) + ehbi_bit_length(bi2));
 }
 
-int ehbi_compare_l(const struct ehbigint *bi1, long i2)
+/* the bytes for a product of "terms" factors, none larger than bi */
+static size_t ehbi_power_size(const struct ehbigint *bi, uint64_t terms,
+			      int *err)
 {
-	struct ehbigint bi2;
-	unsigned char bytes[sizeof(long)];
+	size_t log2_256;
 
-	ehbi_internal_clear_null_struct(&bi2);
+	/* zero and one to any power fit in a byte, as does anything to 0 */
+	if (ehbi_bit_length(bi) <= 1 || terms == 0) {
+		return 1;
+	}
 
-	ehbi_init_l(&bi2, bytes, sizeof(long), i2, NULL);
+	/* bit_length(bi^terms) <= (terms * log2(bi)) + 1 */
+	log2_256 = ehbi_log2_256_upper(bi);
+	if (terms > (((size_t)-1) - 255) / log2_256) {
+		Ehbi_log_error_s_ul_s("power ", (unsigned long)terms,
+				      " too large");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
+	}
 
-	return ehbi_compare(bi1, &bi2);
+	return ehbi_bits_to_bytes(((((size_t)terms) * log2_256) + 255) / 256
+				  + 1);
 }
 
-#if (0)
-struct eembed_log *ehbi_log(struct eembed_log *log, const struct ehbigint *bi,
-			    int *err)
+size_t ehbi_exp_size(const struct ehbigint *base,
+		     const struct ehbigint *exponent, int *err)
 {
-	char *buf = NULL;
-	char sbuf[80];
-	size_t size = (3 + (bi->bytes_len * 3));
-	if (size > 80) {
-		buf = (char *)eembed_malloc(size);
-	} else {
-		buf = sbuf;
+	Ehbi_assert_bi(base);
+	Ehbi_assert_bi(exponent);
+
+	if (ehbi_is_negative(exponent)) {
+		Ehbi_log_error0("negative exponent");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
 	}
-	if (buf) {
-		ehbi_to_decimal_string(bi, buf, size, &err);
-		log->append_s(log, buf);
-	} else {
-		log->append_s(log, "XXX");
+	if (ehbi_bit_length(base) <= 1) {
+		return 1;
 	}
-	if (size > 80) {
-		eembed_free(buf);
+	if (!ehbi_fits_u64(exponent)) {
+		Ehbi_log_error0("exponent too large");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
 	}
-	return log;
+
+	return ehbi_power_size(base, ehbi_get_u64(exponent, err), err);
 }
-#endif
 
-int ehbi_equals(const struct ehbigint *bi1, const struct ehbigint *bi2)
+size_t ehbi_exp_size_l(const struct ehbigint *base, long exponent, int *err)
 {
-	int rv = 0;
+	Ehbi_assert_bi(base);
 
-	Ehbi_assert_bi(bi1);
-	Ehbi_assert_bi(bi2);
-	rv = (ehbi_compare(bi1, bi2) == 0);
+	if (exponent < 0) {
+		Ehbi_log_error_s_l_s("negative exponent (", exponent, ")");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
+	}
 
-	return rv;
+	return ehbi_power_size(base, (uint64_t)exponent, err);
 }
 
-int ehbi_equals_l(const struct ehbigint *bi1, long i2)
+size_t ehbi_n_choose_k_size_bound(const struct ehbigint *n,
+				  const struct ehbigint *k, int *err)
 {
-	struct ehbigint bi2;
-	unsigned char bytes[sizeof(long)];
+	uint64_t terms, n_min_k;
 
-	ehbi_internal_clear_null_struct(&bi2);
+	Ehbi_assert_bi(n);
+	Ehbi_assert_bi(k);
 
-	ehbi_init_l(&bi2, bytes, sizeof(long), i2, NULL);
+	if (ehbi_is_negative(k) || ehbi_greater_than(k, n)) {
+		return 1;
+	}
+	if (!ehbi_fits_u64(n)) {
+		Ehbi_log_error0("n too large");
+		ehbi_set_error(err, EHBI_BAD_DATA);
+		return 0;
+	}
 
-	return ehbi_equals(bi1, &bi2);
+	/* by symmetry there are min(k, n - k) terms in the running product
+	   n(n-1)...(n-k+1), none larger than n */
+	terms = ehbi_get_u64(k, err);
+	n_min_k = ehbi_get_u64(n, err) - terms;
+	if (n_min_k < terms) {
+		terms = n_min_k;
+	}
+	if (terms <= 1) {
+		return n->bytes_used ? n->bytes_used : 1;
+	}
+
+	return ehbi_power_size(n, terms, err);
 }
 
-int ehbi_less_than(const struct ehbigint *bi1, const struct ehbigint *bi2)
+size_t ehbi_binary_string_len(const struct ehbigint *bi)
 {
-	Ehbi_assert_bi(bi1);
-	Ehbi_assert_bi(bi2);
-	return (ehbi_compare(bi1, bi2) < 0);
+	Ehbi_assert_bi(bi);
+
+	/* "0b" + digits + NULL */
+	return (EEMBED_CHAR_BIT * bi->bytes_used) + 3;
 }
 
-int ehbi_less_than_l(const struct ehbigint *bi1, long i2)
+size_t ehbi_hex_string_len(const struct ehbigint *bi)
 {
-	struct ehbigint bi2;
-	unsigned char bytes[sizeof(long)];
+	Ehbi_assert_bi(bi);
 
-	ehbi_internal_clear_null_struct(&bi2);
-	ehbi_init_l(&bi2, bytes, sizeof(long), i2, NULL);
+	/* "0x" + digits + NULL */
+	return (2 * bi->bytes_used) + 3;
+}
 
-	return ehbi_less_than(bi1, &bi2);
+size_t ehbi_decimal_string_len(const struct ehbigint *bi)
+{
+	size_t digits;
+
+	Ehbi_assert_bi(bi);
+
+	/* log10(2) < 1234/4096 */
+	digits = ((ehbi_bit_length(bi) * 1234) / 4096) + 1;
+
+	/* sign + digits + NULL */
+	return 1 + digits + 1;
 }
 
-int ehbi_greater_than(const struct ehbigint *bi1, const struct ehbigint *bi2)
+size_t ehbi_string_radix_len(const struct ehbigint *bi, unsigned radix)
 {
-	Ehbi_assert_bi(bi1);
-	Ehbi_assert_bi(bi2);
-	return (ehbi_compare(bi1, bi2) > 0);
+	size_t digits, bits;
+
+	Ehbi_assert_bi(bi);
+
+	if (radix < 2 || radix > 62) {
+		return 0;
+	}
+
+	/* each digit holds at least floor(log2(radix)) bits */
+	bits = ehbi_msb8((unsigned char)radix) - 1;
+	digits = (ehbi_bit_length(bi) + bits - 1) / bits;
+	if (digits == 0) {
+		digits = 1;
+	}
+
+	/* sign + digits + NULL */
+	return 1 + digits + 1;
+}
+
+size_t ehbi_from_binary_size(size_t str_len)
+{
+	return ehbi_bits_to_bytes(str_len);
 }
 
-int ehbi_greater_than_l(const struct ehbigint *bi1, long i2)
+size_t ehbi_from_hex_size(size_t str_len)
 {
-	struct ehbigint bi2;
-	unsigned char bytes[sizeof(long)];
+	size_t bytes;
 
-	ehbi_internal_clear_null_struct(&bi2);
-	ehbi_init_l(&bi2, bytes, sizeof(long), i2, NULL);
+	bytes = (str_len / 2) + (str_len % 2);
 
-	return ehbi_greater_than(bi1, &bi2);
+	return bytes ? bytes : 1;
 }
 
-int ehbi_is_odd(const struct ehbigint *bi)
+size_t ehbi_from_decimal_size(size_t str_len)
 {
-	unsigned char bit;
+	size_t bits;
 
-	Ehbi_assert_bi(bi);
-	bit = 0x01 & bi->bytes[bi->bytes_len - 1];
+	/* log2(10) < 3402/1024 */
+	bits = ((str_len / 1024) * 3402) + ((((str_len % 1024) * 3402)
+					     + 1023) / 1024);
 
-	return bit ? 1 : 0;
+	return ehbi_bits_to_bytes(bits);
 }
 
-struct ehbigint *ehbi_alloc_l(size_t bytes_len, long val, int *err)
+/*
+   eight characters are handled at a time as a word, loaded with the first
+   character in the low byte whatever the byte order of the machine: each
+   byte of a binary digit is 0x30 or 0x31, and a multiply gathers the low
+   bits of the eight bytes into one, the first character the high bit
+*/
+static uint64_t ehbi_load8(const char *str)
 {
-	struct ehbigint *bi = NULL;
-	unsigned char *bytes = NULL;
-	struct eembed_allocator *ea = eembed_global_allocator;
-	struct ehbigint *rp = NULL;
-	size_t size = 0;
+	size_t i;
+	uint64_t word;
 
-	size = sizeof(struct ehbigint);
-	bi = (struct ehbigint *)ea->calloc(ea, 1, size);
-	if (!bi) {
-		Ehbi_log_error_s_ul_s("could not allocate ", size, " bytes?");
-		ehbi_set_error(err, EHBI_NULL_STRUCT);
-		goto ehbi_alloc_l_end;
+	word = 0;
+	for (i = EEMBED_CHAR_BIT; i > 0; --i) {
+		word = (word << EEMBED_CHAR_BIT) | (unsigned char)str[i - 1];
 	}
+	return word;
+}
 
-	size = bytes_len;
-	bytes = (unsigned char *)ea->calloc(ea, 1, size);
-	if (!bytes) {
-		Ehbi_log_error_s_ul_s("could not allocate ", size, " bytes?");
-		ehbi_set_error(err, EHBI_NULL_BYTES);
-		goto ehbi_alloc_l_end;
-	}
+static void ehbi_store8(char *buf, uint64_t word)
+{
+	size_t i;
 
-	rp = ehbi_init_l(bi, bytes, bytes_len, val, err);
-	if (!rp) {
-		Ehbi_log_error_s_l_s("error ", *err, " from ehbi_init?");
-		goto ehbi_alloc_l_end;
+	for (i = 0; i < EEMBED_CHAR_BIT; ++i) {
+		buf[i] = (char)(unsigned char)(word >> (i * EEMBED_CHAR_BIT));
 	}
+}
 
-ehbi_alloc_l_end:
-	if (!rp) {
-		ehbi_free(bi);
-		return NULL;
-	}
+/* 0x0101010101010101, a one in each byte */
+#define Ehbi_swar_ones ((((uint64_t)0x01010101UL) << 32) | 0x01010101UL)
 
-	return bi;
-}
+/* 0x8040201008040201, byte k is (1 << k) */
+#define Ehbi_swar_gather ((((uint64_t)0x80402010UL) << 32) | 0x08040201UL)
 
-struct ehbigint *ehbi_alloc(size_t bytes_len, int *err)
+static int ehbi_binary_chars8_valid(const char *str)
 {
-	return ehbi_alloc_l(bytes_len, 0, err);
+	return (ehbi_load8(str) & (Ehbi_swar_ones * 0xFE))
+	    == (Ehbi_swar_ones * '0');
 }
 
-void ehbi_free(struct ehbigint *bi)
+static unsigned char ehbi_binary_chars8_to_byte(const char *str)
 {
-	struct eembed_allocator *ea = eembed_global_allocator;
-	if (bi) {
-		if (bi->bytes) {
-			ea->free(ea, bi->bytes);
-		}
-		ea->free(ea, bi);
-	}
-}
+	uint64_t word;
+
+	word = ehbi_load8(str) & Ehbi_swar_ones;
 
-static char *ehbi_decimal_from_hex(char *buf, size_t buf_len, const char *hex,
-				   size_t hex_len, int *err);
+	return (unsigned char)((word * Ehbi_swar_gather) >> 56);
+}
 
-static int ehbi_decimal_to_hex(const char *dec_str, size_t dec_len, char *buf,
-			       size_t buf_len);
+/* the same multiply spreads the bits back out, one to a byte */
+static void ehbi_byte_to_binary_chars8(char *buf, unsigned char byte)
+{
+	uint64_t word;
 
-static char ehbi_nibble_to_hex(unsigned char nibble, int *err);
+	word = ((((uint64_t)byte) * Ehbi_swar_gather) >> 7) & Ehbi_swar_ones;
 
-static unsigned char ehbi_from_hex_nibble(char c, int *err);
+	ehbi_store8(buf, word | (Ehbi_swar_ones * '0'));
+}
 
 /* public functions */
 struct ehbigint *ehbi_set_binary_string(struct ehbigint *bi, const char *str,
 					size_t len, int *err)
 {
-	size_t i, j;
-	struct eba eba;
-
-	eba.endian = eba_big_endian;
-	eba.bits = NULL;
-	eba.size_bytes = 0;
+	size_t i, j, k, need;
+	unsigned char byte;
 
 	Ehbi_assert_bi(bi);
 	ehbi_zero(bi);
 
-	eba.bits = bi->bytes;
-	eba.size_bytes = bi->bytes_len;
-
 	if (str == 0) {
 		Ehbi_log_error0("Null string");
 		ehbi_set_error(err, EHBI_NULL_STRING);
@@ -2173,31 +4682,102 @@ struct ehbigint *ehbi_set_binary_string(struct ehbigint *bi, const char *str,
 		len -= 2;
 	}
 	len = eembed_strnlen(str, len);
-	for (i = 0; i < len; ++i) {
-		if (str[i] != '0' && str[i] != '1') {
-			len = i;
+	/* the digits end at the first character which is not one */
+	for (i = 0; (i + EEMBED_CHAR_BIT) <= len; i += EEMBED_CHAR_BIT) {
+		if (!ehbi_binary_chars8_valid(str + i)) {
+			break;
 		}
 	}
-	if (len > (bi->bytes_len * EEMBED_CHAR_BIT)) {
+	while (i < len && (str[i] == '0' || str[i] == '1')) {
+		++i;
+	}
+	len = i;
+	/* leading zeros need no room, and then the top bit is set */
+	while (len > 1 && str[0] == '0') {
+		++str;
+		--len;
+	}
+	if (len == 0) {
+		return bi;
+	}
+	need = (len + EEMBED_CHAR_BIT - 1) / EEMBED_CHAR_BIT;
+	if (!ehbi_reserve(bi, need, err)) {
+		return NULL;
+	}
+	if (need > bi->bytes_len) {
 		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
 		return NULL;
 	}
 
-	for (i = 0, j = len - 1; i < len; ++i, --j) {
-		eba_set(&eba, i, str[j] == '1' ? 1 : 0);
+	/* the low bytes are whole, from the end of the string */
+	for (j = 0, i = len; i >= EEMBED_CHAR_BIT; ++j, i -= EEMBED_CHAR_BIT) {
+		bi->bytes[j] = ehbi_binary_chars8_to_byte(str + i
+							  - EEMBED_CHAR_BIT);
+	}
+	if (i) {
+		for (byte = 0, k = 0; k < i; ++k) {
+			byte = (unsigned char)((byte << 1) | (str[k] - '0'));
+		}
+		bi->bytes[j++] = byte;
 	}
 
-	ehbi_internal_reset_bytes_used(bi, 2 + (len / 8));
+	bi->bytes_used = j;
+	Ehbi_assert_normal(bi);
 
 	return bi;
 }
 
+static const char ehbi_hex_digits[16] = {
+	'0', '1', '2', '3', '4', '5', '6', '7',
+	'8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+/* the value of each hex character, or 0xFF if the character is not hex */
+static const unsigned char ehbi_hex_values[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/*
+   the characters are looked up in a table, which also marks those which
+   are not hex, first to check them, then to decode two at a time from
+   the end of the string
+*/
 struct ehbigint *ehbi_set_hex_string(struct ehbigint *bi, const char *str,
 				     size_t str_len, int *err)
 {
 	size_t i, j;
 	unsigned char high, low;
-	int local_err;
 
 	Ehbi_assert_bi(bi);
 	if (str == 0) {
@@ -2227,460 +4807,1032 @@ struct ehbigint *ehbi_set_hex_string(struct ehbigint *bi, const char *str,
 		str_len -= 2;
 	}
 
-	j = str_len;
-	i = bi->bytes_len;
+	/* leading zeros need no room */
+	while (str_len > 1 && str[0] == '0') {
+		++str;
+		--str_len;
+	}
 
-	if (!err) {
-		local_err = EHBI_SUCCESS;
-		err = &local_err;
+	if (str_len == 0) {
+		return ehbi_zero(bi);
 	}
 
-	bi->bytes_used = 0;
-	while (j > 0) {
-		low = str[--j];
-		if (j > 0) {
-			high = str[--j];
-		} else {
-			high = '0';
+	if (!ehbi_reserve(bi, (str_len + 1) / 2, err)) {
+		return NULL;
+	}
+	if ((str_len + 1) / 2 > bi->bytes_len) {
+		Ehbi_log_error0("byte[] too small");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		return NULL;
+	}
+
+	for (i = 0; i < str_len; ++i) {
+		if (ehbi_hex_values[(unsigned char)str[i]] > 0x0F) {
+			Ehbi_log_error_s_c_s("Not hex (", str[i], ")");
+			ehbi_set_error(err, EHBI_BAD_DATA);
+			return NULL;
 		}
-		if (bi->bytes_used >= bi->bytes_len) {
-			Ehbi_log_error0("byte[] too small");
+	}
+
+	for (i = 0, j = str_len; j > 0; ++i) {
+		low = ehbi_hex_values[(unsigned char)str[--j]];
+		high = (j > 0) ? ehbi_hex_values[(unsigned char)str[--j]] : 0;
+		bi->bytes[i] = (unsigned char)((high << 4) | low);
+	}
+	bi->bytes_used = i;
+
+	/* the leading zeros were skipped, so the top byte is non-zero */
+	Ehbi_assert_normal(bi);
+
+	return bi;
+}
+
+/*
+   returns the largest power of the radix less than 2^56, and populates
+   digits with the number of digits of the radix which it covers;
+   with bytes as limbs, a byte times this power plus the running carry
+   fits in 64 bits, as does the running remainder of a short division
+   with the next byte brought down: for decimal this is 10^16, which is
+   fewer digits than a uint64_t could hold, as each product needs room
+   above the byte
+*/
+static uint64_t ehbi_radix_chunk(unsigned radix, size_t *digits)
+{
+	uint64_t pow, limit;
+
+	eembed_assert(radix >= 2);
+
+	limit = ((uint64_t)1) << (7 * EEMBED_CHAR_BIT);
+	pow = radix;
+	*digits = 1;
+	while (pow < (limit / radix)) {
+		pow = pow * radix;
+		++(*digits);
+	}
+
+	return pow;
+}
+
+/* bi := (bi * mul) + add, mul and add must be less than 2^56 */
+static struct ehbigint *ehbi_mul_add_u64(struct ehbigint *bi, uint64_t mul,
+					 uint64_t add, int *err)
+{
+	size_t i;
+	uint64_t t;
+
+	t = add;
+	for (i = 0; i < bi->bytes_used; ++i) {
+		t += ((uint64_t)bi->bytes[i]) * mul;
+		bi->bytes[i] = (unsigned char)t;
+		t = t >> EEMBED_CHAR_BIT;
+	}
+	for (; t; ++i) {
+		if (i >= bi->bytes_len) {
+			Ehbi_log_error_s_ul_s("Result byte[", bi->bytes_len,
+					      "] too small");
 			ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
 			return NULL;
 		}
-		bi->bytes[--i] = ehbi_hex_chars_to_byte(high, low, err);
-		if (*err) {
-			Ehbi_log_error_s_c_s_c_s("Bad data (high: ", high,
-						 " low: ", low, ")");
-			ehbi_set_error(err, EHBI_BAD_DATA);
+		bi->bytes[i] = (unsigned char)t;
+		t = t >> EEMBED_CHAR_BIT;
+	}
+	/* the top byte is either the carry, or non-zero from before */
+	bi->bytes_used = i;
+	Ehbi_assert_normal(bi);
+
+	return bi;
+}
+
+/* the digits of every radix, upper case first, as for radix 62 */
+static const char ehbi_radix_digits[62] = {
+	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
+	'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+	'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+	'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+	'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z'
+};
+
+/*
+   returns the value of the character as a digit of the radix, or 0xFF if
+   it is not one; up to radix 36 the letters are not case sensitive
+*/
+static unsigned char ehbi_radix_value(char c, unsigned radix)
+{
+	unsigned val;
+
+	if (c >= '0' && c <= '9') {
+		val = (unsigned)(c - '0');
+	} else if (c >= 'A' && c <= 'Z') {
+		val = 10 + (unsigned)(c - 'A');
+	} else if (c >= 'a' && c <= 'z') {
+		val = ((radix <= 36) ? 10 : 36) + (unsigned)(c - 'a');
+	} else {
+		return 0xFF;
+	}
+
+	return (val < radix) ? (unsigned char)val : 0xFF;
+}
+
+static int ehbi_radix_is_pow2(unsigned radix)
+{
+	return (radix & (radix - 1)) == 0;
+}
+
+/* an upper bound of the bytes needed for len digits of the radix */
+static size_t ehbi_from_radix_size(size_t len, unsigned radix)
+{
+	size_t bits;
+
+	if (radix == 10) {
+		return ehbi_from_decimal_size(len);
+	}
+
+	/* no digit needs more than ceil(log2(radix)) bits */
+	bits = ehbi_msb8((unsigned char)(radix - 1));
+
+	return ((len / EEMBED_CHAR_BIT) * bits)
+	    + ((((len % EEMBED_CHAR_BIT) * bits) + EEMBED_CHAR_BIT - 1)
+	       / EEMBED_CHAR_BIT);
+}
+
+/*
+   the digits are gathered into a word a chunk at a time, and each chunk is
+   multiplied and added into the bytes in one pass over the value so far;
+   the first chunk takes the odd digits, so the rest are full chunks
+*/
+static struct ehbigint *ehbi_set_digits_chunked(struct ehbigint *bi,
+						const char *str, size_t len,
+						unsigned radix, int *err)
+{
+	size_t i, chunk, digits;
+	uint64_t word, mul;
+
+	if (!ehbi_reserve(bi, ehbi_from_radix_size(len, radix), err)) {
+		return NULL;
+	}
+
+	ehbi_radix_chunk(radix, &digits);
+	chunk = len % digits;
+	if (chunk == 0) {
+		chunk = digits;
+	}
+	while (len > 0) {
+		word = 0;
+		mul = 1;
+		for (i = 0; i < chunk; ++i) {
+			word = (word * radix) + ehbi_radix_value(str[i], radix);
+			mul = mul * radix;
+		}
+		if (!ehbi_mul_add_u64(bi, mul, word, err)) {
 			return NULL;
 		}
-		bi->bytes_used++;
+		str += chunk;
+		len -= chunk;
+		chunk = digits;
 	}
 
-	/* let's just zero out the rest of the bytes, for easier debug */
-	eembed_memset(bi->bytes, 0x00, i);
+	return bi;
+}
+
+/*
+   with a power of two radix each digit is a fixed number of bits, which
+   are packed into the bytes from the last digit up, without arithmetic
+*/
+static struct ehbigint *ehbi_set_digits_shift(struct ehbigint *bi,
+					      const char *str, size_t len,
+					      unsigned radix, int *err)
+{
+	size_t i, j, need;
+	unsigned shift, bits, acc;
+
+	shift = ehbi_ctz8((unsigned char)radix);
 
-	ehbi_internal_reset_bytes_used(bi, bi->bytes_used + 1);
+	/* the first digit is not zero, but its high bits need no room */
+	need = ((len - 1) * shift) + ehbi_msb8(ehbi_radix_value(str[0], radix));
+	need = ehbi_bits_to_bytes(need);
+	if (!ehbi_reserve(bi, need, err)) {
+		return NULL;
+	}
+	if (need > bi->bytes_len) {
+		Ehbi_log_error_s_ul_s("Result byte[", bi->bytes_len,
+				      "] too small");
+		ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+		return NULL;
+	}
+
+	acc = 0;
+	bits = 0;
+	for (j = 0, i = len; i > 0; --i) {
+		acc = acc | (((unsigned)ehbi_radix_value(str[i - 1], radix))
+			     << bits);
+		bits += shift;
+		if (bits >= EEMBED_CHAR_BIT) {
+			bi->bytes[j++] = (unsigned char)acc;
+			acc = acc >> EEMBED_CHAR_BIT;
+			bits -= EEMBED_CHAR_BIT;
+		}
+	}
+	if (j < need) {
+		bi->bytes[j++] = (unsigned char)acc;
+	}
+	bi->bytes_used = j;
 
 	return bi;
 }
 
-struct ehbigint *ehbi_set_decimal_string(struct ehbigint *bi, const char *dec,
-					 size_t len, int *err)
+struct ehbigint *ehbi_set_string_radix(struct ehbigint *bi, const char *str,
+				       size_t len, unsigned radix, int *err)
 {
-	char *hex;
-	const size_t buf_size = 80;
-	char buf[80];
-	const char *str;
-	size_t size;
+	size_t i;
 	int negative;
 	struct ehbigint *rp;
-	int local_err;
 
 	Ehbi_assert_bi(bi);
+	if (radix < 2 || radix > 62) {
+		Ehbi_log_error_s_ul_s("Radix not supported? (", radix, ")");
+		ehbi_set_error(err, EHBI_BAD_INPUT);
+		return NULL;
+	}
 	if (len == 0) {
-		str = "0x00";
-		len = 4;
-	} else if (dec == NULL) {
+		return ehbi_zero(bi);
+	} else if (str == NULL) {
 		Ehbi_log_error0("Null string");
 		ehbi_set_error(err, EHBI_NULL_STRING);
 		return NULL;
 	}
-	size = 4 /* strlen("0x00") */  + len + 1;
-	if (size <= buf_size) {
-		hex = buf;
+
+	negative = 0;
+	if (str[0] == '-') {
+		++str;
+		--len;
+		negative = 1;
+	}
+	for (i = 0; i < len && str[i] != '\0'; ++i) {
+		if (ehbi_radix_value(str[i], radix) == 0xFF) {
+			Ehbi_log_error_s_c_s("Character not a digit? (", str[i],
+					     ")");
+			ehbi_set_error(err, EHBI_BAD_INPUT);
+			goto ehbi_set_string_radix_error;
+		}
+	}
+	len = i;
+	/* leading zeros need no room */
+	while (len > 0 && str[0] == '0') {
+		++str;
+		--len;
+	}
+
+	ehbi_zero(bi);
+	if (len == 0) {
+		return bi;
+	}
+
+	if (ehbi_radix_is_pow2(radix)) {
+		rp = ehbi_set_digits_shift(bi, str, len, radix, err);
 	} else {
-		hex = (char *)eembed_malloc(size);
-		if (!hex) {
-			Ehbi_log_error_s_ul_s("Could not allocate ", size,
-					      " bytes?");
-			ehbi_set_error(err, EHBI_NOMEM);
-			return NULL;
+		rp = ehbi_set_digits_chunked(bi, str, len, radix, err);
+	}
+	if (!rp) {
+		goto ehbi_set_string_radix_error;
+	}
+
+	if (negative) {
+		ehbi_sign_set(bi, 1);
+	}
+	Ehbi_assert_normal(bi);
+
+	return bi;
+
+ehbi_set_string_radix_error:
+	ehbi_zero(bi);
+	return NULL;
+}
+
+struct ehbigint *ehbi_set_decimal_string(struct ehbigint *bi, const char *dec,
+					 size_t len, int *err)
+{
+	return ehbi_set_string_radix(bi, dec, len, 10, err);
+}
+
+/*
+   the parser keeps a word of digits, like ehbi_set_digits_chunked, or for
+   a power of two radix the bits which do not yet fill a byte: those bytes
+   arrive most significant first, and are stored in that order until
+   ehbi_parser_finish reverses them, thus no state grows but the result
+*/
+#define Ehbi_parser_flag_started 0x01
+#define Ehbi_parser_flag_negative 0x02
+#define Ehbi_parser_flag_prefix 0x04
+#define Ehbi_parser_flag_nonzero 0x08
+#define Ehbi_parser_flag_digit 0x10
+
+struct ehbi_parser *ehbi_parser_init(struct ehbi_parser *p,
+				     struct ehbigint *bi, unsigned radix,
+				     int *err)
+{
+	Ehbi_assert_bi(bi);
+	eembed_assert(p);
+
+	eembed_memset(p, 0x00, sizeof(struct ehbi_parser));
+	if (radix < 2 || radix > 62) {
+		Ehbi_log_error_s_ul_s("Radix not supported? (", radix, ")");
+		ehbi_set_error(err, EHBI_BAD_INPUT);
+		p->error = EHBI_BAD_INPUT;
+		return NULL;
+	}
+	p->bi = bi;
+	p->radix = radix;
+	if (ehbi_radix_is_pow2(radix)) {
+		p->chunk = ehbi_ctz8((unsigned char)radix);
+	} else {
+		p->pow = ehbi_radix_chunk(radix, &p->chunk);
+	}
+	ehbi_zero(bi);
+
+	return p;
+}
+
+static int ehbi_parser_add_digit(struct ehbi_parser *p, unsigned char val,
+				 int *err)
+{
+	struct ehbigint *bi = p->bi;
+	unsigned bits;
+
+	if (p->pow) {
+		p->word = (p->word * p->radix) + val;
+		if (++(p->digits) < p->chunk) {
+			return 1;
+		}
+		/* the product is less than 7 bytes more */
+		if (!ehbi_reserve(bi, bi->bytes_used + 7, err)
+		    || !ehbi_mul_add_u64(bi, p->pow, p->word, err)) {
+			return 0;
+		}
+		p->word = 0;
+		p->digits = 0;
+		return 1;
+	}
+
+	/* leading zero bits are not kept */
+	if (!(p->flags & Ehbi_parser_flag_nonzero)) {
+		if (val == 0) {
+			return 1;
+		}
+		p->flags |= Ehbi_parser_flag_nonzero;
+		bits = ehbi_msb8(val);
+	} else {
+		bits = (unsigned)p->chunk;
+	}
+	p->word = (p->word << bits) | val;
+	p->digits += bits;
+	if (p->digits >= EEMBED_CHAR_BIT) {
+		p->digits -= EEMBED_CHAR_BIT;
+		if (!ehbi_reserve(bi, p->bytes + 1, err)) {
+			return 0;
+		}
+		if (p->bytes >= bi->bytes_len) {
+			Ehbi_log_error_s_ul_s("Result byte[", bi->bytes_len,
+					      "] too small");
+			ehbi_set_error(err, EHBI_BYTES_TOO_SMALL);
+			return 0;
 		}
+		bi->bytes[p->bytes++] = (unsigned char)(p->word >> p->digits);
+		bi->bytes_used = p->bytes;
+		p->word = p->word & ((1U << p->digits) - 1);
+	}
+	return 1;
+}
+
+struct ehbi_parser *ehbi_parser_feed(struct ehbi_parser *p, const char *chunk,
+				     size_t len, int *err)
+{
+	size_t i;
+	unsigned char val;
+	char c;
+	int lerr;
+
+	eembed_assert(p);
+
+	if (p->error) {
+		ehbi_set_error(err, p->error);
+		return NULL;
+	}
+	lerr = 0;
+	if (len && !chunk) {
+		Ehbi_log_error0("Null string");
+		lerr = EHBI_NULL_STRING;
+		goto ehbi_parser_feed_error;
+	}
+
+	for (i = 0; i < len; ++i) {
+		c = chunk[i];
+		if (!(p->flags & Ehbi_parser_flag_started)) {
+			p->flags |= Ehbi_parser_flag_started;
+			if (c == '-') {
+				p->flags |= Ehbi_parser_flag_negative;
+				continue;
+			}
+		}
+		/* "0x" for hex, and "0b" for binary, may be split */
+		if ((p->flags & Ehbi_parser_flag_prefix)
+		    && ((p->radix == 16 && (c == 'x' || c == 'X'))
+			|| (p->radix == 2 && (c == 'b' || c == 'B')))) {
+			p->flags &= ~Ehbi_parser_flag_prefix;
+			continue;
+		}
+		val = ehbi_radix_value(c, p->radix);
+		if (val == 0xFF) {
+			Ehbi_log_error_s_c_s("Character not a digit? (", c,
+					     ")");
+			lerr = EHBI_BAD_INPUT;
+			goto ehbi_parser_feed_error;
+		}
+		/* the prefix may only follow a leading '0' */
+		if (!(p->flags & Ehbi_parser_flag_digit)) {
+			p->flags |= Ehbi_parser_flag_digit;
+			if (c == '0') {
+				p->flags |= Ehbi_parser_flag_prefix;
+			}
+		} else {
+			p->flags &= ~Ehbi_parser_flag_prefix;
+		}
+		if (!ehbi_parser_add_digit(p, val, &lerr)) {
+			goto ehbi_parser_feed_error;
+		}
+	}
+
+	return p;
+
+ehbi_parser_feed_error:
+	p->error = lerr;
+	ehbi_set_error(err, lerr);
+	ehbi_zero(p->bi);
+	return NULL;
+}
+
+struct ehbigint *ehbi_parser_finish(struct ehbi_parser *p, int *err)
+{
+	struct ehbigint *bi;
+	size_t i, n;
+	unsigned char byte, low;
+	uint64_t mul;
+	int lerr;
+
+	eembed_assert(p);
+
+	bi = p->bi;
+	if (p->error) {
+		ehbi_set_error(err, p->error);
+		return NULL;
 	}
 
-	if (dec[0] == '-') {
-		str = dec + 1;
-		len -= 1;
-		negative = 1;
+	lerr = 0;
+	if (p->pow) {
+		if (p->digits) {
+			for (mul = 1, i = 0; i < p->digits; ++i) {
+				mul = mul * p->radix;
+			}
+			if (!ehbi_reserve(bi, bi->bytes_used + 7, &lerr)
+			    || !ehbi_mul_add_u64(bi, mul, p->word, &lerr)) {
+				goto ehbi_parser_finish_error;
+			}
+		}
+	} else if (p->bytes == 0) {
+		bi->bytes[0] = (unsigned char)p->word;
+		bi->bytes_used = 1;
 	} else {
-		str = dec;
-		negative = 0;
-	}
-	if (!err) {
-		err = &local_err;
-	}
-	*err = ehbi_decimal_to_hex(str, len, hex, size);
-	if (*err) {
-		rp = NULL;
-		goto ehbi_set_decimal_string_end;
-	}
-
-	rp = ehbi_set_hex_string(bi, hex, size, err);
-	if (!rp) {
-		goto ehbi_set_decimal_string_end;
+		/* the bytes were written most significant first */
+		n = p->bytes;
+		for (i = 0; i < n / 2; ++i) {
+			byte = bi->bytes[i];
+			bi->bytes[i] = bi->bytes[(n - 1) - i];
+			bi->bytes[(n - 1) - i] = byte;
+		}
+		bi->bytes_used = n;
+		if (p->digits) {
+			if (!ehbi_reserve(bi, n + 1, &lerr)) {
+				goto ehbi_parser_finish_error;
+			}
+			if (n + 1 > bi->bytes_len) {
+				Ehbi_log_error_s_ul_s("Result byte[",
+						      bi->bytes_len,
+						      "] too small");
+				lerr = EHBI_BYTES_TOO_SMALL;
+				goto ehbi_parser_finish_error;
+			}
+			low = (unsigned char)p->word;
+			ehbi_shift_left(bi, (unsigned long)p->digits, NULL);
+			bi->bytes[0] |= low;
+		}
 	}
 
-	if (negative) {
-		rp = ehbi_negate(bi);
+	if ((p->flags & Ehbi_parser_flag_negative) && !ehbi_is_zero(bi)) {
+		ehbi_sign_set(bi, 1);
 	}
+	Ehbi_assert_normal(bi);
 
-ehbi_set_decimal_string_end:
-	if (size > 80) {
-		eembed_free(hex);
-	}
-	if (!rp) {
-		ehbi_zero(bi);
-		return NULL;
-	}
 	return bi;
+
+ehbi_parser_finish_error:
+	p->error = lerr;
+	ehbi_set_error(err, lerr);
+	ehbi_zero(bi);
+	return NULL;
 }
 
+/*
+   the bytes in use have no leading zero byte, so the length is known
+   before anything is written; each byte is eight characters at once
+*/
 char *ehbi_to_binary_string(const struct ehbigint *bi, char *buf,
 			    size_t buf_len, int *err)
 {
-	size_t i, j, k, written;
-	unsigned char bit;
-	struct eba eba;
-
-	eba.endian = eba_big_endian;
-	eba.bits = NULL;
-	eba.size_bytes = 0;
+	size_t i, j;
 
 	Ehbi_assert_bi(bi);
-	eba.bits = bi->bytes;
-	eba.size_bytes = bi->bytes_len;
-
-	written = 0;
-
-	if (buf && buf_len) {
-		eembed_memset(buf, 0x00, buf_len);
-	}
-
 	if (buf == 0) {
 		Ehbi_log_error0("Null buffer");
 		ehbi_set_error(err, EHBI_NULL_STRING_BUF);
-		goto ehbi_to_binary_string_end;
+		return NULL;
+	}
+	if (buf_len) {
+		buf[0] = '\0';
 	}
 
+	/* "0b", eight characters per byte, and the trailing NULL */
 	if (buf_len < ((bi->bytes_used * EEMBED_CHAR_BIT) + 3)) {
 		Ehbi_log_error0("Buffer too small");
 		ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL);
-		goto ehbi_to_binary_string_end;
+		return NULL;
 	}
 
-	buf[written++] = '0';
-	buf[written++] = 'b';
-
-	for (i = 0; i < bi->bytes_used; ++i) {
-		for (j = 0; j < EEMBED_CHAR_BIT; ++j) {
-			if ((written + 2) >= buf_len) {
-				Ehbi_log_error0("Buffer too small");
-				ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL);
-				goto ehbi_to_binary_string_end;
-			}
-			k = (bi->bytes_used * EEMBED_CHAR_BIT) - 1;
-			k = k - ((i * EEMBED_CHAR_BIT) + j);
-			bit = eba_get(&eba, k);
-			buf[written++] = bit ? '1' : '0';
-		}
+	j = 0;
+	buf[j++] = '0';
+	buf[j++] = 'b';
+	for (i = bi->bytes_used; i > 0; --i) {
+		ehbi_byte_to_binary_chars8(buf + j, bi->bytes[i - 1]);
+		j += EEMBED_CHAR_BIT;
 	}
-	buf[written] = '\0';
+	buf[j] = '\0';
 
-ehbi_to_binary_string_end:
-	if (*err) {
-		buf[0] = '\0';
-	}
 	return buf;
 }
 
+/*
+   the bytes in use have no leading zero byte, so the length is known
+   before anything is written; each byte is two lookups in the digits
+*/
 char *ehbi_to_hex_string(const struct ehbigint *bi, char *buf, size_t buf_len,
 			 int *err)
 {
-	int local_err;
-	size_t i, j;
-	char *rp;
+	size_t i, j, need;
+	unsigned char byte;
 
 	Ehbi_assert_bi(bi);
 	if (buf == 0) {
 		Ehbi_log_error0("Null buffer");
 		ehbi_set_error(err, EHBI_NULL_STRING_BUF);
-		goto ehbi_to_hex_string_end;
+		return NULL;
 	}
 	buf[0] = '\0';
 
-	if (buf_len < (bi->bytes_used + 3)) {
-		Ehbi_log_error0("Buffer too small");
-		ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL);
-		goto ehbi_to_hex_string_end;
+	/* "0x", two characters per byte, and the trailing NULL */
+	need = 2 + (2 * bi->bytes_used) + 1;
+	if (buf_len < need) {
+		if (buf_len < (bi->bytes_used + 3)) {
+			Ehbi_log_error0("Buffer too small");
+			ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL);
+		} else if (buf_len < need - 1) {
+			Ehbi_log_error0("Buffer too small for all digits");
+			ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL_PARTIAL);
+		} else {
+			Ehbi_log_error0("Unable to write trailing NULL");
+			ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL_NO_NULL);
+		}
+		return NULL;
 	}
 
 	j = 0;
 	buf[j++] = '0';
 	buf[j++] = 'x';
-
-	for (i = bi->bytes_len - bi->bytes_used; i < bi->bytes_len; ++i) {
-		if (j + 2 > buf_len) {
-			Ehbi_log_error0("Buffer too small, partially written");
-			ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL_PARTIAL);
-			goto ehbi_to_hex_string_end;
-		}
-		local_err = 0;
-		ehbi_hex_chars_from_byte(buf + j, buf + j + 1, bi->bytes[i],
-					 &local_err);
-		if (local_err) {
-			Ehbi_log_error0("Corrupted data?");
-			ehbi_set_error(err, local_err);
-			goto ehbi_to_hex_string_end;
-		}
-		j += 2;
-	}
-	if (j > buf_len) {
-		Ehbi_log_error0("Unable to write trailing NULL to buffer");
-		ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL_NO_NULL);
-		goto ehbi_to_hex_string_end;
+	for (i = bi->bytes_used; i > 0; --i) {
+		byte = bi->bytes[i - 1];
+		buf[j++] = ehbi_hex_digits[byte >> 4];
+		buf[j++] = ehbi_hex_digits[byte & 0x0F];
 	}
 	buf[j] = '\0';
 
-	/* strip leading '0's ("0x0123" -> "0x123") */
-	/* strip leading "00"s ("0x000123" -> "0x0123") */
-	while ((buf[2] == '0' || buf[2] == 'F') && buf[2] == buf[3]
-	       && buf[2] == buf[4] && buf[2] == buf[5]) {
-		for (j = 2; j < buf_len - 1 && buf[j] != 0; j += 2) {
-			buf[j] = buf[j + 2];
+	return buf;
+}
+
+/*
+   with a power of two radix each digit is a fixed number of bits, which
+   are read from the bytes from the bottom up, without arithmetic
+*/
+static char *ehbi_to_digits_shift(const struct ehbigint *bi, char *buf,
+				  size_t len, size_t start, size_t *pos,
+				  unsigned radix, int *err)
+{
+	size_t i, bit, bits;
+	unsigned shift, val;
+
+	shift = ehbi_ctz8((unsigned char)radix);
+	bits = ehbi_bit_length(bi);
+	bit = 0;
+	do {
+		i = bit / EEMBED_CHAR_BIT;
+		val = bi->bytes[i];
+		if ((i + 1) < bi->bytes_used) {
+			val = val | (((unsigned)bi->bytes[i + 1])
+				     << EEMBED_CHAR_BIT);
 		}
-	}
+		val = (val >> (bit % EEMBED_CHAR_BIT)) & (radix - 1);
+		if (*pos <= start) {
+			Ehbi_log_error_s_ul_s("buf[", len, "] too small");
+			ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL);
+			return NULL;
+		}
+		buf[--(*pos)] = ehbi_radix_digits[val];
+		bit += shift;
+	} while (bit < bits);
 
-ehbi_to_hex_string_end:
-	if (buf && (err == NULL || *err)) {
-		buf[0] = '\0';
+	return buf;
+}
+
+/*
+   the digits are found a chunk at a time, as the remainders of dividing a
+   copy of the value by the power of the radix from ehbi_radix_chunk, and
+   written from the end of the buffer backwards; the chunks below the top
+   are padded with leading zeros
+*/
+static char *ehbi_to_digits_chunked(const struct ehbigint *bi, char *buf,
+				    size_t len, size_t start, size_t *pos,
+				    unsigned radix, int *err)
+{
+	size_t i, digits;
+	uint64_t chunk, pow;
+	struct ehbigint tmp;
+	struct ehbigint *rp;
+	unsigned char tmp_bytes[Ehbi_bi_buf_size];
+
+	ehbi_internal_clear_null_struct(&tmp);
+
+	rp = Ehbi_set_or_malloc(NULL, &tmp, tmp_bytes, Ehbi_bi_buf_size, bi,
+				err);
+	if (!rp) {
+		goto ehbi_to_digits_chunked_end;
 	}
-	rp = ((err == NULL || *err) ? NULL : buf);
+	ehbi_sign_set(&tmp, 0);
 
-	return rp;
+	pow = ehbi_radix_chunk(radix, &digits);
+	do {
+		rp = ehbi_div_small(&tmp, &tmp, pow, &chunk, err);
+		if (!rp) {
+			goto ehbi_to_digits_chunked_end;
+		}
+		for (i = 0; i < digits; ++i) {
+			if (i > 0 && chunk == 0 && ehbi_is_zero(&tmp)) {
+				break;
+			}
+			if (*pos <= start) {
+				Ehbi_log_error_s_ul_s("buf[", len,
+						      "] too small");
+				ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL);
+				rp = NULL;
+				goto ehbi_to_digits_chunked_end;
+			}
+			buf[--(*pos)] = ehbi_radix_digits[chunk % radix];
+			chunk = chunk / radix;
+		}
+	} while (!ehbi_is_zero(&tmp));
+
+ehbi_to_digits_chunked_end:
+	ehbi_set_or_malloc_free(NULL, &tmp);
+	return rp ? buf : NULL;
 }
 
-char *ehbi_to_decimal_string(const struct ehbigint *bi, char *buf, size_t len,
-			     int *err)
+char *ehbi_to_string_radix(const struct ehbigint *bi, char *buf, size_t len,
+			   unsigned radix, int *err)
 {
-	char *hex, *rp;
-	size_t size;
-	const size_t sbuf_size = 80;
-	char sbuf[80];
-
-	hex = NULL;
-	rp = NULL;
+	size_t pos, start;
+	char *rp;
 
 	Ehbi_assert_bi(bi);
-	size = 0;
 
 	if (buf == NULL || len == 0) {
 		Ehbi_log_error0("Null Arguments(s)");
-		if (err) {
-			ehbi_set_error(err, EHBI_NULL_ARGS);
-		}
-		goto ehbi_to_decimal_string_end;
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		return NULL;
 	}
-	rp = buf;
 	buf[0] = '\0';
 
-	size = 4 /* strlen("0x00") */  + (2 * bi->bytes_used) + 1;
-	if (size <= sbuf_size) {
-		hex = sbuf;
-	} else {
-		hex = (char *)eembed_malloc(size);
-		if (!hex) {
-			Ehbi_log_error_s_ul_s("Could not allocate ", size,
-					      " bytes?");
-			ehbi_set_error(err, EHBI_NOMEM);
-			goto ehbi_to_decimal_string_end;
-		}
-	}
-
-	if (ehbi_is_negative(bi)) {
-		buf[0] = '-';
-		buf[1] = '\0';
-		buf = buf + 1;
-		len -= 1;
-	}
-
-	ehbi_to_hex_string(bi, hex, size, err);
-	if (*err) {
-		goto ehbi_to_decimal_string_end;
+	if (radix < 2 || radix > 62) {
+		Ehbi_log_error_s_ul_s("Radix not supported? (", radix, ")");
+		ehbi_set_error(err, EHBI_BAD_INPUT);
+		return NULL;
 	}
-	ehbi_decimal_from_hex(buf, len, hex, size, err);
 
-ehbi_to_decimal_string_end:
-	if (size > 80) {
-		eembed_free(hex);
+	start = ehbi_is_negative(bi) ? 1 : 0;
+	pos = len - 1;
+	if (ehbi_radix_is_pow2(radix)) {
+		rp = ehbi_to_digits_shift(bi, buf, len, start, &pos, radix,
+					  err);
+	} else {
+		rp = ehbi_to_digits_chunked(bi, buf, len, start, &pos, radix,
+					    err);
 	}
-	if (buf && (err == NULL || *err)) {
+	if (!rp) {
 		buf[0] = '\0';
+		return NULL;
 	}
 
-	rp = (err == NULL || *err) ? NULL : rp;
+	if (start) {
+		buf[0] = '-';
+	}
+	eembed_memmove(buf + start, buf + pos, (len - 1) - pos);
+	buf[start + (len - 1) - pos] = '\0';
 
-	return rp;
+	return buf;
 }
 
-static char *ehbi_hex_chars_from_byte(char *high, char *low, unsigned char byte,
-				      int *err)
+char *ehbi_to_decimal_string(const struct ehbigint *bi, char *buf, size_t len,
+			     int *err)
 {
-	int local_err;
+	return ehbi_to_string_radix(bi, buf, len, 10, err);
+}
+
+/* the characters are gathered into a block, which is passed on when full */
+struct ehbi_writer {
+	ehbi_write_func write_func;
+	void *context;
+	size_t used;
+	size_t total;
+	char buf[EHBI_WRITE_BUF_SIZE + 1];
+};
 
-	local_err = 0;
-	*high = ehbi_nibble_to_hex((byte & 0xF0) >> 4, &local_err);
-	if (local_err) {
-		ehbi_set_error(err, local_err);
+static struct ehbi_writer *ehbi_writer_flush(struct ehbi_writer *w, int *err)
+{
+	if (!w->used) {
+		return w;
 	}
-	*low = ehbi_nibble_to_hex((byte & 0x0F), &local_err);
-	if (local_err) {
-		ehbi_set_error(err, local_err);
+	w->buf[w->used] = '\0';
+	if (w->write_func(w->context, w->buf, w->used)) {
+		Ehbi_log_error_s_ul_s("Write of ", w->used, " chars failed");
+		ehbi_set_error(err, EHBI_WRITE_FAILED);
+		return NULL;
 	}
+	w->total += w->used;
+	w->used = 0;
 
-	return local_err ? NULL : high;
+	return w;
 }
 
-static unsigned char ehbi_hex_chars_to_byte(char high, char low, int *err)
+static struct ehbi_writer *ehbi_writer_putc(struct ehbi_writer *w, char c,
+					    int *err)
 {
-	int local_err;
-	unsigned char nibble;
-	unsigned char byte;
-
-	local_err = 0;
-	nibble = ehbi_from_hex_nibble(high, &local_err);
-	if (local_err) {
-		Ehbi_log_error_s_c_s("Error with high nibble (", high, ")");
-		ehbi_set_error(err, EHBI_BAD_HIGH_NIBBLE);
-		return 0;
+	if (w->used == EHBI_WRITE_BUF_SIZE) {
+		if (!ehbi_writer_flush(w, err)) {
+			return NULL;
+		}
 	}
-	byte = (nibble << 4);
+	w->buf[w->used++] = c;
 
-	nibble = ehbi_from_hex_nibble(low, &local_err);
-	if (local_err) {
-		Ehbi_log_error_s_c_s("Error with low nibble (", low, ")");
-		ehbi_set_error(err, EHBI_BAD_LOW_NIBBLE);
-		return 0;
+	return w;
+}
+
+/*
+   as ehbi_to_digits_shift, but from the top digit down, which is possible
+   as the number of digits is known from the bit length
+*/
+static struct ehbi_writer *ehbi_write_shift(const struct ehbigint *bi,
+					    struct ehbi_writer *w,
+					    unsigned radix, int *err)
+{
+	size_t i, bit, bits, n;
+	unsigned shift, val;
+
+	shift = ehbi_ctz8((unsigned char)radix);
+	bits = ehbi_bit_length(bi);
+	n = (bits + shift - 1) / shift;
+	if (n == 0) {
+		n = 1;
+	}
+	for (; n > 0; --n) {
+		bit = (n - 1) * shift;
+		i = bit / EEMBED_CHAR_BIT;
+		val = bi->bytes[i];
+		if ((i + 1) < bi->bytes_used) {
+			val = val | (((unsigned)bi->bytes[i + 1])
+				     << EEMBED_CHAR_BIT);
+		}
+		val = (val >> (bit % EEMBED_CHAR_BIT)) & (radix - 1);
+		if (!ehbi_writer_putc(w, ehbi_radix_digits[val], err)) {
+			return NULL;
+		}
 	}
-	byte += nibble;
 
-	return byte;
+	return w;
 }
 
-/* private functions */
-static int ehbi_decimal_to_hex(const char *dec_str, size_t dec_len, char *buf,
-			       size_t buf_len)
+/*
+   the chunks come from the bottom, as in ehbi_to_digits_chunked, but are
+   needed from the top; rather than a buffer for them, each is stored in
+   "width" bytes at the top of the copy being divided, in the room which
+   the quotient no longer needs: each division removes at least "bits"
+   bits, where 2^bits <= pow, while a chunk takes 8 * width, a few more,
+   thus the copy is that much larger than the value, e.g. for decimal a
+   chunk of 16 digits takes 7 bytes of which the quotient frees at least
+   53 bits, so about 6% larger
+*/
+static struct ehbi_writer *ehbi_write_chunked(const struct ehbigint *bi,
+					      struct ehbi_writer *w,
+					      unsigned radix, int *err)
 {
-	char *rp;
+	size_t i, j, digits, bits, width, count, size, top;
+	uint64_t chunk, pow;
+	char dbuf[EEMBED_CHAR_BIT * sizeof(uint64_t)];
+	struct ehbigint tmp;
+	struct ehbigint *rp;
+	unsigned char tmp_bytes[Ehbi_bi_buf_size];
 
-	if (dec_str == 0 || buf == 0) {
-		Ehbi_log_error0("Null argument");
-		return EHBI_NULL_ARGS;
-	}
+	ehbi_internal_clear_null_struct(&tmp);
 
-	if (buf_len < 5) {
-		Ehbi_log_error0("Buffer too small");
-		return EHBI_STRING_BUF_TOO_SMALL;
+	pow = ehbi_radix_chunk(radix, &digits);
+	for (bits = 0; (pow >> (bits + 1)) != 0; ++bits) ;
+	width = (bits / EEMBED_CHAR_BIT) + 1;
+
+	/* after k of at most count divisions, the quotient takes at most
+	   (bit_length - (bits * k) + 7) / 8 bytes, but at least 1, and the
+	   chunks width * k, which is the most when k is count */
+	count = (ehbi_bit_length(bi) / bits) + 1;
+	size = ((ehbi_bit_length(bi) + 14
+		 + (count * ((EEMBED_CHAR_BIT * width) - bits)))
+		/ EEMBED_CHAR_BIT) + 1;
+	if (size < (width * count) + 1) {
+		size = (width * count) + 1;
 	}
 
-	rp = decimal_to_hex(dec_str, dec_len, buf, buf_len);
+	rp = Ehbi_tmp_reserve(NULL, &tmp, tmp_bytes, Ehbi_bi_buf_size, size,
+			      err);
+	if (!rp) {
+		goto ehbi_write_chunked_end;
+	}
+	rp = ehbi_set(&tmp, bi, err);
+	if (!rp) {
+		goto ehbi_write_chunked_end;
+	}
+	ehbi_sign_set(&tmp, 0);
 
-	if (rp == NULL) {
-		Ehbi_log_error_s_s_s("Character not decimal? (", dec_str, ")");
-		return EHBI_BAD_INPUT;
+	top = tmp.bytes_len;
+	do {
+		rp = ehbi_div_small(&tmp, &tmp, pow, &chunk, err);
+		if (!rp) {
+			goto ehbi_write_chunked_end;
+		}
+		eembed_assert(tmp.bytes_used + width <= top);
+		top -= width;
+		for (i = 0; i < width; ++i) {
+			tmp.bytes[top + i] = (unsigned char)chunk;
+			chunk = chunk >> EEMBED_CHAR_BIT;
+		}
+	} while (!ehbi_is_zero(&tmp));
+
+	/* the last chunk stored is the top, and is not padded */
+	for (j = top; j < tmp.bytes_len; j += width) {
+		chunk = 0;
+		for (i = width; i > 0; --i) {
+			chunk = (chunk << EEMBED_CHAR_BIT);
+			chunk = chunk | tmp.bytes[j + i - 1];
+		}
+		i = digits;
+		do {
+			dbuf[--i] = ehbi_radix_digits[chunk % radix];
+			chunk = chunk / radix;
+		} while (i > 0 && (chunk || j != top));
+		for (; i < digits; ++i) {
+			if (!ehbi_writer_putc(w, dbuf[i], err)) {
+				rp = NULL;
+				goto ehbi_write_chunked_end;
+			}
+		}
 	}
 
-	return EHBI_SUCCESS;
+ehbi_write_chunked_end:
+	ehbi_set_or_malloc_free(NULL, &tmp);
+	return rp ? w : NULL;
 }
 
-static char *ehbi_decimal_from_hex(char *buf, size_t buf_len, const char *hex,
-				   size_t hex_len, int *err)
+static void ehbi_writer_init(struct ehbi_writer *w, ehbi_write_func write_func,
+			     void *context)
 {
-	char *rp;
+	w->write_func = write_func;
+	w->context = context;
+	w->used = 0;
+	w->total = 0;
+	w->buf[0] = '\0';
+}
+
+size_t ehbi_write_string_radix(const struct ehbigint *bi, unsigned radix,
+			       ehbi_write_func write_func, void *context,
+			       int *err)
+{
+	struct ehbi_writer w;
+	struct ehbi_writer *rp;
+
+	Ehbi_assert_bi(bi);
 
-	if (hex == 0 || buf == 0) {
-		Ehbi_log_error0("Null argument");
+	if (write_func == NULL) {
+		Ehbi_log_error0("Null Arguments(s)");
 		ehbi_set_error(err, EHBI_NULL_ARGS);
-		return NULL;
-	}
-	if (buf_len) {
-		buf[0] = '\0';
+		return 0;
 	}
 
-	if (buf_len < 2 || buf_len < hex_len) {
-		Ehbi_log_error0("Buffer too small");
-		ehbi_set_error(err, EHBI_STRING_BUF_TOO_SMALL);
-		return NULL;
+	if (radix < 2 || radix > 62) {
+		Ehbi_log_error_s_ul_s("Radix not supported? (", radix, ")");
+		ehbi_set_error(err, EHBI_BAD_INPUT);
+		return 0;
 	}
 
-	rp = hex_to_decimal(hex, hex_len, buf, buf_len);
-
-	if (rp == NULL) {
-		Ehbi_log_error_s_s_s("Character not hex? (", hex, ")");
-		ehbi_set_error(err, EHBI_BAD_INPUT);
+	ehbi_writer_init(&w, write_func, context);
+	if (ehbi_is_negative(bi)) {
+		ehbi_writer_putc(&w, '-', err);
+	}
+	if (ehbi_radix_is_pow2(radix)) {
+		rp = ehbi_write_shift(bi, &w, radix, err);
+	} else {
+		rp = ehbi_write_chunked(bi, &w, radix, err);
+	}
+	if (!rp || !ehbi_writer_flush(&w, err)) {
+		return 0;
 	}
 
-	return buf;
+	return w.total;
 }
 
-static char ehbi_nibble_to_hex(unsigned char nibble, int *err)
+size_t ehbi_write_decimal(const struct ehbigint *bi,
+			  ehbi_write_func write_func, void *context, int *err)
 {
-	char buf[25];
-
-	if (nibble < 10) {
-		return '0' + nibble;
-	}
-	if (nibble < 16) {
-		return 'A' + nibble - 10;
-	}
-
-	eembed_ulong_to_hex(buf, 25, nibble);
-	Ehbi_log_error_s_s_s("Bad input '", buf, "'");
-	ehbi_set_error(err, EHBI_BAD_INPUT);
-	return 0;
+	return ehbi_write_string_radix(bi, 10, write_func, context, err);
 }
 
-static unsigned char ehbi_from_hex_nibble(char c, int *err)
+size_t ehbi_write_hex(const struct ehbigint *bi, ehbi_write_func write_func,
+		      void *context, int *err)
 {
-	if (c >= '0' && c <= '9') {
-		return c - '0';
+	size_t i;
+	unsigned char byte;
+	struct ehbi_writer w;
+
+	Ehbi_assert_bi(bi);
+
+	if (write_func == NULL) {
+		Ehbi_log_error0("Null Arguments(s)");
+		ehbi_set_error(err, EHBI_NULL_ARGS);
+		return 0;
 	}
 
-	if (c >= 'a' && c <= 'f') {
-		return 10 + c - 'a';
+	ehbi_writer_init(&w, write_func, context);
+	ehbi_writer_putc(&w, '0', err);
+	ehbi_writer_putc(&w, 'x', err);
+	for (i = bi->bytes_used; i > 0; --i) {
+		byte = bi->bytes[i - 1];
+		if (!ehbi_writer_putc(&w, ehbi_hex_digits[byte >> 4], err)
+		    || !ehbi_writer_putc(&w, ehbi_hex_digits[byte & 0x0F],
+					 err)) {
+			return 0;
+		}
 	}
-	if (c >= 'A' && c <= 'F') {
-		return 10 + c - 'A';
+	if (!ehbi_writer_flush(&w, err)) {
+		return 0;
 	}
 
-	Ehbi_log_error_s_c_s("Not hex (", c, ")");
-	ehbi_set_error(err, EHBI_NOT_HEX);
+	return w.total;
+}
+
+int ehbi_write_to_log(void *context, const char *str, size_t len)
+{
+	struct eembed_log *log = (struct eembed_log *)context;
+
+	(void)len;
+	log->append_s(log, str);
 
 	return 0;
 }
 
-static void ehbi_internal_reset_bytes_used(struct ehbigint *bi, size_t from)
+/* private functions */
+#ifndef NDEBUG
+/* the top byte in use is non-zero, unless the value is zero, which is
+   never negative */
+static int ehbi_internal_is_normal(const struct ehbigint *bi)
 {
-	size_t i;
-
-	if (from > bi->bytes_len) {
-		from = bi->bytes_len;
-	}
-	for (i = (bi->bytes_len - from); i < bi->bytes_len; ++i) {
-		if (bi->bytes[i] != 0) {
-			break;
-		}
-	}
-	bi->bytes_used = (bi->bytes_len - i);
-	if (bi->bytes_used == 0) {
-		bi->bytes_used = 1;
+	if (bi->bytes_used < 1 || bi->bytes_used > bi->bytes_len) {
+		return 0;
 	}
-
-	if (ehbi_is_zero(bi)) {
-		ehbi_sign_set(bi, 0);
+	if (bi->bytes_used > 1) {
+		return bi->bytes[bi->bytes_used - 1] != 0x00;
 	}
+	return !(bi->bytes[0] == 0x00 && ehbi_flag(bi, ehbi_flag_sign));
 }
+#endif
 
 struct eembed_log *ehbi_log_get(void)
 {
@@ -2770,22 +5922,6 @@ static void ehbi_log_error_s_c_s(const char *file, int line,
 	log->append_eol(log);
 }
 
-static void ehbi_log_error_s_s_s(const char *file, int line,
-				 const char *pre, const char *mid,
-				 const char *post)
-{
-	struct eembed_log *log = ehbi_log_get();
-	if (!log) {
-		return;
-	}
-
-	ehbi_log_file_line(file, line, log);
-	log->append_s(log, pre);
-	log->append_s(log, mid);
-	log->append_s(log, post);
-	log->append_eol(log);
-}
-
 static void ehbi_log_error_s_l_s(const char *file, int line,
 				 const char *pre, long l, const char *post)
 {
@@ -2815,23 +5951,6 @@ static void ehbi_log_error_s_ul_s(const char *file, int line,
 	log->append_eol(log);
 }
 
-static void ehbi_log_error_s_c_s_c_s(const char *file, int line,
-				     const char *pre, char c1, const char *mid,
-				     char c2, const char *post)
-{
-	struct eembed_log *log = ehbi_log_get();
-	if (!log) {
-		return;
-	}
-	ehbi_log_file_line(file, line, log);
-	log->append_s(log, pre);
-	log->append_c(log, c1);
-	log->append_s(log, mid);
-	log->append_c(log, c2);
-	log->append_s(log, post);
-	log->append_eol(log);
-}
-
 static void ehbi_log_error_s_ul_s_ul_s(const char *file, int line,
 				       const char *pre, unsigned long ul1,
 				       const char *mid, unsigned long ul2,
@@ -16,8 +16,25 @@
 Ehbigint_begin_C_functions
 #undef Ehbigint_begin_C_functions
 #include <stddef.h>		/* size_t */
+#include <stdint.h>		/* uint64_t */
     struct ehbigint;
+struct eembed_allocator;
 
+/* unsigned 128 bit variants are only available if the compiler has them */
+#ifndef EHBI_SKIP_U128
+#ifdef __SIZEOF_INT128__
+#define EHBI_HAVE_U128 1
+__extension__ typedef unsigned __int128 ehbi_u128;
+#endif
+#endif
+
+/*
+   the magnitude is stored little-endian: bytes[0] is the least significant
+   byte, and bytes[bytes_used - 1] the most significant non-zero byte;
+   bytes from bytes_used up to bytes_len are unspecified, and not read
+   use ehbi_set_big_endian and ehbi_to_big_endian to exchange the value
+   as big-endian bytes, or ehbi_import and ehbi_export for words
+*/
 struct ehbigint {
 	unsigned char *bytes;
 	size_t bytes_len;
@@ -28,6 +45,21 @@ struct ehbigint {
 	 */
 };
 
+/*
+   an arena from which the _x functions take their temporary values;
+   temporaries are bump-allocated and released in bulk as each function
+   returns, so bytes_used is back to its prior value after every call
+   if the arena is too small, the stack or malloc is used instead, but
+   bytes_peak still records how many bytes would have been needed
+*/
+struct ehbi_scratch {
+	unsigned char *bytes;
+	size_t bytes_len;
+	size_t bytes_used;
+	size_t bytes_spilled;
+	size_t bytes_peak;
+};
+
 /*
    assigns the byte[] to the struct, sets to zero
    parameters must not be NULL
@@ -48,6 +80,30 @@ struct ehbigint *ehbi_init_l(struct ehbigint *bi, unsigned char *bytes,
 */
 struct ehbigint *ehbi_zero(struct ehbigint *bi);
 
+/*
+   wraps "len" little-endian bytes as a read-only, non-negative ehbigint,
+   without copying; the view may be passed as any "const struct ehbigint *"
+   argument, and ehbi_negate may be used to make it negative, but it must
+   not be passed as a result, nor outlive the bytes
+   big-endian bytes can not be viewed, and must be copied with
+   ehbi_set_big_endian
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_view_init(struct ehbigint *view,
+				const unsigned char *bytes, size_t len,
+				int *err);
+
+/*
+   a read-only view of "len" bytes of the magnitude of bi, starting
+   "offset" bytes from the least significant; the slice is non-negative
+   and shares the bytes of bi, thus it is valid only until bi is modified,
+   though it may be an operand of a function which writes the result to bi
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_view_slice(struct ehbigint *view,
+				 const struct ehbigint *bi, size_t offset,
+				 size_t len, int *err);
+
 /*
    populates an ehbigint with a binary string value e.g. "0b0101010111110000"
    returns NULL on error, and populates err with error_code
@@ -70,20 +126,119 @@ struct ehbigint *ehbi_set_hex_string(struct ehbigint *bi, const char *str,
 struct ehbigint *ehbi_set_decimal_string(struct ehbigint *bi, const char *dec,
 					 size_t len, int *err);
 
+/*
+   populates an ehbigint with a string of digits in the radix, 2 to 62,
+   with an optional leading '-' and no prefix, e.g. "EHBIGINT" in radix 36;
+   as with mpz_set_str, up to radix 36 letters are not case sensitive,
+   above that 'A' to 'Z' are 10 to 35, and 'a' to 'z' are 36 to 61
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_set_string_radix(struct ehbigint *bi, const char *str,
+				       size_t len, unsigned radix, int *err);
+
+/*
+   an incremental parser, for text which arrives in chunks, e.g. from a
+   socket or a file reader: beyond the ehbigint it populates, it holds
+   only a word of state; the fields are private
+*/
+struct ehbi_parser {
+	struct ehbigint *bi;
+	uint64_t word;
+	uint64_t pow;
+	size_t chunk;
+	size_t digits;
+	size_t bytes;
+	unsigned radix;
+	int error;
+	unsigned char flags;
+};
+
+/*
+   prepares the parser to populate bi from digits of the radix, 2 to 62,
+   as for ehbi_set_string_radix, also allowing a "0x" or "0b" prefix for
+   radix 16 or 2; a growable bi will grow as the digits arrive
+   bi is zeroed, and must not be used until ehbi_parser_finish
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbi_parser *ehbi_parser_init(struct ehbi_parser *p,
+				     struct ehbigint *bi, unsigned radix,
+				     int *err);
+
+/*
+   parses the next "len" characters, which may split the number anywhere
+   errors are sticky, and are returned again by ehbi_parser_finish
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbi_parser *ehbi_parser_feed(struct ehbi_parser *p, const char *chunk,
+				     size_t len, int *err);
+
+/*
+   completes the value of the ehbigint; to parse another number, call
+   ehbi_parser_init again
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_parser_finish(struct ehbi_parser *p, int *err);
+
+/*
+   populates an ehbigint with the value of a big-endian unsigned byte[],
+   e.g.: { 0x01, 0x00 } is 256; leading zero bytes are allowed
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_set_big_endian(struct ehbigint *bi,
+				     const unsigned char *bytes, size_t len,
+				     int *err);
+
 /*
    populates an ehbigint with the value
 */
 struct ehbigint *ehbi_set(struct ehbigint *bi, const struct ehbigint *val,
 			  int *err);
 
+/*
+   exchanges the values of a and b; if the byte[]s of both are on the heap
+   on their own (e.g.: grown by a growable ehbigint), the byte[]s are
+   exchanged in constant time, otherwise the bytes are swapped in place,
+   and each must have room for the other's value
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_swap(struct ehbigint *a, struct ehbigint *b, int *err);
+
+/*
+   populates dst with the value of src, and sets src to zero; like
+   ehbi_swap, if both byte[]s are on the heap on their own, they are
+   exchanged rather than copied
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_move(struct ehbigint *dst, struct ehbigint *src,
+			   int *err);
+
 /*
    populates an ehbigint with the value
    returns NULL on error, and populates err with error_code
 */
 struct ehbigint *ehbi_set_l(struct ehbigint *bi, long val, int *err);
 
+/*
+   populates an ehbigint with the unsigned value
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_set_u64(struct ehbigint *bi, uint64_t val, int *err);
+
+/*
+   returns the value of the ehbigint as a uint64_t
+   if the value is negative or too large, returns 0 and populates err
+*/
+uint64_t ehbi_get_u64(const struct ehbigint *bi, int *err);
+
+/*
+   returns 1 if the value is in the range [0, UINT64_MAX]
+   returns 0 otherwise
+*/
+int ehbi_fits_u64(const struct ehbigint *bi);
+
 /*
    populates the first ehbigint with the sum of the second and third
+   the result may be the same as either operand
    returns NULL on error, and populates err with error_code
 */
 struct ehbigint *ehbi_add(struct ehbigint *res, const struct ehbigint *bi1,
@@ -96,6 +251,13 @@ struct ehbigint *ehbi_add(struct ehbigint *res, const struct ehbigint *bi1,
 struct ehbigint *ehbi_add_l(struct ehbigint *res, const struct ehbigint *bi1,
 			    long v2, int *err);
 
+/*
+   populates the first ehbigint with the sum of the second and third
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_add_u64(struct ehbigint *res, const struct ehbigint *bi1,
+			      uint64_t v2, int *err);
+
 /*
    increments the first ehbigint by the value in the second parameter
    returns NULL on error, and populates err with error_code
@@ -125,6 +287,7 @@ struct ehbigint *ehbi_dec_l(struct ehbigint *bi, long val, int *err);
 /*
    populates the first ehbigint with the value of the second perameter minus
    the third
+   the result may be the same as either operand
    returns NULL on error, and populates err with error_code
 */
 struct ehbigint *ehbi_subtract(struct ehbigint *res, const struct ehbigint *bi1,
@@ -139,7 +302,18 @@ struct ehbigint *ehbi_subtract_l(struct ehbigint *res,
 				 const struct ehbigint *bi1, long v2, int *err);
 
 /*
-   populates the first ehbigint with the sum of the second and third
+   populates the first ehbigint with the value of the second perameter minus
+   the third
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_subtract_u64(struct ehbigint *res,
+				   const struct ehbigint *bi1, uint64_t v2,
+				   int *err);
+
+/*
+   populates the first ehbigint with the product of the second and third
+   the result may be the same as either operand, in which case that
+   operand is first copied to a temporary
    returns NULL on error, and populates err with error_code
 */
 struct ehbigint *ehbi_mul(struct ehbigint *res, const struct ehbigint *bi1,
@@ -152,6 +326,13 @@ struct ehbigint *ehbi_mul(struct ehbigint *res, const struct ehbigint *bi1,
 struct ehbigint *ehbi_mul_l(struct ehbigint *res, const struct ehbigint *bi1,
 			    long v2, int *err);
 
+/*
+   populates the first ehbigint with the product of the second and third
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_mul_u64(struct ehbigint *res, const struct ehbigint *bi1,
+			      uint64_t v2, int *err);
+
 /*
    shifts the value of the ehbigint up by num_bits number of bits
    if not enough space was available, overflow is populated with the number
@@ -166,9 +347,77 @@ struct ehbigint *ehbi_shift_left(struct ehbigint *bi, unsigned long num_bits,
 */
 struct ehbigint *ehbi_shift_right(struct ehbigint *bi, unsigned long num_bits);
 
+/*
+   the bit queries and updates act on the magnitude, the sign is ignored;
+   bit 0 is the least significant bit
+*/
+
+/*
+   returns the number of bits needed to hold the magnitude, 0 for zero
+*/
+size_t ehbi_bit_length(const struct ehbigint *bi);
+
+/*
+   returns 1 if the bit is set
+   returns 0 otherwise, including for bits above the bit length
+*/
+int ehbi_test_bit(const struct ehbigint *bi, size_t bit);
+
+/*
+   sets the bit, growing a growable ehbigint if needed
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_set_bit(struct ehbigint *bi, size_t bit, int *err);
+
+/*
+   clears the bit, clearing a bit above the bit length is a no-op
+*/
+struct ehbigint *ehbi_clear_bit(struct ehbigint *bi, size_t bit);
+
+/*
+   returns the number of low zero bits, which is the index of the lowest
+   set bit; for zero, returns 0
+*/
+size_t ehbi_count_trailing_zeros(const struct ehbigint *bi);
+
+/*
+   returns the number of set bits
+*/
+size_t ehbi_popcount(const struct ehbigint *bi);
+
+/*
+   populates the result with the bitwise and, or, xor, or and-not (the
+   first and the complement of the second) of the two values;
+   negative values act as two's complement, infinitely sign-extended, which
+   gives the same results as mpz_and, mpz_ior, mpz_xor
+   the result may be the same as either operand
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_and(struct ehbigint *res, const struct ehbigint *bi1,
+			  const struct ehbigint *bi2, int *err);
+
+struct ehbigint *ehbi_or(struct ehbigint *res, const struct ehbigint *bi1,
+			 const struct ehbigint *bi2, int *err);
+
+struct ehbigint *ehbi_xor(struct ehbigint *res, const struct ehbigint *bi1,
+			  const struct ehbigint *bi2, int *err);
+
+struct ehbigint *ehbi_andnot(struct ehbigint *res, const struct ehbigint *bi1,
+			     const struct ehbigint *bi2, int *err);
+
+/*
+   populates the result with the one's complement of the value, which is
+   -bi - 1, as mpz_com
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_not(struct ehbigint *res, const struct ehbigint *bi,
+			  int *err);
+
 /*
    populates the first ehbigint quotient and remainder with the results
    of the numerator divided by the denominator
+   the quotient and remainder may be the same as the numerator or the
+   denominator; the remainder needs only room for the remainder
    returns NULL on error, and populates err with error_code
 */
 struct ehbigint *ehbi_div(struct ehbigint *quotient,
@@ -186,6 +435,16 @@ struct ehbigint *ehbi_div_l(struct ehbigint *quotient,
 			    const struct ehbigint *numerator,
 			    long denominator, int *err);
 
+/*
+   populates the first ehbigint quotient and remainder with the results
+   of the numerator divided by the denominator
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_div_u64(struct ehbigint *quotient,
+			      struct ehbigint *remainder,
+			      const struct ehbigint *numerator,
+			      uint64_t denominator, int *err);
+
 /*
    populates the first ehbigint with the largest integer not greater
    than the square root of the thrid ehbigint; the second ehbigint
@@ -241,6 +500,16 @@ struct ehbigint *ehbi_exp_mod_ll(struct ehbigint *result,
 				 const struct ehbigint *base, long exponent,
 				 long modulus, int *err);
 
+/*
+   populates the first ehbigint result with the value of the base
+   raised to the power of the exponent mod the modulus
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_exp_mod_u64(struct ehbigint *result,
+				  const struct ehbigint *base,
+				  const struct ehbigint *exponent,
+				  uint64_t modulus, int *err);
+
 /*
    populates the first ehbigint result with the number of combinations
    of n objects taken k at a time, disregarding order.
@@ -373,6 +642,48 @@ int ehbi_compare(const struct ehbigint *bi1, const struct ehbigint *bi2);
 */
 int ehbi_compare_l(const struct ehbigint *bi1, long i2);
 
+/*
+   returns 0 if the values represented by the arguments are equal
+   returns <0 if the first ehbigint is less than the second
+   returns >0 if the first ehbigint is greater than the second
+*/
+int ehbi_compare_u64(const struct ehbigint *bi1, uint64_t i2);
+
+#ifdef EHBI_HAVE_U128
+/*
+   unsigned 128 bit variants of the above uint64_t functions
+*/
+struct ehbigint *ehbi_set_u128(struct ehbigint *bi, ehbi_u128 val, int *err);
+
+ehbi_u128 ehbi_get_u128(const struct ehbigint *bi, int *err);
+
+int ehbi_fits_u128(const struct ehbigint *bi);
+
+struct ehbigint *ehbi_add_u128(struct ehbigint *res,
+			       const struct ehbigint *bi1, ehbi_u128 v2,
+			       int *err);
+
+struct ehbigint *ehbi_subtract_u128(struct ehbigint *res,
+				    const struct ehbigint *bi1, ehbi_u128 v2,
+				    int *err);
+
+struct ehbigint *ehbi_mul_u128(struct ehbigint *res,
+			       const struct ehbigint *bi1, ehbi_u128 v2,
+			       int *err);
+
+struct ehbigint *ehbi_div_u128(struct ehbigint *quotient,
+			       struct ehbigint *remainder,
+			       const struct ehbigint *numerator,
+			       ehbi_u128 denominator, int *err);
+
+struct ehbigint *ehbi_exp_mod_u128(struct ehbigint *result,
+				   const struct ehbigint *base,
+				   const struct ehbigint *exponent,
+				   ehbi_u128 modulus, int *err);
+
+int ehbi_compare_u128(const struct ehbigint *bi1, ehbi_u128 i2);
+#endif /* EHBI_HAVE_U128 */
+
 /*
    returns 1 if negative
    returns 0 otherwise
@@ -418,6 +729,156 @@ char *ehbi_to_hex_string(const struct ehbigint *bi, char *buf, size_t buf_len,
 char *ehbi_to_decimal_string(const struct ehbigint *bi, char *buf,
 			     size_t buf_len, int *err);
 
+/*
+   populates the passed in buffer with the digits of the ehbigint in the
+   radix, 2 to 62, with a leading '-' if negative and no prefix; the digits
+   are those of ehbi_set_string_radix, with upper case letters up to 36
+   returns pointer to buf success or NULL on error and sets the value of
+   err with error_code.
+*/
+char *ehbi_to_string_radix(const struct ehbigint *bi, char *buf,
+			   size_t buf_len, unsigned radix, int *err);
+
+/*
+   populates the passed in buffer with the magnitude of the ehbigint as
+   big-endian bytes, right-aligned and zero padded to fill the buf_len
+   the sign is not written, see ehbi_is_negative
+   returns pointer to buf success or NULL on error and sets the value of
+   err with error_code.
+*/
+unsigned char *ehbi_to_big_endian(const struct ehbigint *bi,
+				  unsigned char *buf, size_t buf_len, int *err);
+
+/****************************************************************************/
+/* Streaming output */
+/****************************************************************************/
+/*
+   the ehbi_write_* functions pass the same characters as the ehbi_to_*
+   functions to a write function, a block at a time, without a buffer for
+   the whole string; each block is NULL terminated as well as given a len
+   the write function returns 0 to continue, or non-zero to stop
+*/
+typedef int (*ehbi_write_func)(void *context, const char *str, size_t len);
+
+/* the largest block passed to the write function, on the stack */
+#ifndef EHBI_WRITE_BUF_SIZE
+#define EHBI_WRITE_BUF_SIZE 64
+#endif
+
+/*
+   writes the digits of the ehbigint in the radix, as ehbi_to_string_radix
+   with a power of two radix, no memory is needed beyond the block; with
+   any other radix the digits are found from the least significant, thus
+   a copy of the value is kept, a few percent larger to hold the chunks
+   returns the number of characters written, or 0 on error and sets the
+   value of err with error_code, EHBI_WRITE_FAILED if the write stopped
+*/
+size_t ehbi_write_string_radix(const struct ehbigint *bi, unsigned radix,
+			       ehbi_write_func write_func, void *context,
+			       int *err);
+
+/* as ehbi_write_string_radix, with radix 10 */
+size_t ehbi_write_decimal(const struct ehbigint *bi,
+			  ehbi_write_func write_func, void *context, int *err);
+
+/* as ehbi_to_hex_string, with the "0x" and two digits per byte */
+size_t ehbi_write_hex(const struct ehbigint *bi, ehbi_write_func write_func,
+		      void *context, int *err);
+
+/* a write function which appends to the struct eembed_log context */
+int ehbi_write_to_log(void *context, const char *str, size_t len);
+
+/****************************************************************************/
+/* Serialization */
+/****************************************************************************/
+/*
+   a compact binary form for storage and IPC, without string conversion:
+   a header byte with the version and the sign, the count of magnitude
+   bytes as a LEB128 varint, then the bytes, least significant first
+*/
+#define EHBI_SERIAL_VERSION 1
+
+/* the bytes ehbi_serialize will write */
+size_t ehbi_serialized_size(const struct ehbigint *bi);
+
+/*
+   writes the serialized form of the ehbigint to the buf
+   returns the number of bytes written, or 0 on error and sets the value
+   of err with error_code.
+*/
+size_t ehbi_serialize(const struct ehbigint *bi, unsigned char *buf,
+		      size_t buf_len, int *err);
+
+/*
+   populates an ehbigint from the serialized form at the start of buf;
+   if "used" is not NULL, it is set to the number of bytes read, thus
+   values written one after the other may be read back in turn
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_deserialize(struct ehbigint *bi,
+				  const unsigned char *buf, size_t buf_len,
+				  size_t *used, int *err);
+
+/*
+   a batch holds many ehbigints in one buffer, with a table of offsets
+   so that any one of them may be read without reading the others;
+   the offsets are 4 bytes, thus a batch is limited to 4 GiB
+*/
+size_t ehbi_serialized_batch_size(const struct ehbigint *const *bis,
+				  size_t count);
+
+/*
+   returns the number of bytes written, or 0 on error and sets the value
+   of err with error_code.
+*/
+size_t ehbi_serialize_batch(const struct ehbigint *const *bis, size_t count,
+			    unsigned char *buf, size_t buf_len, int *err);
+
+/*
+   returns the number of ehbigints in the batch, or 0 on error and sets
+   the value of err with error_code.
+*/
+size_t ehbi_serialized_batch_count(const unsigned char *buf, size_t buf_len,
+				   int *err);
+
+/*
+   populates an ehbigint with the value at "index" in the batch
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_deserialize_batch(struct ehbigint *bi,
+					const unsigned char *buf,
+					size_t buf_len, size_t index, int *err);
+
+/*
+   as mpz_import, populates a non-negative ehbigint from "count" words of
+   "size" bytes: "order" is 1 for the most significant word first, or -1
+   for the least; "endian" is 1 for big-endian words, -1 for little, or 0
+   for the native byte order; the top "nails" bits of each word are
+   ignored; words of little-endian bytes, least significant word first,
+   and without nails, are simply copied
+   returns NULL on error, and populates err with error_code
+*/
+struct ehbigint *ehbi_import(struct ehbigint *bi, size_t count, int order,
+			     size_t size, int endian, size_t nails,
+			     const void *data, int *err);
+
+/*
+   the words ehbi_export will write for the magnitude, 0 for zero
+*/
+size_t ehbi_export_count(const struct ehbigint *bi, size_t size, size_t nails);
+
+/*
+   as mpz_export, writes the magnitude of the ehbigint to "data" as words,
+   with the arguments as for ehbi_import, the nails written as zero, and
+   sets "countp" to the number of words written, if not NULL; the sign is
+   not written, see ehbi_is_negative
+   returns pointer to data, or NULL on error and sets the value of err
+   with error_code.
+*/
+void *ehbi_export(void *data, size_t data_len, size_t *countp, int order,
+		  size_t size, int endian, size_t nails,
+		  const struct ehbigint *bi, int *err);
+
 /****************************************************************************/
 /* Constructors */
 /****************************************************************************/
@@ -426,6 +887,191 @@ struct ehbigint *ehbi_alloc_l(size_t bytes, long val, int *err);
 
 void ehbi_free(struct ehbigint *bi);
 
+/*
+   by default an ehbigint has a fixed size, and functions return an error
+   if the result does not fit; a growable ehbigint is instead realloc'd
+   through eembed_global_allocator, roughly doubling as needed
+   the grown byte[] is released by ehbi_free, thus the ehbigint should
+   have come from ehbi_alloc
+*/
+void ehbi_set_growable(struct ehbigint *bi, int growable);
+
+/*
+   returns 1 if the ehbigint is growable
+   returns 0 otherwise
+*/
+int ehbi_is_growable(const struct ehbigint *bi);
+
+#ifndef EHBI_SKIP_POOL
+/*****************************************************************************/
+/* Pool */
+/*****************************************************************************/
+/* the smallest pooled block is 2**EHBI_POOL_MIN_CLASS_BITS bytes */
+#ifndef EHBI_POOL_MIN_CLASS_BITS
+#define EHBI_POOL_MIN_CLASS_BITS 5
+#endif
+
+/* each size class is double the previous, larger requests are not pooled */
+#ifndef EHBI_POOL_NUM_CLASSES
+#define EHBI_POOL_NUM_CLASSES 12
+#endif
+
+/* the most free blocks of each size class a thread keeps cached */
+#ifndef EHBI_POOL_MAX_CACHED
+#define EHBI_POOL_MAX_CACHED 64
+#endif
+
+struct ehbi_pool_stats {
+	unsigned long hits;
+	unsigned long misses;
+	size_t bytes_cached;
+};
+
+/*
+   returns an allocator which rounds requests up to a power of two size
+   class, and keeps freed blocks in per-thread free lists for reuse;
+   it wraps the eembed_global_allocator at the time of the first call
+   to enable pooling for ehbi_alloc and the heap temporaries:
+	eembed_global_allocator = ehbi_pool_allocator();
+*/
+struct eembed_allocator *ehbi_pool_allocator(void);
+
+/* frees the blocks cached by the calling thread, e.g.: before it exits */
+void ehbi_pool_release(void);
+
+/* populates the stats with those of the calling thread */
+struct ehbi_pool_stats *ehbi_pool_stats(struct ehbi_pool_stats *stats);
+#endif /* EHBI_SKIP_POOL */
+
+/*****************************************************************************/
+/* Scratch */
+/*****************************************************************************/
+#ifndef EHBI_SKIP_THREAD_CACHE
+/*
+   when no scratch is given, temporaries which are too big for the stack
+   are taken from a per-thread cache, which grows to the high-water mark
+   and is reused by later calls; a thread should release it before it
+   exits, or whenever the memory would be better used elsewhere
+*/
+void ehbi_thread_cache_release(void);
+
+/* returns the current size of the calling thread's cache */
+size_t ehbi_thread_cache_size(void);
+#endif /* EHBI_SKIP_THREAD_CACHE */
+
+/* assigns the byte[] to the scratch, parameters must not be NULL */
+struct ehbi_scratch *ehbi_scratch_init(struct ehbi_scratch *s,
+				       unsigned char *bytes, size_t len);
+
+/* allocates a scratch and its byte[] as a single block */
+struct ehbi_scratch *ehbi_scratch_alloc(size_t len, int *err);
+
+void ehbi_scratch_free(struct ehbi_scratch *s);
+
+/* releases everything taken from the scratch, and clears the peak */
+void ehbi_scratch_reset(struct ehbi_scratch *s);
+
+/* returns the most bytes which were in use since init or reset */
+size_t ehbi_scratch_peak(const struct ehbi_scratch *s);
+
+/*
+   variants of the functions above which take their temporary values from
+   the scratch rather than from the stack or the heap
+   if the scratch is NULL, these behave exactly as the plain versions
+*/
+struct ehbigint *ehbi_add_x(struct ehbigint *res, const struct ehbigint *bi1,
+			    const struct ehbigint *bi2, struct ehbi_scratch *s,
+			    int *err);
+
+struct ehbigint *ehbi_inc_x(struct ehbigint *bi, const struct ehbigint *val,
+			    struct ehbi_scratch *s, int *err);
+
+struct ehbigint *ehbi_dec_x(struct ehbigint *bi, const struct ehbigint *val,
+			    struct ehbi_scratch *s, int *err);
+
+struct ehbigint *ehbi_subtract_x(struct ehbigint *res,
+				 const struct ehbigint *bi1,
+				 const struct ehbigint *bi2,
+				 struct ehbi_scratch *s, int *err);
+
+struct ehbigint *ehbi_mul_x(struct ehbigint *res, const struct ehbigint *bi1,
+			    const struct ehbigint *bi2, struct ehbi_scratch *s,
+			    int *err);
+
+struct ehbigint *ehbi_div_x(struct ehbigint *quotient,
+			    struct ehbigint *remainder,
+			    const struct ehbigint *numerator,
+			    const struct ehbigint *denominator,
+			    struct ehbi_scratch *s, int *err);
+
+struct ehbigint *ehbi_sqrt_x(struct ehbigint *result,
+			     struct ehbigint *remainder,
+			     const struct ehbigint *val, struct ehbi_scratch *s,
+			     int *err);
+
+struct ehbigint *ehbi_exp_x(struct ehbigint *result,
+			    const struct ehbigint *base,
+			    const struct ehbigint *exponent,
+			    struct ehbi_scratch *s, int *err);
+
+struct ehbigint *ehbi_exp_mod_x(struct ehbigint *result,
+				const struct ehbigint *base,
+				const struct ehbigint *exponent,
+				const struct ehbigint *modulus,
+				struct ehbi_scratch *s, int *err);
+
+struct ehbigint *ehbi_n_choose_k_x(struct ehbigint *result,
+				   const struct ehbigint *n,
+				   const struct ehbigint *k,
+				   struct ehbi_scratch *s, int *err);
+
+#ifndef EHBI_SKIP_IS_PROBABLY_PRIME
+int ehbi_is_probably_prime_x(const struct ehbigint *bi, unsigned int accuracy,
+			     struct ehbi_scratch *s, int *err);
+#endif /* EHBI_SKIP_IS_PROBABLY_PRIME */
+
+/*****************************************************************************/
+/* Sizes */
+/*****************************************************************************/
+/*
+   these return, in constant time from the bit lengths, an upper bound on
+   the bytes_len needed for the result of an operation, or the buf_len
+   needed for a string conversion; sized with these, an operation will
+   not fail for lack of room
+*/
+size_t ehbi_add_size(const struct ehbigint *bi1, const struct ehbigint *bi2);
+
+size_t ehbi_mul_size(const struct ehbigint *bi1, const struct ehbigint *bi2);
+
+/*
+   returns 0 and populates err if the exponent is negative, or if the
+   size would not fit in a size_t
+*/
+size_t ehbi_exp_size(const struct ehbigint *base,
+		     const struct ehbigint *exponent, int *err);
+
+size_t ehbi_exp_size_l(const struct ehbigint *base, long exponent, int *err);
+
+/*
+   the result of ehbi_n_choose_k also holds the running products, thus
+   this bound is for those, and is larger than the binomial itself
+   returns 0 and populates err if the size would not fit in a size_t
+*/
+size_t ehbi_n_choose_k_size_bound(const struct ehbigint *n,
+				  const struct ehbigint *k, int *err);
+
+/* the buf_len for the ehbi_to_*_string functions, including the NULL */
+size_t ehbi_binary_string_len(const struct ehbigint *bi);
+size_t ehbi_hex_string_len(const struct ehbigint *bi);
+size_t ehbi_decimal_string_len(const struct ehbigint *bi);
+/* returns 0 if the radix is not from 2 to 62 */
+size_t ehbi_string_radix_len(const struct ehbigint *bi, unsigned radix);
+
+/* the bytes_len for the ehbi_set_*_string functions, given the str_len */
+size_t ehbi_from_binary_size(size_t str_len);
+size_t ehbi_from_hex_size(size_t str_len);
+size_t ehbi_from_decimal_size(size_t str_len);
+
 /*****************************************************************************/
 /* Log */
 /*****************************************************************************/
@@ -465,6 +1111,7 @@ enum {
 	EHBI_DIVIDE_BY_ZERO,
 	EHBI_PRNG_ERROR,
 	EHBI_SQRT_NEGATIVE,
+	EHBI_WRITE_FAILED,
 	EHBI_LAST
 };
 
@@ -142,6 +142,46 @@ unsigned test_add_hex(int verbose, const char *str_1, const char *str_2,
 	return failures;
 }
 
+unsigned test_add_aliased(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[BILEN], bytes2[BILEN];
+	struct ehbigint bi1, bi2;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi1, bytes1, BILEN);
+	ehbi_init(&bi2, bytes2, BILEN);
+	ehbi_set_hex_string(&bi1, "0xFFFFFFFF", 10, &err);
+	ehbi_set_l(&bi2, 1, &err);
+
+	/* the result as the first operand, carrying into a new byte */
+	ehbi_add(&bi1, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "res == bi1");
+	failures += Check_ehbigint_hex(&bi1, "0x0100000000");
+
+	/* the result as the second operand, which is the shorter */
+	ehbi_add(&bi2, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "res == bi2");
+	failures += Check_ehbigint_hex(&bi2, "0x0100000001");
+
+	/* all three the same */
+	ehbi_add(&bi2, &bi2, &bi2, &err);
+	failures += check_int_m(err, 0, "res == bi1 == bi2");
+	failures += Check_ehbigint_hex(&bi2, "0x0200000002");
+
+	/* differing signs, the smaller magnitude in place */
+	ehbi_set_l(&bi1, -3, &err);
+	ehbi_add(&bi1, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "negative res == bi1");
+	failures += Check_ehbigint_hex(&bi1, "0x01FFFFFFFF");
+
+	return failures;
+}
+
 unsigned test_add(int v)
 {
 	/*      char *u64_max = "0xFFFFFFFFFFFFFFFF" */
@@ -161,6 +201,8 @@ unsigned test_add(int v)
 	failures += test_add_decimal(v, "-6", "2", "-4");
 	failures += test_add_decimal(v, "-6", "11", "5");
 
+	failures += test_add_aliased(v);
+
 	return failures;
 }
 
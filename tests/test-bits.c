@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-bits.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+unsigned test_bits_query(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes[BILEN];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, BILEN);
+	failures += check_int_m((int)ehbi_bit_length(&bi), 0, "zero length");
+	failures += check_int_m((int)ehbi_count_trailing_zeros(&bi), 0,
+				"zero ctz");
+	failures += check_int_m((int)ehbi_popcount(&bi), 0, "zero popcount");
+
+	ehbi_set_hex_string(&bi, "0x03A8F05000", 12, &err);
+	failures += check_int_m(err, 0, "setup");
+	failures += check_int_m((int)ehbi_bit_length(&bi), 34, "bit_length");
+	failures += check_int_m((int)ehbi_count_trailing_zeros(&bi), 12,
+				"ctz");
+	failures += check_int_m((int)ehbi_popcount(&bi), 11, "popcount");
+	failures += check_int_m(ehbi_test_bit(&bi, 12), 1, "bit 12");
+	failures += check_int_m(ehbi_test_bit(&bi, 11), 0, "bit 11");
+	failures += check_int_m(ehbi_test_bit(&bi, 33), 1, "bit 33");
+	failures += check_int_m(ehbi_test_bit(&bi, 34), 0, "bit 34");
+	failures += check_int_m(ehbi_test_bit(&bi, 1000), 0, "bit 1000");
+
+	/* the sign is ignored */
+	ehbi_negate(&bi);
+	failures += check_int_m((int)ehbi_bit_length(&bi), 34, "negative");
+	failures += check_int_m((int)ehbi_popcount(&bi), 11, "negative");
+
+	return failures;
+}
+
+unsigned test_bits_set_clear(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes[4];
+	struct ehbigint *bi;
+	struct ehbigint fixed;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init_l(&fixed, bytes, 4, 1, &err);
+	ehbi_set_bit(&fixed, 20, &err);
+	failures += check_int_m(err, 0, "ehbi_set_bit");
+	failures += Check_ehbigint_hex(&fixed, "0x100001");
+
+	ehbi_set_bit(&fixed, 32, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "too small");
+	failures += Check_ehbigint_hex(&fixed, "0x100001");
+	err = 0;
+
+	/* clearing the top bit shrinks the value */
+	ehbi_clear_bit(&fixed, 20);
+	failures += Check_ehbigint_hex(&fixed, "0x01");
+	ehbi_clear_bit(&fixed, 100);
+	failures += Check_ehbigint_hex(&fixed, "0x01");
+
+	/* and clearing the last bit of a negative leaves a plain zero */
+	ehbi_negate(&fixed);
+	ehbi_clear_bit(&fixed, 0);
+	failures += check_int_m(ehbi_is_zero(&fixed), 1, "zero");
+	failures += check_int_m(ehbi_is_negative(&fixed), 0, "not negative");
+
+	bi = ehbi_alloc(2, &err);
+	if (!bi) {
+		Test_log_error("ehbi_alloc failed");
+		return failures + 1;
+	}
+	ehbi_set_growable(bi, 1);
+	ehbi_set_bit(bi, 100, &err);
+	failures += check_int_m(err, 0, "growable ehbi_set_bit");
+	failures += check_int_m((int)ehbi_bit_length(bi), 101, "grown");
+	failures += check_int_m((int)ehbi_count_trailing_zeros(bi), 100,
+				"grown ctz");
+	ehbi_free(bi);
+
+	return failures;
+}
+
+unsigned test_bits(int v)
+{
+	unsigned failures = 0;
+
+	failures += test_bits_query(v);
+	failures += test_bits_set_clear(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_bits)
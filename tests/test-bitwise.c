@@ -0,0 +1,130 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-bitwise.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+struct test_bitwise_row {
+	const char *a;
+	const char *b;
+	const char *a_and_b;
+	const char *a_or_b;
+	const char *a_xor_b;
+	const char *a_andnot_b;
+	const char *not_a;
+};
+
+/* the expected values are as from mpz_and, mpz_ior, mpz_xor, mpz_com */
+static const struct test_bitwise_row test_bitwise_rows[] = {
+	{ "305419896", "16711935",
+	  "3407992", "318723839", "315315847", "302011904", "-305419897" },
+	{ "264917625139440", "3855",
+	  "0", "264917625143295", "264917625143295", "264917625139440", "-264917625139441" },
+	{ "-1", "4660",
+	  "4660", "-1", "-4661", "-4661", "0" },
+	{ "-256", "-256",
+	  "-256", "-256", "0", "0", "255" },
+	{ "-4294967296", "4294967295",
+	  "0", "-1", "-1", "-4294967296", "4294967295" },
+	{ "-74565", "-444691369455",
+	  "-444691378159", "-65861", "444691312298", "444691303594", "74564" },
+	{ "4660", "-65536",
+	  "0", "-60876", "-60876", "4660", "-4661" },
+	{ "0", "-7",
+	  "0", "-7", "-7", "0", "-1" },
+	{ NULL, NULL, NULL, NULL, NULL, NULL, NULL }
+};
+
+unsigned test_bitwise_row(int verbose, const struct test_bitwise_row *row)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[BILEN], bytes2[BILEN], bytes3[BILEN];
+	struct ehbigint a, b, res;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&a, bytes1, BILEN);
+	ehbi_init(&b, bytes2, BILEN);
+	ehbi_init(&res, bytes3, BILEN);
+	ehbi_set_decimal_string(&a, row->a, eembed_strlen(row->a), &err);
+	ehbi_set_decimal_string(&b, row->b, eembed_strlen(row->b), &err);
+	failures += check_int_m(err, 0, "setup");
+
+	ehbi_and(&res, &a, &b, &err);
+	failures += Check_ehbigint_dec(&res, row->a_and_b);
+	ehbi_or(&res, &a, &b, &err);
+	failures += Check_ehbigint_dec(&res, row->a_or_b);
+	ehbi_xor(&res, &a, &b, &err);
+	failures += Check_ehbigint_dec(&res, row->a_xor_b);
+	ehbi_andnot(&res, &a, &b, &err);
+	failures += Check_ehbigint_dec(&res, row->a_andnot_b);
+	ehbi_not(&res, &a, &err);
+	failures += Check_ehbigint_dec(&res, row->not_a);
+	failures += check_int_m(err, 0, "err");
+
+	/* the result may be the same as an operand */
+	ehbi_xor(&b, &a, &b, &err);
+	failures += Check_ehbigint_dec(&b, row->a_xor_b);
+	ehbi_not(&a, &a, &err);
+	failures += Check_ehbigint_dec(&a, row->not_a);
+	failures += check_int_m(err, 0, "aliased err");
+
+	if (failures) {
+		Test_log_error(row->a);
+	}
+
+	return failures;
+}
+
+unsigned test_bitwise_fit(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[BILEN], bytes2[BILEN], bytes3[2];
+	struct ehbigint a, b, res;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&a, bytes1, BILEN);
+	ehbi_init(&b, bytes2, BILEN);
+	ehbi_init(&res, bytes3, 2);
+
+	/* wide operands are fine if the result fits */
+	ehbi_set_hex_string(&a, "0xFFFFFFFF0123", 14, &err);
+	ehbi_set_hex_string(&b, "0xFFFFFFFF0000", 14, &err);
+	ehbi_xor(&res, &a, &b, &err);
+	failures += check_int_m(err, 0, "ehbi_xor");
+	failures += Check_ehbigint_hex(&res, "0x0123");
+
+	ehbi_negate(&b);
+	ehbi_or(&res, &a, &b, &err);
+	failures += check_int_m(err, 0, "ehbi_or");
+	failures += Check_ehbigint_dec(&res, "-65245");
+
+	/* 0x010000 needs three bytes */
+	ehbi_and(&res, &a, &b, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "too small");
+	failures += check_int_m(ehbi_is_zero(&res), 1, "zeroed");
+
+	return failures;
+}
+
+unsigned test_bitwise(int v)
+{
+	unsigned failures = 0;
+	size_t i;
+
+	for (i = 0; test_bitwise_rows[i].a; ++i) {
+		failures += test_bitwise_row(v, &test_bitwise_rows[i]);
+	}
+	failures += test_bitwise_fit(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_bitwise)
@@ -76,6 +76,45 @@ unsigned test_bytes_shift_left_inner(int verbose, const char *val, size_t bytes,
 	return failures;
 }
 
+unsigned test_shift_left_bits(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned long overflow;
+	unsigned char bytes_buf[4];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes_buf, 4);
+
+	ehbi_set_hex_string(&bi, "0x01D4782B", 10, &err);
+	ehbi_shift_left(&bi, 1, &overflow);
+	failures += Check_ehbigint_hex(&bi, "0x03A8F056");
+	failures += check_int_m((int)overflow, 0, "no overflow");
+
+	ehbi_set_hex_string(&bi, "0x1D47", 6, &err);
+	ehbi_shift_left(&bi, 13, &overflow);
+	failures += Check_ehbigint_hex(&bi, "0x03A8E000");
+	failures += check_int_m((int)overflow, 0, "fits exactly");
+
+	/* the top 4 bits do not fit and are counted as lost */
+	ehbi_set_hex_string(&bi, "0x03A8F057", 10, &err);
+	ehbi_shift_left(&bi, 10, &overflow);
+	failures += Check_ehbigint_hex(&bi, "0xA3C15C00");
+	failures += check_int_m((int)overflow, 4, "overflow");
+
+	ehbi_set_hex_string(&bi, "0x03A8F057", 10, &err);
+	ehbi_shift_left(&bi, 32, &overflow);
+	failures += Check_ehbigint_hex(&bi, "0x00");
+	failures += check_int_m((int)overflow, 26, "all lost");
+	failures += check_int_m(err, 0, "err");
+
+	return failures;
+}
+
 unsigned test_bytes_shift_left(int v)
 {
 	unsigned failures = 0;
@@ -85,6 +124,7 @@ unsigned test_bytes_shift_left(int v)
 	failures += test_bytes_shift_left_inner(v, "0x05", 2, "0x050000");
 	failures += test_bytes_shift_left_inner(v, "0x17", 3, "0x17000000");
 	failures += test_bytes_shift_left_inner(v, "0x00FF", 3, "0x00FF000000");
+	failures += test_shift_left_bits(v);
 
 	return failures;
 }
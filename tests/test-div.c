@@ -206,6 +206,48 @@ unsigned test_div_by_zero(int verbose)
 	return failures;
 }
 
+unsigned test_div_aliased(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[BILEN], bytes2[BILEN];
+	struct ehbigint bi1, bi2, slice;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi1, bytes1, BILEN);
+	ehbi_init(&bi2, bytes2, BILEN);
+	ehbi_set_decimal_string(&bi1, "5088824049625", 13, &err);
+	ehbi_set_l(&bi2, 33554393, &err);
+
+	/* the quotient over the numerator, the remainder over the
+	   denominator */
+	ehbi_div(&bi1, &bi2, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "aliased");
+	failures += Check_ehbigint_dec(&bi1, "151658");
+	failures += Check_ehbigint_dec(&bi2, "31916031");
+
+	/* and swapped, with a negative numerator */
+	ehbi_set_l(&bi1, -13, &err);
+	ehbi_set_l(&bi2, 6, &err);
+	ehbi_div(&bi2, &bi1, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "swapped");
+	failures += Check_ehbigint_dec(&bi2, "-2");
+	failures += Check_ehbigint_dec(&bi1, "1");
+
+	/* the quotient over the bytes below a slice numerator */
+	ehbi_set_hex_string(&bi1, "0x0102030405060708", 18, &err);
+	ehbi_view_slice(&slice, &bi1, 2, 6, &err);
+	ehbi_div_l(&bi1, &bi2, &slice, 3, &err);
+	failures += check_int_m(err, 0, "quotient overlaps slice");
+	failures += Check_ehbigint_hex(&bi1, "0x5601015702");
+	failures += Check_ehbigint_dec(&bi2, "0");
+
+	return failures;
+}
+
 unsigned test_div(int v)
 {
 	unsigned failures = 0;
@@ -226,11 +268,24 @@ unsigned test_div(int v)
 	failures +=
 	    test_div_v(v, "5088824049625", "33554393", "151658", "31916031");
 
+	/* denominators wider than a word take the long division */
+	failures += test_div_v(v, "1208925819614629174706175",
+			       "18446744073709551557", "65536", "3866623");
+	failures += test_div_v(v, "-1208925819614629174706175",
+			       "72057594037927936", "-16777215",
+			       "72057594037927935");
+	/* the first estimate of a quotient byte is too big, and is added back */
+	failures += test_div_v(v, "468875483143287754279065",
+			       "11199968642185822209", "41863",
+			       "11195875462679143698");
+
 	failures += test_div_by_zero(v);
 
 	failures += test_div_l(v, "-13", 6, "-2", "1");
 	failures += test_div_l(v, "600851475143", 65521, "9170364", "55499");
 
+	failures += test_div_aliased(v);
+
 	return failures;
 }
 
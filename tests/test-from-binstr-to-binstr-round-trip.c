@@ -127,6 +127,48 @@ unsigned test_hex_vs_binary_string(int verbose, const char *hex,
 	return failures;
 }
 
+unsigned test_binstr_edges(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes[20];
+	char buf[2 + (8 * 3) + 1];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, 20);
+
+	/* the digits stop at the first character which is not one */
+	ehbi_set_binary_string(&bi, "0B1010101111111111x1", 20, &err);
+	failures += check_int_m(err, 0, "stop at x");
+	failures += Check_ehbigint_hex(&bi, "0xABFF");
+	ehbi_set_binary_string(&bi, "101 11111", 9, &err);
+	failures += Check_ehbigint_hex(&bi, "0x05");
+	ehbi_set_binary_string(&bi, "11111111120", 11, &err);
+	failures += check_int_m(err, 0, "stop at 2");
+	failures += Check_ehbigint_hex(&bi, "0x01FF");
+	ehbi_set_binary_string(&bi, "10000000", 8, &err);
+	failures += Check_ehbigint_hex(&bi, "0x80");
+
+	/* the leading zero byte is not written */
+	ehbi_set_binary_string(&bi, "0b000000000000000111000001", 26, &err);
+	failures += check_int_m(err, 0, "leading zeros");
+	failures += check_int_m((int)bi.bytes_used, 2, "bytes_used");
+	ehbi_to_binary_string(&bi, buf, 2 + (8 * 2) + 1, &err);
+	failures += check_int_m(err, 0, "exact buf");
+	failures += check_str_m(buf, "0b0000000111000001", "exact buf");
+
+	ehbi_negate(&bi);
+	ehbi_to_binary_string(&bi, buf, 2 + (8 * 2), &err);
+	failures += check_int_m(err, EHBI_STRING_BUF_TOO_SMALL, "too small");
+	failures += check_str_m(buf, "", "too small");
+
+	return failures;
+}
+
 unsigned test_from_binstr_to_binstr_round_trip(int v)
 {
 	unsigned failures = 0;
@@ -145,6 +187,8 @@ unsigned test_from_binstr_to_binstr_round_trip(int v)
 	bin_str = "0b0000101000001111";
 	failures += test_hex_vs_binary_string(v, hex_str, bin_str);
 
+	failures += test_binstr_edges(v);
+
 	return failures;
 }
 
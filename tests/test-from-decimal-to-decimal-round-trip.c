@@ -61,6 +61,62 @@ unsigned from_dec_to_dec_round_trip(int verbose, const char *dec)
 	return failures;
 }
 
+unsigned test_from_decimal_chunks(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes_buf[20];
+	unsigned char small_buf[2];
+	struct ehbigint bi, small;
+	const char *str;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes_buf, 20);
+	ehbi_init(&small, small_buf, 2);
+
+	/* either side of a chunk of 16 digits */
+	str = "9999999999999999";
+	ehbi_set_decimal_string(&bi, str, eembed_strlen(str), &err);
+	failures += Check_ehbigint_hex(&bi, "0x2386F26FC0FFFF");
+	str = "10000000000000000";
+	ehbi_set_decimal_string(&bi, str, eembed_strlen(str), &err);
+	failures += Check_ehbigint_hex(&bi, "0x2386F26FC10000");
+	str = "100000000000000000000000000000001";
+	ehbi_set_decimal_string(&bi, str, eembed_strlen(str), &err);
+	failures += Check_ehbigint_hex(&bi,
+				       "0x04EE2D6D415B85ACEF8100000001");
+	str = "-98765432109876543210987654321098765";
+	ehbi_set_decimal_string(&bi, str, eembed_strlen(str), &err);
+	failures += Check_ehbigint_dec(&bi,
+				       "-98765432109876543210987654321098765");
+	failures += check_int_m(err, 0, "chunks");
+
+	/* leading zeros need no room, and negative zero is zero */
+	str = "-0000000000000000000000000000000000000000065535";
+	ehbi_set_decimal_string(&small, str, eembed_strlen(str), &err);
+	failures += check_int_m(err, 0, "leading zeros");
+	failures += Check_ehbigint_dec(&small, "-65535");
+	str = "-000";
+	ehbi_set_decimal_string(&small, str, eembed_strlen(str), &err);
+	failures += check_int_m(ehbi_is_negative(&small), 0, "-0");
+
+	str = "65536";
+	ehbi_set_decimal_string(&small, str, eembed_strlen(str), &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "too small");
+	failures += check_int_m(ehbi_is_zero(&small), 1, "zeroed");
+	err = 0;
+
+	str = "12a4";
+	ehbi_set_decimal_string(&bi, str, eembed_strlen(str), &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "not decimal");
+	failures += check_int_m(ehbi_is_zero(&bi), 1, "zeroed");
+
+	return failures;
+}
+
 unsigned test_from_decimal_to_decimal_round_trip(int v)
 {
 	unsigned failures = 0;
@@ -76,6 +132,8 @@ unsigned test_from_decimal_to_decimal_round_trip(int v)
 	dec_str = "-1";
 	failures += from_dec_to_dec_round_trip(v, dec_str);
 
+	failures += test_from_decimal_chunks(v);
+
 	return failures;
 }
 
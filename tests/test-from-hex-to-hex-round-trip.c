@@ -4,7 +4,7 @@
 
 #include "test-ehbigint-private-utils.h"
 
-unsigned test_from_hex_to_hex_round_trip(int verbose)
+unsigned from_hex_to_hex_round_trip(int verbose)
 {
 	struct eembed_log *log = eembed_err_log;
 	int err;
@@ -40,4 +40,57 @@ unsigned test_from_hex_to_hex_round_trip(int verbose)
 	return failures;
 }
 
+unsigned test_hex_edges(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes_buf[20];
+	char buf[9];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes_buf, 20);
+
+	/* odd length, mixed case, and leading zeros */
+	ehbi_set_hex_string(&bi, "0x000aBc0dEf", 12, &err);
+	failures += check_int_m(err, 0, "odd length");
+	failures += check_int_m((int)bi.bytes_used, 4, "bytes_used");
+	failures += Check_ehbigint_hex(&bi, "0x0ABC0DEF");
+
+	ehbi_set_hex_string(&bi, "0x12G4", 6, &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "not hex");
+	err = 0;
+
+	/* "0x", six digits and the NULL fit exactly */
+	ehbi_set_hex_string(&bi, "0xABCDEF", 8, &err);
+	ehbi_to_hex_string(&bi, buf, 9, &err);
+	failures += check_int_m(err, 0, "exact fit");
+	failures += check_str_m(buf, "0xABCDEF", "exact fit");
+
+	ehbi_to_hex_string(&bi, buf, 8, &err);
+	failures += check_int_m(err, EHBI_STRING_BUF_TOO_SMALL_NO_NULL,
+				"no room for NULL");
+	failures += check_str_m(buf, "", "no room for NULL");
+	err = 0;
+
+	ehbi_zero(&bi);
+	ehbi_to_hex_string(&bi, buf, 9, &err);
+	failures += check_str_m(buf, "0x00", "zero");
+
+	return failures;
+}
+
+unsigned test_from_hex_to_hex_round_trip(int v)
+{
+	unsigned failures = 0;
+
+	failures += from_hex_to_hex_round_trip(v);
+	failures += test_hex_edges(v);
+
+	return failures;
+}
+
 ECHECK_TEST_MAIN_V(test_from_hex_to_hex_round_trip)
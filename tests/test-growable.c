@@ -0,0 +1,125 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-growable.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+unsigned test_growable_fixed_by_default(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[4];
+	unsigned char bytes2[4];
+	struct ehbigint bi1, bi2;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+
+	err = 0;
+	ehbi_init(&bi1, bytes1, 4);
+	ehbi_init(&bi2, bytes2, 4);
+	failures += check_int_m(ehbi_is_growable(&bi1), 0, "default");
+
+	ehbi_set_hex_string(&bi1, "0xFFFFFFFF", 10, &err);
+	failures += check_int_m(err, 0, "set 0xFFFFFFFF");
+	ehbi_add_l(&bi2, &bi1, 1, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL_FOR_CARRY, "carry");
+	failures += check_int_m(bi2.bytes_len, 4, "fixed bytes_len");
+
+	return failures;
+}
+
+unsigned test_growable_ops(int verbose)
+{
+	int err;
+	unsigned failures;
+	struct ehbigint *bi1, *bi2, *bi3;
+	const char *str;
+	char buf[250];
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+
+	err = 0;
+	bi1 = ehbi_alloc(1, &err);
+	bi2 = ehbi_alloc(1, &err);
+	bi3 = ehbi_alloc(1, &err);
+	if (!bi1 || !bi2 || !bi3) {
+		Test_log_error("ehbi_alloc failed");
+		failures = 1;
+		goto test_growable_ops_end;
+	}
+	ehbi_set_growable(bi1, 1);
+	ehbi_set_growable(bi2, 1);
+	ehbi_set_growable(bi3, 1);
+	failures += check_int_m(ehbi_is_growable(bi1), 1, "growable");
+
+	/* grows for a carry */
+	str = "0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF"
+	    "FFFFFFFFFFFFFFFF";
+	ehbi_set_hex_string(bi1, str, eembed_strlen(str), &err);
+	failures += check_int_m(err, 0, "ehbi_set_hex_string");
+	ehbi_add_l(bi2, bi1, 1, &err);
+	failures += check_int_m(err, 0, "ehbi_add_l");
+	ehbi_to_decimal_string(bi2, buf, 250, &err);
+	failures += check_int_m(err, 0, "ehbi_to_decimal_string");
+	failures += check_str_m(buf,
+				"213598703592091008239502170616955211460270452"
+				"235665276994704160782221972578064055002296208"
+				"6936576", "2^320");
+
+	/* grows for a product */
+	ehbi_set_u64(bi1, UINT64_MAX, &err);
+	ehbi_set_u64(bi2, UINT64_MAX, &err);
+	ehbi_mul(bi3, bi1, bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_mul");
+	failures += Check_ehbigint_dec(bi3,
+				       "340282366920938463426481119284349108225");
+
+	/* grows well past the size of the stack buffers */
+	ehbi_set_l(bi1, 3, &err);
+	ehbi_set_l(bi2, 300, &err);
+	ehbi_exp(bi3, bi1, bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_exp");
+	ehbi_to_decimal_string(bi3, buf, 250, &err);
+	failures += check_int_m(err, 0, "ehbi_to_decimal_string");
+	failures += check_str_m(buf,
+				"136891479058588375991326027382088315966463695"
+				"625337436471480190078368997177499076593800206"
+				"155688941388250484440597994042813512732765695"
+				"774566001", "3^300");
+
+	ehbi_set_l(bi1, 200, &err);
+	ehbi_set_l(bi2, 100, &err);
+	ehbi_n_choose_k(bi3, bi1, bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_n_choose_k");
+	failures +=
+	    Check_ehbigint_dec(bi3,
+			       "905485146561032811654041770774841638745045896"
+			       "75413336841320");
+
+	/* and shrinks back by division */
+	ehbi_div(bi1, bi2, bi3, bi3, &err);
+	failures += check_int_m(err, 0, "ehbi_div");
+	failures += Check_ehbigint_dec(bi1, "1");
+	failures += Check_ehbigint_dec(bi2, "0");
+
+test_growable_ops_end:
+	ehbi_free(bi1);
+	ehbi_free(bi2);
+	ehbi_free(bi3);
+
+	return failures;
+}
+
+unsigned test_growable(int v)
+{
+	unsigned failures = 0;
+
+	failures += test_growable_fixed_by_default(v);
+	failures += test_growable_ops(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_growable)
@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-import-export.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+#define TEST_WORDS_LEN 16
+
+struct test_words_row {
+	int order;
+	size_t size;
+	int endian;
+	size_t nails;
+	size_t count;
+	unsigned char data[TEST_WORDS_LEN];
+};
+
+static const char *test_words_hex = "0x0102030405060708090A";
+
+/* the words are as from mpz_export */
+static const struct test_words_row test_words_rows[] = {
+	{ 1, 4, 1, 0, 3,
+	 { 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+	  0x07, 0x08, 0x09, 0x0A } },
+	{ -1, 4, -1, 0, 3,
+	 { 0x0A, 0x09, 0x08, 0x07, 0x06, 0x05, 0x04, 0x03,
+	  0x02, 0x01, 0x00, 0x00 } },
+	{ -1, 4, 1, 0, 3,
+	 { 0x07, 0x08, 0x09, 0x0A, 0x03, 0x04, 0x05, 0x06,
+	  0x00, 0x00, 0x01, 0x02 } },
+	{ 1, 2, -1, 0, 5,
+	 { 0x02, 0x01, 0x04, 0x03, 0x06, 0x05, 0x08, 0x07,
+	  0x0A, 0x09 } },
+	{ 1, 8, 1, 4, 2,
+	 { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x20,
+	  0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A } },
+	{ -1, 1, -1, 1, 11,
+	 { 0x0A, 0x12, 0x20, 0x38, 0x60, 0x20, 0x01, 0x02,
+	  0x03, 0x04, 0x04 } },
+	{ 0, 0, 0, 0, 0, { 0x00 } }
+};
+
+unsigned test_words_row(int verbose, const struct test_words_row *row)
+{
+	int err;
+	unsigned failures;
+	size_t i, count;
+	unsigned char data[TEST_WORDS_LEN];
+	unsigned char bytes[TEST_WORDS_LEN];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, TEST_WORDS_LEN);
+	ehbi_import(&bi, row->count, row->order, row->size, row->endian,
+		    row->nails, row->data, &err);
+	failures += check_int_m(err, 0, "ehbi_import");
+	failures += Check_ehbigint_hex(&bi, test_words_hex);
+
+	count = ehbi_export_count(&bi, row->size, row->nails);
+	failures += check_int_m((int)count, (int)row->count, "export count");
+
+	ehbi_negate(&bi);
+	eembed_memset(data, 0xFF, TEST_WORDS_LEN);
+	ehbi_export(data, TEST_WORDS_LEN, &count, row->order, row->size,
+		    row->endian, row->nails, &bi, &err);
+	failures += check_int_m(err, 0, "ehbi_export");
+	failures += check_int_m((int)count, (int)row->count, "count");
+	for (i = 0; i < row->count * row->size; ++i) {
+		failures += check_int_m(data[i], row->data[i], "data");
+	}
+
+	if (failures) {
+		Test_log_error("words row");
+	}
+
+	return failures;
+}
+
+unsigned test_import_export_edges(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t count;
+	unsigned char data[TEST_WORDS_LEN];
+	unsigned char bytes1[TEST_WORDS_LEN], bytes2[2];
+	struct ehbigint bi, small;
+	const unsigned char nailed[] = { 0xAC, 0x82 };
+	const unsigned char wide_one[] = { 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x01
+	};
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes1, TEST_WORDS_LEN);
+	ehbi_init(&small, bytes2, 2);
+
+	/* the nail bits are ignored */
+	ehbi_import(&bi, 2, -1, 1, 0, 1, nailed, &err);
+	failures += check_int_m(err, 0, "nailed");
+	failures += Check_ehbigint_dec(&bi, "300");
+
+	/* high zero bytes need not fit */
+	ehbi_import(&small, 1, 1, 8, 1, 0, wide_one, &err);
+	failures += check_int_m(err, 0, "wide one");
+	failures += Check_ehbigint_dec(&small, "1");
+	ehbi_import(&small, 1, 1, 8, -1, 0, wide_one, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "too big");
+	err = 0;
+
+	/* the native byte order, both ways */
+	ehbi_set_hex_string(&bi, test_words_hex, 22, &err);
+	ehbi_export(data, TEST_WORDS_LEN, &count, 1, 4, 0, 0, &bi, &err);
+	ehbi_import(&bi, count, 1, 4, 0, 0, data, &err);
+	failures += check_int_m(err, 0, "native");
+	failures += Check_ehbigint_hex(&bi, test_words_hex);
+
+	/* zero is no words */
+	ehbi_zero(&bi);
+	ehbi_export(data, TEST_WORDS_LEN, &count, 1, 4, 1, 0, &bi, &err);
+	failures += check_int_m((int)count, 0, "zero count");
+	ehbi_import(&bi, 0, 1, 4, 1, 0, NULL, &err);
+	failures += check_int_m(err, 0, "zero");
+	failures += Check_ehbigint_dec(&bi, "0");
+
+	ehbi_set_hex_string(&bi, test_words_hex, 22, &err);
+	ehbi_export(data, 11, &count, 1, 4, 1, 0, &bi, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "data too small");
+	err = 0;
+	ehbi_export(data, TEST_WORDS_LEN, &count, 0, 4, 1, 0, &bi, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "order");
+	err = 0;
+	ehbi_import(&bi, 1, 1, 1, 1, 8, data, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "nails");
+
+	return failures;
+}
+
+unsigned test_import_export(int v)
+{
+	unsigned failures = 0;
+	size_t i;
+
+	for (i = 0; test_words_rows[i].size; ++i) {
+		failures += test_words_row(v, &test_words_rows[i]);
+	}
+	failures += test_import_export_edges(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_import_export)
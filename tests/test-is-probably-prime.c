@@ -89,6 +89,37 @@ unsigned test_is_probably_prime_s(int verbose, const char *val, int expected)
 	return failures;
 }
 
+/*
+   with more trials than small prime witnesses, random witnesses are drawn,
+   about one in 256 of these with a zero top byte, which must be trimmed
+*/
+unsigned test_is_probably_prime_random_witnesses(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t i;
+	unsigned char bytes[BILEN];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, BILEN);
+	ehbi_set_l(&bi, 16777213, &err);
+
+	for (i = 0; i < 2000; ++i) {
+		failures += check_int_m(ehbi_is_probably_prime(&bi, 25, &err),
+					1, "16777213");
+		failures += check_int_m(err, 0, "ehbi_is_probably_prime");
+		if (failures) {
+			break;
+		}
+	}
+
+	return failures;
+}
+
 unsigned test_is_probably_prime(int v)
 {
 	const char *Primes[] = {
@@ -143,6 +174,8 @@ unsigned test_is_probably_prime(int v)
 		failures += test_is_probably_prime_s(v, Composites[i], isprime);
 	}
 
+	failures += test_is_probably_prime_random_witnesses(v);
+
 	return failures;
 }
 
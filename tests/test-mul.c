@@ -96,6 +96,45 @@ unsigned test_mul_v(int verbose, long al, long bl, const char *expected)
 	return failures;
 }
 
+unsigned test_mul_aliased(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[16], bytes2[16];
+	struct ehbigint bi1, bi2, slice;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init_l(&bi1, bytes1, 16, 239862259L, &err);
+	ehbi_init_l(&bi2, bytes2, 16, -581571519L, &err);
+
+	ehbi_mul(&bi1, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "res == bi1");
+	failures += Check_ehbigint_dec(&bi1, "-139497058317401421");
+
+	ehbi_set_l(&bi1, 9415273, &err);
+	ehbi_mul(&bi2, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "res == bi2");
+	failures += Check_ehbigint_dec(&bi2, "-5475654620409687");
+
+	/* squaring in place */
+	ehbi_mul(&bi1, &bi1, &bi1, &err);
+	failures += check_int_m(err, 0, "res == bi1 == bi2");
+	failures += Check_ehbigint_dec(&bi1, "88647365664529");
+
+	/* a slice of the result is in part the same bytes */
+	ehbi_set_hex_string(&bi1, "0x0102030400000000", 18, &err);
+	ehbi_view_slice(&slice, &bi1, 4, 4, &err);
+	ehbi_set_l(&bi2, 3, &err);
+	ehbi_mul(&bi1, &slice, &bi2, &err);
+	failures += check_int_m(err, 0, "res overlaps slice");
+	failures += Check_ehbigint_hex(&bi1, "0x0306090C");
+
+	return failures;
+}
+
 unsigned test_mul(int v)
 {
 	unsigned failures = 0;
@@ -114,6 +153,8 @@ unsigned test_mul(int v)
 	failures += test_mul_v(v, 9415273, 252533, "2377667136509");
 	failures += test_mul_v(v, 239862259L, 581571519L, "139497058317401421");
 
+	failures += test_mul_aliased(v);
+
 	return failures;
 }
 
@@ -0,0 +1,134 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-parser.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+#define TEST_PARSER_LEN 40
+
+/* feeds the str "step" characters at a time */
+unsigned test_parser_steps(int verbose, unsigned radix, const char *str,
+			   size_t step, const char *expect_dec)
+{
+	int err;
+	unsigned failures;
+	size_t i, len, n;
+	unsigned char bytes[TEST_PARSER_LEN];
+	struct ehbigint bi;
+	struct ehbi_parser p;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, TEST_PARSER_LEN);
+	ehbi_parser_init(&p, &bi, radix, &err);
+	len = eembed_strlen(str);
+	for (i = 0; i < len; i += n) {
+		n = (len - i < step) ? (len - i) : step;
+		ehbi_parser_feed(&p, str + i, n, &err);
+	}
+	ehbi_parser_finish(&p, &err);
+	failures += check_int_m(err, 0, "ehbi_parser_finish");
+	failures += Check_ehbigint_dec(&bi, expect_dec);
+
+	if (failures) {
+		Test_log_error(str);
+	}
+
+	return failures;
+}
+
+unsigned test_parser_errors(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[BILEN], bytes2[2];
+	struct ehbigint bi, small;
+	struct ehbi_parser p;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes1, BILEN);
+	ehbi_init(&small, bytes2, 2);
+
+	/* errors are sticky */
+	ehbi_parser_init(&p, &bi, 10, &err);
+	ehbi_parser_feed(&p, "12", 2, &err);
+	ehbi_parser_feed(&p, "3x4", 3, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "not a digit");
+	err = 0;
+	ehbi_parser_feed(&p, "5", 1, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "feed after");
+	err = 0;
+	failures += check_int_m(ehbi_parser_finish(&p, &err) ? 1 : 0, 0,
+				"finish after");
+	failures += check_int_m(err, EHBI_BAD_INPUT, "finish err");
+	err = 0;
+
+	/* the sign and prefix only at the start */
+	ehbi_parser_init(&p, &bi, 16, &err);
+	ehbi_parser_feed(&p, "1-", 2, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "late sign");
+	err = 0;
+	ehbi_parser_init(&p, &bi, 16, &err);
+	ehbi_parser_feed(&p, "10x1", 4, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "late prefix");
+	err = 0;
+
+	/* nothing is zero */
+	ehbi_parser_init(&p, &bi, 10, &err);
+	ehbi_parser_feed(&p, "-", 1, &err);
+	ehbi_parser_finish(&p, &err);
+	failures += check_int_m(err, 0, "empty");
+	failures += Check_ehbigint_dec(&bi, "0");
+
+	ehbi_parser_init(&p, &small, 16, &err);
+	ehbi_parser_feed(&p, "0xFFFF", 6, &err);
+	ehbi_parser_finish(&p, &err);
+	failures += check_int_m(err, 0, "fits");
+	failures += Check_ehbigint_dec(&small, "65535");
+	ehbi_parser_init(&p, &small, 16, &err);
+	ehbi_parser_feed(&p, "1FFFF", 5, &err);
+	ehbi_parser_finish(&p, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "hex too small");
+	err = 0;
+	ehbi_parser_init(&p, &small, 10, &err);
+	ehbi_parser_feed(&p, "65536", 5, &err);
+	ehbi_parser_finish(&p, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "dec too small");
+	err = 0;
+
+	ehbi_parser_init(&p, &bi, 63, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "radix");
+
+	return failures;
+}
+
+unsigned test_parser(int v)
+{
+	unsigned failures = 0;
+	size_t step;
+	const char *dec = "-123456789012345678901234567890123456789";
+	const char *hex = "0x0123456789abcdefFEDCBA9876543210";
+
+	for (step = 1; step <= 5; ++step) {
+		failures += test_parser_steps(v, 10, dec, step, dec);
+		failures += test_parser_steps(v, 16, hex, step,
+					      "1512366075204170947332355369"
+					      "683137040");
+		failures += test_parser_steps(v, 2, "0b0001011011", step,
+					      "91");
+		failures += test_parser_steps(v, 36, "-EHBIGINT", step,
+					      "-1134799728761");
+	}
+	failures += test_parser_steps(v, 10, "000", 2, "0");
+	failures += test_parser_steps(v, 8, "-0", 1, "0");
+	failures += test_parser_errors(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_parser)
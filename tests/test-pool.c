@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-pool.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+#ifndef EHBI_SKIP_POOL
+#define TEST_POOL_NUM 10
+
+unsigned test_pool_reuse(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t i;
+	struct ehbigint *bis[TEST_POOL_NUM];
+	struct ehbi_pool_stats before, after;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_pool_stats(&before);
+	for (i = 0; i < TEST_POOL_NUM; ++i) {
+		bis[i] = ehbi_alloc_l(20, (long)i, &err);
+		failures += check_int_m(bis[i] ? 1 : 0, 1, "ehbi_alloc_l");
+	}
+	for (i = 0; i < TEST_POOL_NUM; ++i) {
+		ehbi_free(bis[i]);
+	}
+	ehbi_pool_stats(&after);
+	failures += check_int_m(after.bytes_cached > 0, 1, "bytes_cached");
+
+	/* the same size class again is served from the free list */
+	ehbi_pool_stats(&before);
+	for (i = 0; i < TEST_POOL_NUM; ++i) {
+		bis[i] = ehbi_alloc_l(24, (long)i, &err);
+		failures += check_int_m(bis[i] ? 1 : 0, 1, "ehbi_alloc_l");
+	}
+	ehbi_pool_stats(&after);
+	failures += check_int_m((int)(after.hits - before.hits),
+				TEST_POOL_NUM, "hits");
+	failures += check_int_m((int)(after.misses - before.misses), 0,
+				"misses");
+	for (i = 0; i < TEST_POOL_NUM; ++i) {
+		failures += check_int_m(ehbi_equals_l(bis[i], (long)i), 1,
+					"value");
+		ehbi_free(bis[i]);
+	}
+
+	ehbi_pool_release();
+	ehbi_pool_stats(&after);
+	failures += check_int_m(after.bytes_cached == 0, 1, "released");
+
+	return failures;
+}
+
+unsigned test_pool_growable(int verbose)
+{
+	int err;
+	unsigned failures;
+	struct ehbigint *bi1, *bi2;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	bi1 = ehbi_alloc_l(2, 3, &err);
+	bi2 = ehbi_alloc(2, &err);
+	if (!bi1 || !bi2) {
+		Test_log_error("ehbi_alloc failed");
+		failures = 1;
+		goto test_pool_growable_end;
+	}
+	ehbi_set_growable(bi2, 1);
+
+	/* grows out of the block shared with the struct, then reallocs */
+	ehbi_exp_l(bi2, bi1, 100, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_l");
+	failures += Check_ehbigint_dec(bi2,
+				       "515377520732011331036461129765621272702"
+				       "107522001");
+
+test_pool_growable_end:
+	ehbi_free(bi1);
+	ehbi_free(bi2);
+	ehbi_pool_release();
+
+	return failures;
+}
+
+unsigned test_pool(int v)
+{
+	unsigned failures = 0;
+	struct eembed_allocator *orig;
+
+	orig = eembed_global_allocator;
+	eembed_global_allocator = ehbi_pool_allocator();
+
+	failures += check_int_m(ehbi_pool_allocator() == eembed_global_allocator,
+				1, "ehbi_pool_allocator idempotent");
+
+	failures += test_pool_reuse(v);
+	failures += test_pool_growable(v);
+
+	eembed_global_allocator = orig;
+
+	return failures;
+}
+#else
+unsigned test_pool(int v)
+{
+	(void)v;
+	return 0;
+}
+#endif
+
+ECHECK_TEST_MAIN_V(test_pool)
@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-scratch.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+unsigned test_scratch_ops(int verbose, struct ehbi_scratch *s)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[20];
+	unsigned char bytes2[20];
+	unsigned char bytes3[20];
+	unsigned char bytes4[20];
+	struct ehbigint bi1, bi2, bi3, bi4;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+
+	err = 0;
+	ehbi_init(&bi1, bytes1, 20);
+	ehbi_init(&bi2, bytes2, 20);
+	ehbi_init(&bi3, bytes3, 20);
+	ehbi_init(&bi4, bytes4, 20);
+
+	ehbi_set_l(&bi1, 1000000007, &err);
+	ehbi_set_l(&bi2, -999999937, &err);
+
+	ehbi_add_x(&bi3, &bi1, &bi2, s, &err);
+	failures += check_int_m(err, 0, "ehbi_add_x");
+	failures += Check_ehbigint_dec(&bi3, "70");
+	failures += check_int_m(s->bytes_used, 0, "used after add");
+
+	ehbi_subtract_x(&bi3, &bi1, &bi2, s, &err);
+	failures += check_int_m(err, 0, "ehbi_subtract_x");
+	failures += Check_ehbigint_dec(&bi3, "1999999944");
+	failures += check_int_m(s->bytes_used, 0, "used after subtract");
+
+	ehbi_mul_x(&bi3, &bi1, &bi2, s, &err);
+	failures += check_int_m(err, 0, "ehbi_mul_x");
+	failures += Check_ehbigint_dec(&bi3, "-999999943999999559");
+	failures += check_int_m(s->bytes_used, 0, "used after mul");
+
+	ehbi_inc_x(&bi3, &bi1, s, &err);
+	failures += check_int_m(err, 0, "ehbi_inc_x");
+	ehbi_dec_x(&bi3, &bi2, s, &err);
+	failures += check_int_m(err, 0, "ehbi_dec_x");
+	failures += Check_ehbigint_dec(&bi3, "-999999941999999615");
+	failures += check_int_m(s->bytes_used, 0, "used after inc/dec");
+
+	ehbi_div_x(&bi2, &bi4, &bi3, &bi1, s, &err);
+	failures += check_int_m(err, 0, "ehbi_div_x");
+	failures += Check_ehbigint_dec(&bi2, "-999999935");
+	failures += check_int_m(s->bytes_used, 0, "used after div");
+
+	ehbi_sqrt_x(&bi3, &bi4, &bi1, s, &err);
+	failures += check_int_m(err, 0, "ehbi_sqrt_x");
+	failures += Check_ehbigint_dec(&bi3, "31622");
+	failures += Check_ehbigint_dec(&bi4, "49123");
+	failures += check_int_m(s->bytes_used, 0, "used after sqrt");
+
+	ehbi_set_l(&bi4, 20, &err);
+	ehbi_set_l(&bi2, 7, &err);
+	ehbi_exp_x(&bi3, &bi2, &bi4, s, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_x");
+	failures += Check_ehbigint_dec(&bi3, "79792266297612001");
+	failures += check_int_m(s->bytes_used, 0, "used after exp");
+
+	ehbi_exp_mod_x(&bi3, &bi2, &bi4, &bi1, s, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_mod_x");
+	failures += Check_ehbigint_dec(&bi3, "739066146");
+	failures += check_int_m(s->bytes_used, 0, "used after exp_mod");
+
+	ehbi_set_l(&bi2, 40, &err);
+	ehbi_set_l(&bi4, 20, &err);
+	ehbi_n_choose_k_x(&bi3, &bi2, &bi4, s, &err);
+	failures += check_int_m(err, 0, "ehbi_n_choose_k_x");
+	failures += Check_ehbigint_dec(&bi3, "137846528820");
+	failures += check_int_m(s->bytes_used, 0, "used after n_choose_k");
+
+#ifndef EHBI_SKIP_IS_PROBABLY_PRIME
+	failures += check_int_m(ehbi_is_probably_prime_x(&bi1, 10, s, &err), 1,
+				"ehbi_is_probably_prime_x");
+	failures += check_int_m(err, 0, "ehbi_is_probably_prime_x err");
+	failures += check_int_m(s->bytes_used, 0, "used after prime");
+#endif
+
+	failures += check_int_m(ehbi_scratch_peak(s) > 0, 1, "peak > 0");
+
+	return failures;
+}
+
+unsigned test_scratch_peak(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[20];
+	unsigned char bytes2[20];
+	unsigned char bytes3[20];
+	unsigned char tiny[8];
+	size_t peak;
+	struct ehbigint bi1, bi2, bi3;
+	struct ehbi_scratch small;
+	struct ehbi_scratch *big;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+
+	err = 0;
+	ehbi_init(&bi1, bytes1, 20);
+	ehbi_init(&bi2, bytes2, 20);
+	ehbi_init(&bi3, bytes3, 20);
+
+	ehbi_set_l(&bi1, 1234567, &err);
+	ehbi_set_l(&bi2, 89, &err);
+
+	/* too small: falls back to the stack, but still measures the peak */
+	ehbi_scratch_init(&small, tiny, 8);
+	ehbi_exp_x(&bi3, &bi1, &bi2, &small, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "exp overflow");
+	failures += check_int_m(small.bytes_used, 0, "used after error");
+
+	err = 0;
+	ehbi_scratch_reset(&small);
+	ehbi_set_l(&bi2, 3, &err);
+	ehbi_exp_x(&bi3, &bi1, &bi2, &small, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_x small");
+	failures += Check_ehbigint_dec(&bi3, "1881672302290562263");
+	failures += check_int_m(small.bytes_used, 0, "small used");
+	failures += check_int_m(small.bytes_spilled, 0, "small spilled");
+	peak = ehbi_scratch_peak(&small);
+	failures += check_int_m(peak > 8, 1, "small peak > len");
+
+	big = ehbi_scratch_alloc(peak, &err);
+	failures += check_int_m(err, 0, "ehbi_scratch_alloc");
+	if (!big) {
+		return failures + 1;
+	}
+	ehbi_exp_x(&bi3, &bi1, &bi2, big, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_x big");
+	failures += Check_ehbigint_dec(&bi3, "1881672302290562263");
+	failures += check_int_m(big->bytes_used, 0, "big used");
+	failures += check_int_m(big->bytes_spilled, 0, "big spilled");
+	failures += check_int_m(ehbi_scratch_peak(big) == peak, 1, "big peak");
+
+	ehbi_scratch_reset(big);
+	failures += check_int_m(ehbi_scratch_peak(big) == 0, 1, "reset peak");
+
+	failures += test_scratch_ops(verbose, big);
+
+	ehbi_scratch_free(big);
+
+	return failures;
+}
+
+unsigned test_scratch(int v)
+{
+	unsigned failures = 0;
+	unsigned char bytes[8];
+	struct ehbi_scratch small;
+
+	ehbi_scratch_init(&small, bytes, 8);
+	failures += test_scratch_ops(v, &small);
+
+	failures += test_scratch_peak(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_scratch)
@@ -0,0 +1,244 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-serialize.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+#define TEST_SERIAL_LEN 200
+
+unsigned test_serialize_round_trip(int verbose, const char *hex, int negative)
+{
+	int err;
+	unsigned failures;
+	size_t size, written, used;
+	unsigned char buf[TEST_SERIAL_LEN + 4];
+	unsigned char bytes1[TEST_SERIAL_LEN], bytes2[TEST_SERIAL_LEN];
+	struct ehbigint bi, out;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes1, TEST_SERIAL_LEN);
+	ehbi_init(&out, bytes2, TEST_SERIAL_LEN);
+	ehbi_set_hex_string(&bi, hex, eembed_strlen(hex), &err);
+	if (negative) {
+		ehbi_negate(&bi);
+	}
+	failures += check_int_m(err, 0, "setup");
+
+	size = ehbi_serialized_size(&bi);
+	written = ehbi_serialize(&bi, buf, sizeof(buf), &err);
+	failures += check_int_m(err, 0, "ehbi_serialize");
+	failures += check_int_m((int)written, (int)size, "serialized size");
+
+	ehbi_deserialize(&out, buf, written, &used, &err);
+	failures += check_int_m(err, 0, "ehbi_deserialize");
+	failures += check_int_m((int)used, (int)written, "used");
+	failures += check_int_m(ehbi_equals(&out, &bi), 1, "equals");
+	failures += check_int_m(ehbi_is_negative(&out), ehbi_is_negative(&bi),
+				"sign");
+
+	/* one byte short is an error, not a smaller value */
+	ehbi_deserialize(&out, buf, written - 1, NULL, &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "truncated");
+	err = 0;
+	ehbi_serialize(&bi, buf, written - 1, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "too small");
+
+	if (failures) {
+		Test_log_error(hex);
+	}
+
+	return failures;
+}
+
+unsigned test_serialize_format(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t i, used;
+	unsigned char buf[TEST_SERIAL_LEN];
+	unsigned char bytes[TEST_SERIAL_LEN];
+	struct ehbigint bi;
+	const unsigned char neg_258[] = { 0x11, 0x02, 0x02, 0x01 };
+	const unsigned char zero[] = { 0x10, 0x00 };
+	const unsigned char padded[] = { 0x11, 0x03, 0x07, 0x00, 0x00 };
+	const unsigned char neg_zero[] = { 0x11, 0x01, 0x00 };
+	const unsigned char version_2[] = { 0x20, 0x01, 0x07 };
+	const unsigned char long_count[] = { 0x10, 0x80, 0x80 };
+	const unsigned char huge_count[] = { 0x10, 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F
+	};
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, TEST_SERIAL_LEN);
+
+	ehbi_set_l(&bi, -258, &err);
+	failures += check_int_m((int)ehbi_serialize(&bi, buf, 4, &err), 4, "4");
+	for (i = 0; i < 4; ++i) {
+		failures += check_int_m(buf[i], neg_258[i], "-258");
+	}
+
+	ehbi_zero(&bi);
+	failures += check_int_m((int)ehbi_serialize(&bi, buf, 2, &err), 2, "2");
+	failures += check_int_m(buf[0], zero[0], "zero[0]");
+	failures += check_int_m(buf[1], zero[1], "zero[1]");
+
+	/* a count of 128 takes two bytes */
+	for (i = 0; i < 128; ++i) {
+		buf[i] = 0xFF;
+	}
+	ehbi_set_big_endian(&bi, buf, 128, &err);
+	failures += check_int_m((int)ehbi_serialize(&bi, buf, 131, &err), 131,
+				"131");
+	failures += check_int_m(buf[1], 0x80, "varint[0]");
+	failures += check_int_m(buf[2], 0x01, "varint[1]");
+	failures += check_int_m(err, 0, "err");
+
+	/* leading zeros and a negative zero are read as normal values */
+	ehbi_deserialize(&bi, padded, sizeof(padded), &used, &err);
+	failures += check_int_m(err, 0, "padded");
+	failures += Check_ehbigint_dec(&bi, "-7");
+	failures += check_int_m((int)used, (int)sizeof(padded), "padded used");
+	ehbi_deserialize(&bi, neg_zero, sizeof(neg_zero), NULL, &err);
+	failures += check_int_m(err, 0, "negative zero");
+	failures += check_int_m(ehbi_is_negative(&bi), 0, "not negative");
+
+	ehbi_deserialize(&bi, version_2, sizeof(version_2), NULL, &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "version");
+	err = 0;
+	ehbi_deserialize(&bi, long_count, sizeof(long_count), NULL, &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "varint");
+	err = 0;
+	ehbi_deserialize(&bi, huge_count, sizeof(huge_count), NULL, &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "varint overflow");
+
+	return failures;
+}
+
+unsigned test_serialize_sequence(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t pos, used;
+	unsigned char buf[TEST_SERIAL_LEN];
+	unsigned char bytes[BILEN];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, BILEN);
+
+	pos = 0;
+	ehbi_set_l(&bi, 1000000, &err);
+	pos += ehbi_serialize(&bi, buf + pos, sizeof(buf) - pos, &err);
+	ehbi_set_l(&bi, -3, &err);
+	pos += ehbi_serialize(&bi, buf + pos, sizeof(buf) - pos, &err);
+	failures += check_int_m(err, 0, "write");
+
+	ehbi_deserialize(&bi, buf, pos, &used, &err);
+	failures += Check_ehbigint_dec(&bi, "1000000");
+	ehbi_deserialize(&bi, buf + used, pos - used, &used, &err);
+	failures += Check_ehbigint_dec(&bi, "-3");
+	failures += check_int_m(err, 0, "read");
+
+	return failures;
+}
+
+unsigned test_serialize_batch(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t size, written, count;
+	unsigned char buf[TEST_SERIAL_LEN];
+	unsigned char bytes1[BILEN], bytes2[BILEN], bytes3[BILEN];
+	unsigned char bytes4[BILEN];
+	struct ehbigint a, b, c, out;
+	const struct ehbigint *bis[3];
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init_l(&a, bytes1, BILEN, -12345, &err);
+	ehbi_init_l(&b, bytes2, BILEN, 0, &err);
+	ehbi_init(&c, bytes3, BILEN);
+	ehbi_init(&out, bytes4, BILEN);
+	ehbi_set_hex_string(&c, "0x0123456789ABCDEF", 18, &err);
+	bis[0] = &a;
+	bis[1] = &b;
+	bis[2] = &c;
+
+	size = ehbi_serialized_batch_size(bis, 3);
+	written = ehbi_serialize_batch(bis, 3, buf, sizeof(buf), &err);
+	failures += check_int_m(err, 0, "ehbi_serialize_batch");
+	failures += check_int_m((int)written, (int)size, "size");
+	count = ehbi_serialized_batch_count(buf, written, &err);
+	failures += check_int_m((int)count, 3, "count");
+
+	/* in any order */
+	ehbi_deserialize_batch(&out, buf, written, 2, &err);
+	failures += Check_ehbigint_hex(&out, "0x0123456789ABCDEF");
+	ehbi_deserialize_batch(&out, buf, written, 0, &err);
+	failures += Check_ehbigint_dec(&out, "-12345");
+	ehbi_deserialize_batch(&out, buf, written, 1, &err);
+	failures += Check_ehbigint_dec(&out, "0");
+	failures += check_int_m(err, 0, "ehbi_deserialize_batch");
+
+	ehbi_deserialize_batch(&out, buf, written, 3, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "index");
+	err = 0;
+	ehbi_deserialize_batch(&out, buf, written - 1, 2, &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "truncated");
+	err = 0;
+
+	/* a batch is not a single value, nor the other way around */
+	ehbi_deserialize(&out, buf, written, NULL, &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "not single");
+	err = 0;
+	ehbi_serialize(&a, buf, sizeof(buf), &err);
+	ehbi_serialized_batch_count(buf, sizeof(buf), &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "not batch");
+	err = 0;
+
+	ehbi_serialize_batch(bis, 3, buf, size - 1, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "too small");
+	err = 0;
+
+	written = ehbi_serialize_batch(NULL, 0, buf, sizeof(buf), &err);
+	count = ehbi_serialized_batch_count(buf, written, &err);
+	failures += check_int_m((int)count, 0, "empty");
+	failures += check_int_m(err, 0, "empty err");
+
+	return failures;
+}
+
+unsigned test_serialize(int v)
+{
+	unsigned failures = 0;
+
+	failures += test_serialize_round_trip(v, "0x00", 0);
+	failures += test_serialize_round_trip(v, "0x01", 1);
+	failures += test_serialize_round_trip(v, "0xFF", 0);
+	failures += test_serialize_round_trip(v, "0x0100", 1);
+	failures +=
+	    test_serialize_round_trip(v,
+				      "0x0123456789ABCDEF0123456789ABCDEF"
+				      "0123456789ABCDEF0123456789ABCDEF"
+				      "0123456789ABCDEF0123456789ABCDEF"
+				      "0123456789ABCDEF0123456789ABCDEF"
+				      "0123456789ABCDEF0123456789ABCDEF", 1);
+	failures += test_serialize_format(v);
+	failures += test_serialize_sequence(v);
+	failures += test_serialize_batch(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_serialize)
@@ -172,6 +172,57 @@ unsigned test_set_too_small(int verbose)
 	return failures;
 }
 
+unsigned test_set_big_endian(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes[10];
+	unsigned char be[4] = { 0x00, 0x01, 0x00, 0x45 };
+	unsigned char seven[1] = { 0x07 };
+	unsigned char out[6];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+
+	err = 0;
+	ehbi_init(&bi, bytes, 10);
+
+	ehbi_set_big_endian(&bi, be, 4, &err);
+	failures += check_int_m(err, 0, "ehbi_set_big_endian");
+	failures += check_int_m(bi.bytes_used, 3, "bytes_used");
+	failures += Check_ehbigint_hex(&bi, "0x010045");
+
+	/* internally, the least significant byte is first */
+	failures += check_int_m(bi.bytes[0], 0x45, "bytes[0]");
+	failures += check_int_m(bi.bytes[2], 0x01, "bytes[2]");
+
+	eembed_memset(out, 0xFF, 6);
+	ehbi_to_big_endian(&bi, out, 6, &err);
+	failures += check_int_m(err, 0, "ehbi_to_big_endian");
+	failures += check_int_m(out[0], 0x00, "out[0]");
+	failures += check_int_m(out[2], 0x00, "out[2]");
+	failures += check_int_m(out[3], 0x01, "out[3]");
+	failures += check_int_m(out[4], 0x00, "out[4]");
+	failures += check_int_m(out[5], 0x45, "out[5]");
+
+	ehbi_to_big_endian(&bi, out, 2, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "too small");
+	err = 0;
+
+	/* a shorter value over a longer one */
+	ehbi_set_big_endian(&bi, seven, 1, &err);
+	failures += check_int_m(bi.bytes_used, 1, "bytes_used");
+	failures += Check_ehbigint_dec(&bi, "7");
+
+	ehbi_set_l(&bi, -256, &err);
+	ehbi_inc_l(&bi, 1, &err);
+	failures += check_int_m(err, 0, "ehbi_inc_l");
+	failures += Check_ehbigint_dec(&bi, "-255");
+
+	return failures;
+}
+
 unsigned test_set(int v)
 {
 	unsigned failures = 0;
@@ -184,6 +235,8 @@ unsigned test_set(int v)
 
 	failures += test_set_too_small(v);
 
+	failures += test_set_big_endian(v);
+
 	return failures;
 }
 
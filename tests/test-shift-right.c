@@ -76,6 +76,9 @@ unsigned test_shift_right(int v)
 	failures += test_shift_right_v(v, "0x17000000", 20, "0x0170");
 	failures += test_shift_right_v(v, "0x00FF000000", 24, "0x00FF");
 	failures += test_shift_right_v(v, "0x03A8F057", 1, "0x01D4782B");
+	failures += test_shift_right_v(v, "0x03A8F057", 13, "0x1D47");
+	failures += test_shift_right_v(v, "0x03A8F057", 26, "0x00");
+	failures += test_shift_right_v(v, "0x03A8F057", 200, "0x00");
 
 	return failures;
 }
@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-sizes.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+unsigned test_sizes_arithmetic(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t size;
+	unsigned char ones[8] = { 0xFF, 0xFF, 0xFF, 0xFF,
+		0xFF, 0xFF, 0xFF, 0xFF
+	};
+	unsigned char bytes1[BILEN], bytes2[BILEN];
+	struct ehbigint bi1, bi2;
+	struct ehbigint *result;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi1, bytes1, BILEN);
+	ehbi_init(&bi2, bytes2, BILEN);
+	ehbi_set_big_endian(&bi1, ones, 8, &err);
+	ehbi_set_l(&bi2, 1, &err);
+	failures += check_int_m(err, 0, "setup");
+
+	/* the carry out of 2^64-1 needs the extra byte */
+	size = ehbi_add_size(&bi1, &bi2);
+	failures += check_int_m((int)size, 9, "ehbi_add_size");
+	result = ehbi_alloc(size, &err);
+	ehbi_add(result, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_add");
+	failures += Check_ehbigint_hex(result, "0x010000000000000000");
+	ehbi_free(result);
+
+	/* (2^64-1)^2 needs exactly 16 bytes */
+	size = ehbi_mul_size(&bi1, &bi1);
+	failures += check_int_m((int)size, 16, "ehbi_mul_size");
+	result = ehbi_alloc(size, &err);
+	ehbi_mul(result, &bi1, &bi1, &err);
+	failures += check_int_m(err, 0, "ehbi_mul");
+	failures += check_int_m((int)result->bytes_used, 16, "mul used");
+	ehbi_free(result);
+
+	ehbi_set_l(&bi1, 3, &err);
+	size = ehbi_exp_size_l(&bi1, 100, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_size_l");
+	result = ehbi_alloc(size, &err);
+	ehbi_exp_l(result, &bi1, 100, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_l");
+	failures += Check_ehbigint_dec(result,
+				       "515377520732011331036461129765621272702"
+				       "107522001");
+	failures += check_int_m(size - result->bytes_used <= 2, 1, "tight");
+	ehbi_free(result);
+
+	ehbi_set_l(&bi2, 100, &err);
+	size = ehbi_exp_size(&bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_size");
+	failures += check_int_m((int)size,
+				(int)ehbi_exp_size_l(&bi1, 100, &err), "same");
+
+	ehbi_set_l(&bi1, 0, &err);
+	size = ehbi_exp_size_l(&bi1, 1000000L, &err);
+	failures += check_int_m((int)size, 1, "zero to a power");
+
+	size = ehbi_exp_size_l(&bi1, -1, &err);
+	failures += check_int_m((int)size, 0, "negative exponent");
+	failures += check_int_m(err, EHBI_BAD_DATA, "negative exponent err");
+
+	return failures;
+}
+
+unsigned test_sizes_n_choose_k(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t size;
+	unsigned char bytes1[BILEN], bytes2[BILEN];
+	struct ehbigint n, k;
+	struct ehbigint *result;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init_l(&n, bytes1, BILEN, 52, &err);
+	ehbi_init_l(&k, bytes2, BILEN, 26, &err);
+	size = ehbi_n_choose_k_size_bound(&n, &k, &err);
+	failures += check_int_m(err, 0, "ehbi_n_choose_k_size_bound");
+	result = ehbi_alloc(size, &err);
+	ehbi_n_choose_k(result, &n, &k, &err);
+	failures += check_int_m(err, 0, "ehbi_n_choose_k 52 26");
+	failures += Check_ehbigint_dec(result, "495918532948104");
+	ehbi_free(result);
+
+	/* by symmetry, only two terms */
+	ehbi_set_l(&n, 1000, &err);
+	ehbi_set_l(&k, 998, &err);
+	size = ehbi_n_choose_k_size_bound(&n, &k, &err);
+	failures += check_int_m((int)size, 3, "ehbi_n_choose_k_size_bound");
+	result = ehbi_alloc(size, &err);
+	ehbi_n_choose_k(result, &n, &k, &err);
+	failures += check_int_m(err, 0, "ehbi_n_choose_k 1000 998");
+	failures += Check_ehbigint_dec(result, "499500");
+	ehbi_free(result);
+
+	return failures;
+}
+
+unsigned test_sizes_strings(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t size, len;
+	char buf[BUFLEN];
+	const char *dec = "-1949183158370983519073011571092751";
+	const char *nines = "999999999999999999999999999999";
+	struct ehbigint *bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	len = eembed_strlen(dec);
+	size = ehbi_from_decimal_size(len);
+	bi = ehbi_alloc(size, &err);
+	ehbi_set_decimal_string(bi, dec, len, &err);
+	failures += check_int_m(err, 0, "ehbi_set_decimal_string");
+
+	size = ehbi_decimal_string_len(bi);
+	failures += check_int_m(size <= BUFLEN, 1, "decimal fits buf");
+	ehbi_to_decimal_string(bi, buf, size, &err);
+	failures += check_int_m(err, 0, "ehbi_to_decimal_string");
+	failures += check_str_m(buf, dec, "decimal");
+
+	size = ehbi_hex_string_len(bi);
+	ehbi_to_hex_string(bi, buf, size, &err);
+	failures += check_int_m(err, 0, "ehbi_to_hex_string");
+	failures += check_str_m(buf, "0x601A2676EB5ADE7448975D6BED0F",
+				"hex");
+	ehbi_free(bi);
+
+	len = eembed_strlen(nines);
+	size = ehbi_from_decimal_size(len);
+	bi = ehbi_alloc(size, &err);
+	ehbi_set_decimal_string(bi, nines, len, &err);
+	failures += check_int_m(err, 0, "nines");
+	failures += check_int_m(size - bi->bytes_used <= 1, 1, "tight");
+	ehbi_free(bi);
+
+	len = eembed_strlen("0x00000102");
+	size = ehbi_from_hex_size(len);
+	bi = ehbi_alloc(size, &err);
+	ehbi_set_hex_string(bi, "0x00000102", len, &err);
+	failures += check_int_m(err, 0, "leading zeros");
+	failures += check_int_m((int)bi->bytes_used, 2, "leading zeros used");
+
+	size = ehbi_binary_string_len(bi);
+	ehbi_to_binary_string(bi, buf, size, &err);
+	failures += check_int_m(err, 0, "ehbi_to_binary_string");
+	failures += check_str_m(buf, "0b0000000100000010", "binary");
+
+	/* "258", with room for a sign and the NULL */
+	size = ehbi_decimal_string_len(bi);
+	failures += check_int_m((int)size, 5, "decimal len");
+	ehbi_to_decimal_string(bi, buf, size, &err);
+	failures += check_str_m(buf, "258", "decimal");
+	ehbi_free(bi);
+
+	return failures;
+}
+
+unsigned test_sizes(int v)
+{
+	unsigned failures = 0;
+
+	failures += test_sizes_arithmetic(v);
+	failures += test_sizes_n_choose_k(v);
+	failures += test_sizes_strings(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_sizes)
@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-string-radix.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+#define TEST_RADIX_LEN 80
+
+struct test_string_radix_row {
+	unsigned radix;
+	const char *str;
+	const char *dec;
+};
+
+/* the expected strings are as from mpz_get_str, with upper case to 36 */
+static const struct test_string_radix_row test_string_radix_rows[] = {
+	{ 2, "101101",
+	  "45" },
+	{ 3, "11112220022122120101211020120210210211222",
+	  "18446744073709551617" },
+	{ 7, "-21653251153414601406403630240331250",
+	  "-123456789012345678901234567890" },
+	{ 8, "17777777777777777777777",
+	  "147573952589676412927" },
+	{ 16, "123456789ABCDEF0123",
+	  "5373003642731685151011" },
+	{ 32, "VVVVVVVVVVVVVVVVVVVV",
+	  "1267650600228229401496703205375" },
+	{ 36, "-10000000000000000000Z",
+	  "-13367494538843734067838845976611" },
+	{ 36, "0",
+	  "0" },
+	{ 62, "BP4biDE7quFXfAgmULag6MxClGiCLn9pHd",
+	  "1606938044258990275541962092341162602522202993782792835313721" },
+	{ 10, "10000000000000000000000000000000000000000",
+	  "10000000000000000000000000000000000000000" },
+	{ 4, "30000000000000000000000000000000",
+	  "13835058055282163712" },
+	{ 60, "x000000000001",
+	  "128430157824000000000001" },
+	{ 0, NULL, NULL }
+};
+
+unsigned test_string_radix_row(int verbose,
+			       const struct test_string_radix_row *row)
+{
+	int err;
+	unsigned failures;
+	char buf[TEST_RADIX_LEN];
+	unsigned char bytes[TEST_RADIX_LEN];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, TEST_RADIX_LEN);
+	ehbi_set_string_radix(&bi, row->str, eembed_strlen(row->str),
+			      row->radix, &err);
+	failures += check_int_m(err, 0, "ehbi_set_string_radix");
+	failures += Check_ehbigint_dec(&bi, row->dec);
+
+	ehbi_to_string_radix(&bi, buf, TEST_RADIX_LEN, row->radix, &err);
+	failures += check_int_m(err, 0, "ehbi_to_string_radix");
+	failures += check_str_m(buf, row->str, "ehbi_to_string_radix");
+
+	/* the length is enough, if not always exact */
+	failures += check_int_m(ehbi_string_radix_len(&bi, row->radix)
+				> eembed_strlen(buf), 1,
+				"ehbi_string_radix_len");
+
+	if (failures) {
+		Test_log_error(row->str);
+	}
+
+	return failures;
+}
+
+unsigned test_string_radix_digits(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[BILEN], bytes2[1];
+	struct ehbigint bi, small;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes1, BILEN);
+	ehbi_init(&small, bytes2, 1);
+
+	/* to radix 36 the case does not matter */
+	ehbi_set_string_radix(&bi, "ehbigint", 8, 36, &err);
+	failures += check_int_m(err, 0, "lower case 36");
+	failures += Check_ehbigint_dec(&bi, "1134799728761");
+	ehbi_set_string_radix(&bi, "-00abcDEF", 9, 16, &err);
+	failures += check_int_m(err, 0, "mixed case 16");
+	failures += Check_ehbigint_dec(&bi, "-11259375");
+
+	/* above 36 the lower case letters follow the upper */
+	ehbi_set_string_radix(&bi, "zZ", 2, 62, &err);
+	failures += check_int_m(err, 0, "62");
+	failures += Check_ehbigint_dec(&bi, "3817");
+
+	/* the top digit's high bits need no room */
+	ehbi_set_string_radix(&small, "7V", 2, 32, &err);
+	failures += check_int_m(err, 0, "fits");
+	failures += Check_ehbigint_dec(&small, "255");
+	ehbi_set_string_radix(&small, "100000000", 9, 2, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "shift too small");
+	err = 0;
+	ehbi_set_string_radix(&small, "256", 3, 10, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "chunk too small");
+	err = 0;
+
+	ehbi_set_string_radix(&bi, "12", 2, 2, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "not a digit");
+	err = 0;
+	ehbi_set_string_radix(&bi, "z", 1, 36, &err);
+	failures += check_int_m(err, 0, "z in 36");
+	ehbi_set_string_radix(&bi, "z", 1, 62, &err);
+	failures += check_int_m(err, 0, "z in 62");
+	ehbi_set_string_radix(&bi, "z", 1, 61, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "z in 61");
+	err = 0;
+	ehbi_set_string_radix(&bi, "1", 1, 63, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "radix 63");
+	err = 0;
+	ehbi_set_string_radix(&bi, "1", 1, 1, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "radix 1");
+
+	return failures;
+}
+
+unsigned test_string_radix_buf(int verbose)
+{
+	int err;
+	unsigned failures;
+	char buf[10];
+	unsigned char bytes[BILEN];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, BILEN);
+	ehbi_set_l(&bi, -255, &err);
+
+	/* "-11111111" and the NULL fill the buf exactly */
+	ehbi_to_string_radix(&bi, buf, 10, 2, &err);
+	failures += check_int_m(err, 0, "exact");
+	failures += check_str_m(buf, "-11111111", "exact");
+	ehbi_to_string_radix(&bi, buf, 9, 2, &err);
+	failures += check_int_m(err, EHBI_STRING_BUF_TOO_SMALL, "short");
+	failures += check_str_m(buf, "", "short");
+	err = 0;
+
+	ehbi_to_string_radix(&bi, buf, 4, 10, &err);
+	failures += check_int_m(err, EHBI_STRING_BUF_TOO_SMALL, "short 10");
+	err = 0;
+	ehbi_to_string_radix(&bi, buf, 5, 10, &err);
+	failures += check_str_m(buf, "-255", "exact 10");
+
+	ehbi_to_string_radix(&bi, buf, 10, 0, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "radix 0");
+	failures += check_int_m((int)ehbi_string_radix_len(&bi, 0), 0,
+				"len radix 0");
+
+	return failures;
+}
+
+unsigned test_string_radix(int v)
+{
+	unsigned failures = 0;
+	size_t i;
+
+	for (i = 0; test_string_radix_rows[i].str; ++i) {
+		failures +=
+		    test_string_radix_row(v, &test_string_radix_rows[i]);
+	}
+	failures += test_string_radix_digits(v);
+	failures += test_string_radix_buf(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_string_radix)
@@ -196,6 +196,47 @@ unsigned test_subtract_l(int verbose, const char *str_1, long l,
 	return failures;
 }
 
+unsigned test_subtract_aliased(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[BILEN], bytes2[BILEN];
+	struct ehbigint bi1, bi2;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi1, bytes1, BILEN);
+	ehbi_init(&bi2, bytes2, BILEN);
+	ehbi_set_hex_string(&bi1, "0x0100000000", 12, &err);
+	ehbi_set_l(&bi2, 1, &err);
+
+	/* the result as the first operand, borrowing through every byte */
+	ehbi_subtract(&bi1, &bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "res == bi1");
+	failures += Check_ehbigint_hex(&bi1, "0xFFFFFFFF");
+
+	/* the result as the second operand */
+	ehbi_subtract(&bi2, &bi2, &bi1, &err);
+	failures += check_int_m(err, 0, "res == bi2");
+	failures += Check_ehbigint_dec(&bi2, "-4294967294");
+
+	/* x - x */
+	ehbi_subtract(&bi2, &bi2, &bi2, &err);
+	failures += check_int_m(err, 0, "res == bi1 == bi2");
+	failures += check_int_m(ehbi_is_zero(&bi2), 1, "zero");
+	failures += check_int_m(ehbi_is_negative(&bi2), 0, "not negative");
+
+	/* ehbi_dec works in place */
+	ehbi_set_l(&bi2, 65535, &err);
+	ehbi_dec(&bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_dec");
+	failures += Check_ehbigint_hex(&bi1, "0xFFFF0000");
+
+	return failures;
+}
+
 unsigned test_subtract(int v)
 {
 	unsigned failures = 0;
@@ -213,6 +254,8 @@ unsigned test_subtract(int v)
 
 	failures += test_subtract_l(v, "35813", 65521, "-29708");
 
+	failures += test_subtract_aliased(v);
+
 	return failures;
 }
 
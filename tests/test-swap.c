@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-swap.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+unsigned test_swap_in_place(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[BILEN], bytes2[BILEN], bytes3[2];
+	struct ehbigint bi1, bi2, bi3;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init_l(&bi1, bytes1, BILEN, -7, &err);
+	ehbi_init(&bi2, bytes2, BILEN);
+	ehbi_set_hex_string(&bi2, "0x010203040506", 14, &err);
+	failures += check_int_m(err, 0, "setup");
+
+	ehbi_swap(&bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_swap");
+	failures += check_int_m(bi1.bytes == bytes1, 1, "bytes stay");
+	failures += Check_ehbigint_hex(&bi1, "0x010203040506");
+	failures += Check_ehbigint_dec(&bi2, "-7");
+
+	ehbi_swap(&bi1, &bi2, &err);
+	failures += Check_ehbigint_dec(&bi1, "-7");
+	failures += Check_ehbigint_hex(&bi2, "0x010203040506");
+
+	/* a fixed size which can not hold the other is an error */
+	ehbi_init_l(&bi3, bytes3, 2, 5, &err);
+	ehbi_swap(&bi3, &bi2, &err);
+	failures += check_int_m(err, EHBI_BYTES_TOO_SMALL, "too small");
+	failures += Check_ehbigint_dec(&bi3, "5");
+	err = 0;
+
+	ehbi_move(&bi1, &bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_move");
+	failures += Check_ehbigint_hex(&bi1, "0x010203040506");
+	failures += check_int_m(ehbi_is_zero(&bi2), 1, "moved from");
+
+	return failures;
+}
+
+unsigned test_swap_heap(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char *bytes1, *bytes2;
+	struct ehbigint *bi1, *bi2;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	bi1 = ehbi_alloc(1, &err);
+	bi2 = ehbi_alloc(1, &err);
+	if (!bi1 || !bi2) {
+		Test_log_error("ehbi_alloc failed");
+		failures = 1;
+		goto test_swap_heap_end;
+	}
+	ehbi_set_growable(bi1, 1);
+	ehbi_set_growable(bi2, 1);
+
+	/* growing puts the byte[]s on the heap on their own */
+	ehbi_set_decimal_string(bi1, "-123456789012345678901234567890", 31,
+				&err);
+	ehbi_set_decimal_string(bi2, "98765432109876543210", 20, &err);
+	failures += check_int_m(err, 0, "setup");
+	bytes1 = bi1->bytes;
+	bytes2 = bi2->bytes;
+
+	ehbi_swap(bi1, bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_swap");
+	failures += check_int_m(bi1->bytes == bytes2, 1, "exchanged 1");
+	failures += check_int_m(bi2->bytes == bytes1, 1, "exchanged 2");
+	failures += Check_ehbigint_dec(bi1, "98765432109876543210");
+	failures += Check_ehbigint_dec(bi2, "-123456789012345678901234567890");
+
+	ehbi_move(bi1, bi2, &err);
+	failures += check_int_m(err, 0, "ehbi_move");
+	failures += check_int_m(bi1->bytes == bytes1, 1, "moved");
+	failures += Check_ehbigint_dec(bi1, "-123456789012345678901234567890");
+	failures += check_int_m(ehbi_is_zero(bi2), 1, "moved from");
+
+test_swap_heap_end:
+	ehbi_free(bi1);
+	ehbi_free(bi2);
+
+	return failures;
+}
+
+unsigned test_swap(int v)
+{
+	unsigned failures = 0;
+
+	failures += test_swap_in_place(v);
+	failures += test_swap_heap(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_swap)
@@ -0,0 +1,205 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-thread-cache.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+#ifndef EHBI_SKIP_THREAD_CACHE
+
+#define TEST_CACHE_BYTES 256
+
+static unsigned long test_allocator_calls = 0;
+
+static void *test_counting_malloc(struct eembed_allocator *ea, size_t size)
+{
+	struct eembed_allocator *orig = (struct eembed_allocator *)ea->context;
+	++test_allocator_calls;
+	return orig->malloc(orig, size);
+}
+
+static void *test_counting_calloc(struct eembed_allocator *ea, size_t nmemb,
+				  size_t size)
+{
+	struct eembed_allocator *orig = (struct eembed_allocator *)ea->context;
+	++test_allocator_calls;
+	return orig->calloc(orig, nmemb, size);
+}
+
+static void *test_counting_realloc(struct eembed_allocator *ea, void *ptr,
+				   size_t size)
+{
+	struct eembed_allocator *orig = (struct eembed_allocator *)ea->context;
+	++test_allocator_calls;
+	return orig->realloc(orig, ptr, size);
+}
+
+static void test_counting_free(struct eembed_allocator *ea, void *ptr)
+{
+	struct eembed_allocator *orig = (struct eembed_allocator *)ea->context;
+	++test_allocator_calls;
+	orig->free(orig, ptr);
+}
+
+unsigned test_thread_cache_steady_state(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t i, cache_size;
+	char hex[2 + (2 * 200) + 1];
+	unsigned char bytes1[TEST_CACHE_BYTES];
+	unsigned char bytes2[TEST_CACHE_BYTES];
+	unsigned char bytes3[TEST_CACHE_BYTES];
+	unsigned char bytes4[TEST_CACHE_BYTES];
+	unsigned char bytes5[TEST_CACHE_BYTES];
+	struct ehbigint numer, denom, quot, rem, expect;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&numer, bytes1, TEST_CACHE_BYTES);
+	ehbi_init(&denom, bytes2, TEST_CACHE_BYTES);
+	ehbi_init(&quot, bytes3, TEST_CACHE_BYTES);
+	ehbi_init(&rem, bytes4, TEST_CACHE_BYTES);
+	ehbi_init(&expect, bytes5, TEST_CACHE_BYTES);
+
+	/* 200 bytes is bigger than the stack buffers of the temporaries */
+	hex[0] = '0';
+	hex[1] = 'x';
+	for (i = 2; i < (2 + (2 * 200)); ++i) {
+		hex[i] = 'F';
+	}
+	hex[i] = '\0';
+	ehbi_set_hex_string(&numer, hex, i, &err);
+	ehbi_negate(&numer);
+	/* wider than a word, so that long division needs the temporaries */
+	ehbi_set_hex_string(&denom, "0x0100000000000000010001", 24, &err);
+	failures += check_int_m(err, 0, "setup");
+
+	/* the first call records the peak, the next sizes the cache to it */
+	ehbi_div(&expect, &rem, &numer, &denom, &err);
+	failures += check_int_m(err, 0, "first ehbi_div");
+	ehbi_div(&quot, &rem, &numer, &denom, &err);
+	failures += check_int_m(err, 0, "warm ehbi_div");
+	cache_size = ehbi_thread_cache_size();
+
+	/* once warm, the cache is reused without calls to the allocator */
+	test_allocator_calls = 0;
+	ehbi_div(&quot, &rem, &numer, &denom, &err);
+	failures += check_int_m(err, 0, "second ehbi_div");
+	failures += check_int_m(ehbi_equals(&quot, &expect), 1, "quotient");
+	failures += check_int_m((int)test_allocator_calls, 0, "allocs");
+	failures += check_int_m(ehbi_thread_cache_size() > 0, 1, "size");
+	failures += check_int_m(ehbi_thread_cache_size() >= cache_size, 1,
+				"cache did not shrink");
+
+	ehbi_thread_cache_release();
+	failures += check_int_m((int)ehbi_thread_cache_size(), 0, "released");
+
+	/* and after release, it works as before */
+	ehbi_div(&quot, &rem, &numer, &denom, &err);
+	failures += check_int_m(err, 0, "third ehbi_div");
+	failures += check_int_m(ehbi_equals(&quot, &expect), 1, "quotient");
+	ehbi_thread_cache_release();
+
+	return failures;
+}
+
+#ifndef EHBI_SKIP_POOL
+/* the cache is grown and freed by the allocator which allocated it,
+   even if the global allocator is changed to the pool after */
+unsigned test_thread_cache_allocator_switch(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t i;
+	char hex[2 + (2 * 200) + 1];
+	unsigned char bytes1[TEST_CACHE_BYTES];
+	unsigned char bytes2[TEST_CACHE_BYTES];
+	unsigned char bytes3[TEST_CACHE_BYTES];
+	unsigned char bytes4[TEST_CACHE_BYTES];
+	unsigned char bytes5[TEST_CACHE_BYTES];
+	struct ehbigint numer, denom, quot, rem, expect;
+	struct eembed_allocator *orig;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&numer, bytes1, TEST_CACHE_BYTES);
+	ehbi_init(&denom, bytes2, TEST_CACHE_BYTES);
+	ehbi_init(&quot, bytes3, TEST_CACHE_BYTES);
+	ehbi_init(&rem, bytes4, TEST_CACHE_BYTES);
+	ehbi_init(&expect, bytes5, TEST_CACHE_BYTES);
+
+	hex[0] = '0';
+	hex[1] = 'x';
+	for (i = 2; i < (2 + (2 * 200)); ++i) {
+		hex[i] = 'F';
+	}
+	hex[i] = '\0';
+	ehbi_set_hex_string(&numer, hex, i, &err);
+	ehbi_set_hex_string(&denom, "0x0100000000000000010001", 24, &err);
+	failures += check_int_m(err, 0, "setup");
+
+	/* the first call allocates the cache, the next grows it to the peak */
+	ehbi_thread_cache_release();
+	ehbi_div(&expect, &rem, &numer, &denom, &err);
+	failures += check_int_m(err, 0, "first ehbi_div");
+	failures += check_int_m(ehbi_thread_cache_size() > 0, 1, "warm");
+
+	orig = eembed_global_allocator;
+	eembed_global_allocator = ehbi_pool_allocator();
+
+	ehbi_div(&quot, &rem, &numer, &denom, &err);
+	failures += check_int_m(err, 0, "pooled ehbi_div");
+	failures += check_int_m(ehbi_equals(&quot, &expect), 1, "quotient");
+	ehbi_thread_cache_release();
+
+	/* and once released, the cache is taken from the pool */
+	ehbi_div(&quot, &rem, &numer, &denom, &err);
+	failures += check_int_m(err, 0, "from pool ehbi_div");
+	failures += check_int_m(ehbi_equals(&quot, &expect), 1, "quotient");
+	ehbi_thread_cache_release();
+
+	eembed_global_allocator = orig;
+	ehbi_pool_release();
+
+	return failures;
+}
+#endif /* EHBI_SKIP_POOL */
+
+unsigned test_thread_cache(int v)
+{
+	unsigned failures = 0;
+	struct eembed_allocator *orig;
+	struct eembed_allocator counting;
+
+	orig = eembed_global_allocator;
+	counting = *orig;
+	counting.context = orig;
+	counting.malloc = test_counting_malloc;
+	counting.calloc = test_counting_calloc;
+	counting.realloc = test_counting_realloc;
+	counting.free = test_counting_free;
+	eembed_global_allocator = &counting;
+
+	failures += test_thread_cache_steady_state(v);
+
+	eembed_global_allocator = orig;
+
+#ifndef EHBI_SKIP_POOL
+	failures += test_thread_cache_allocator_switch(v);
+#endif
+
+	return failures;
+}
+#else
+unsigned test_thread_cache(int v)
+{
+	(void)v;
+	return 0;
+}
+#endif
+
+ECHECK_TEST_MAIN_V(test_thread_cache)
@@ -10,7 +10,8 @@ unsigned test_to_string_65605(int verbose)
 	struct eembed_log *log = eembed_err_log;
 	unsigned failures;
 
-	unsigned char bytes[4] = { 0x00, 0x01, 0x00, 0x45 };
+	/* least significant byte first */
+	unsigned char bytes[4] = { 0x45, 0x00, 0x01, 0x00 };
 	struct ehbigint a_bigint;
 
 	VERBOSE_ANNOUNCE(verbose);
@@ -45,7 +46,7 @@ unsigned test_to_string_negative_3(int verbose)
 	failures = 0;
 
 	ehbi_init(&bi, bytes, 20);
-	bi.bytes[19] = 0x03;
+	bi.bytes[0] = 0x03;
 	bi.bytes_used = 1;
 	ehbi_negate(&bi);
 
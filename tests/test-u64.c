@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-u64.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+unsigned test_u64_set_get(int verbose, uint64_t val, const char *expect)
+{
+	struct eembed_log *log = eembed_err_log;
+	int err;
+	unsigned failures;
+	uint64_t actual;
+	unsigned char bytes[20];
+	struct ehbigint bi;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+
+	err = 0;
+	ehbi_init(&bi, bytes, 20);
+
+	ehbi_set_u64(&bi, val, &err);
+	failures += check_int_m(err, 0, "ehbi_set_u64");
+	failures += Check_ehbigint_dec(&bi, expect);
+
+	failures += check_int_m(ehbi_fits_u64(&bi), 1, "ehbi_fits_u64");
+	failures += check_int_m(ehbi_compare_u64(&bi, val), 0, "compare_u64");
+
+	actual = ehbi_get_u64(&bi, &err);
+	failures += check_int_m(err, 0, "ehbi_get_u64");
+	failures += check_int_m(actual == val, 1, "ehbi_get_u64 value");
+
+	if (failures) {
+		log->append_ul(log, failures);
+		log->append_s(log, " failures in test_u64_set_get(");
+		log->append_s(log, expect);
+		log->append_s(log, ")");
+		log->append_eol(log);
+	}
+
+	return failures;
+}
+
+unsigned test_u64_arithmetic(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes1[20];
+	unsigned char bytes2[20];
+	unsigned char bytes3[20];
+	struct ehbigint bi1, bi2, bi3;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+
+	err = 0;
+	ehbi_init(&bi1, bytes1, 20);
+	ehbi_init(&bi2, bytes2, 20);
+	ehbi_init(&bi3, bytes3, 20);
+
+	ehbi_set_u64(&bi1, UINT64_MAX, &err);
+	ehbi_add_u64(&bi2, &bi1, 1, &err);
+	failures += check_int_m(err, 0, "ehbi_add_u64");
+	failures += Check_ehbigint_dec(&bi2, "18446744073709551616");
+	failures += check_int_m(ehbi_fits_u64(&bi2), 0, "fits 2^64");
+	failures += check_int_m(ehbi_compare_u64(&bi2, UINT64_MAX) > 0, 1,
+				"compare 2^64 > UINT64_MAX");
+
+	ehbi_get_u64(&bi2, &err);
+	failures += check_int_m(err, EHBI_BAD_DATA, "ehbi_get_u64(2^64)");
+	err = 0;
+
+	ehbi_subtract_u64(&bi3, &bi2, UINT64_MAX, &err);
+	failures += check_int_m(err, 0, "ehbi_subtract_u64");
+	failures += Check_ehbigint_dec(&bi3, "1");
+
+	ehbi_mul_u64(&bi2, &bi1, UINT64_MAX, &err);
+	failures += check_int_m(err, 0, "ehbi_mul_u64");
+	failures += Check_ehbigint_dec(&bi2,
+				       "340282366920938463426481119284349108225");
+
+	ehbi_div_u64(&bi1, &bi3, &bi2, UINT64_MAX, &err);
+	failures += check_int_m(err, 0, "ehbi_div_u64");
+	failures += Check_ehbigint_dec(&bi1, "18446744073709551615");
+	failures += Check_ehbigint_dec(&bi3, "0");
+
+	ehbi_set_l(&bi1, -1, &err);
+	failures += check_int_m(ehbi_fits_u64(&bi1), 0, "fits -1");
+	failures += check_int_m(ehbi_compare_u64(&bi1, 0) < 0, 1,
+				"compare -1 < 0");
+
+	ehbi_set_l(&bi1, 2, &err);
+	ehbi_set_l(&bi2, 100, &err);
+	ehbi_exp_mod_u64(&bi3, &bi1, &bi2, UINT64_MAX, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_mod_u64");
+	/* 2^100 mod (2^64 - 1) == 2^36 */
+	failures += Check_ehbigint_dec(&bi3, "68719476736");
+
+	return failures;
+}
+
+#ifdef EHBI_HAVE_U128
+unsigned test_u128(int verbose)
+{
+	int err;
+	unsigned failures;
+	ehbi_u128 max, actual;
+	unsigned char bytes1[40];
+	unsigned char bytes2[40];
+	unsigned char bytes3[40];
+	struct ehbigint bi1, bi2, bi3;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+
+	err = 0;
+	ehbi_init(&bi1, bytes1, 40);
+	ehbi_init(&bi2, bytes2, 40);
+	ehbi_init(&bi3, bytes3, 40);
+
+	max = 0;
+	max = ~max;
+
+	ehbi_set_u128(&bi1, max, &err);
+	failures += check_int_m(err, 0, "ehbi_set_u128");
+	failures += Check_ehbigint_dec(&bi1,
+				       "340282366920938463463374607431768211455");
+	failures += check_int_m(ehbi_fits_u128(&bi1), 1, "fits_u128");
+	failures += check_int_m(ehbi_compare_u128(&bi1, max), 0, "cmp_u128");
+	actual = ehbi_get_u128(&bi1, &err);
+	failures += check_int_m(actual == max, 1, "ehbi_get_u128");
+
+	ehbi_add_u128(&bi2, &bi1, 1, &err);
+	failures += Check_ehbigint_dec(&bi2,
+				       "340282366920938463463374607431768211456");
+	failures += check_int_m(ehbi_fits_u128(&bi2), 0, "fits 2^128");
+
+	ehbi_subtract_u128(&bi3, &bi2, max, &err);
+	failures += Check_ehbigint_dec(&bi3, "1");
+
+	ehbi_mul_u128(&bi3, &bi1, 2, &err);
+	ehbi_div_u128(&bi2, &bi1, &bi3, max, &err);
+	failures += check_int_m(err, 0, "ehbi_div_u128");
+	failures += Check_ehbigint_dec(&bi2, "2");
+	failures += Check_ehbigint_dec(&bi1, "0");
+
+	ehbi_set_l(&bi1, 3, &err);
+	ehbi_set_l(&bi2, 5, &err);
+	ehbi_exp_mod_u128(&bi3, &bi1, &bi2, max, &err);
+	failures += check_int_m(err, 0, "ehbi_exp_mod_u128");
+	failures += Check_ehbigint_dec(&bi3, "243");
+
+	return failures;
+}
+#endif
+
+unsigned test_u64(int v)
+{
+	unsigned failures = 0;
+
+	failures += test_u64_set_get(v, 0, "0");
+	failures += test_u64_set_get(v, 255, "255");
+	failures += test_u64_set_get(v, ((uint64_t)1) << 63,
+				     "9223372036854775808");
+	failures += test_u64_set_get(v, UINT64_MAX, "18446744073709551615");
+
+	failures += test_u64_arithmetic(v);
+
+#ifdef EHBI_HAVE_U128
+	failures += test_u128(v);
+#endif
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_u64)
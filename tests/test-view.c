@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-view.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+/* const, thus a write through a view would fault */
+static const unsigned char test_view_bytes[8] = {
+	0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01
+};
+
+static const unsigned char test_view_padded[5] = {
+	0x45, 0x00, 0x01, 0x00, 0x00
+};
+
+unsigned test_view_init(int verbose)
+{
+	int err;
+	unsigned failures;
+	unsigned char bytes[BILEN], qbytes[BILEN], rbytes[BILEN];
+	struct ehbigint view, padded, result, quot, rem;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&result, bytes, BILEN);
+	ehbi_init(&quot, qbytes, BILEN);
+	ehbi_init(&rem, rbytes, BILEN);
+
+	ehbi_view_init(&view, test_view_bytes, 8, &err);
+	failures += check_int_m(err, 0, "ehbi_view_init");
+	failures += check_int_m(view.bytes == test_view_bytes, 1, "no copy");
+	failures += Check_ehbigint_hex(&view, "0x0102030405060708");
+
+	ehbi_view_init(&padded, test_view_padded, 5, &err);
+	failures += check_int_m((int)padded.bytes_used, 3, "bytes_used");
+	failures += Check_ehbigint_dec(&padded, "65605");
+
+	ehbi_add(&result, &view, &padded, &err);
+	failures += check_int_m(err, 0, "ehbi_add");
+	failures += Check_ehbigint_hex(&result, "0x010203040507074D");
+
+	ehbi_div(&quot, &rem, &view, &padded, &err);
+	failures += check_int_m(err, 0, "ehbi_div");
+	ehbi_mul(&result, &quot, &padded, &err);
+	ehbi_inc(&result, &rem, &err);
+	failures += check_int_m(ehbi_equals(&result, &view), 1, "q*d+r");
+
+	ehbi_negate(&padded);
+	failures += Check_ehbigint_dec(&padded, "-65605");
+	ehbi_add(&result, &view, &padded, &err);
+	failures += Check_ehbigint_hex(&result, "0x01020304050506C3");
+
+	ehbi_view_init(&view, NULL, 0, &err);
+	failures += check_int_m(err, 0, "empty view");
+	failures += check_int_m(ehbi_is_zero(&view), 1, "empty is zero");
+
+	ehbi_view_init(&view, NULL, 4, &err);
+	failures += check_int_m(err, EHBI_NULL_BYTES, "NULL bytes");
+
+	return failures;
+}
+
+unsigned test_view_slice(int verbose)
+{
+	int err;
+	unsigned failures;
+	struct ehbigint view, slice;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_view_init(&view, test_view_bytes, 8, &err);
+
+	ehbi_view_slice(&slice, &view, 2, 3, &err);
+	failures += check_int_m(err, 0, "ehbi_view_slice");
+	failures += Check_ehbigint_hex(&slice, "0x040506");
+
+	/* only the bytes in use are viewed */
+	ehbi_view_slice(&slice, &view, 6, 10, &err);
+	failures += Check_ehbigint_hex(&slice, "0x0102");
+
+	ehbi_view_slice(&slice, &view, 8, 2, &err);
+	failures += check_int_m(ehbi_is_zero(&slice), 1, "past the end");
+
+	/* the slice is non-negative */
+	ehbi_negate(&view);
+	ehbi_view_slice(&slice, &view, 0, 1, &err);
+	failures += check_int_m(ehbi_is_negative(&slice), 0, "non-negative");
+	failures += Check_ehbigint_dec(&slice, "8");
+
+	return failures;
+}
+
+unsigned test_view(int v)
+{
+	unsigned failures = 0;
+
+	failures += test_view_init(v);
+	failures += test_view_slice(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_view)
@@ -0,0 +1,163 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-write.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "test-ehbigint-private-utils.h"
+
+#define TEST_WRITE_LEN 600
+
+struct test_write_context {
+	char buf[TEST_WRITE_LEN];
+	size_t used;
+	size_t calls;
+	size_t fail_at;
+};
+
+static void test_write_context_init(struct test_write_context *ctx)
+{
+	ctx->buf[0] = '\0';
+	ctx->used = 0;
+	ctx->calls = 0;
+	ctx->fail_at = 0;
+}
+
+static int test_write_func(void *context, const char *str, size_t len)
+{
+	struct test_write_context *ctx;
+
+	ctx = (struct test_write_context *)context;
+	if (++ctx->calls == ctx->fail_at) {
+		return -1;
+	}
+	if (len > EHBI_WRITE_BUF_SIZE || str[len] != '\0'
+	    || ctx->used + len >= TEST_WRITE_LEN) {
+		return -1;
+	}
+	eembed_memcpy(ctx->buf + ctx->used, str, len);
+	ctx->used += len;
+	ctx->buf[ctx->used] = '\0';
+
+	return 0;
+}
+
+/* the written characters are as those of the ehbi_to_* functions */
+unsigned test_write_same(int verbose, const char *hex, int negative)
+{
+	int err;
+	unsigned failures;
+	unsigned radix;
+	size_t written;
+	char buf[TEST_WRITE_LEN];
+	unsigned char bytes[TEST_WRITE_LEN];
+	struct ehbigint bi;
+	struct test_write_context ctx;
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, TEST_WRITE_LEN);
+	ehbi_set_hex_string(&bi, hex, eembed_strlen(hex), &err);
+	if (negative) {
+		ehbi_negate(&bi);
+	}
+	failures += check_int_m(err, 0, "setup");
+
+	test_write_context_init(&ctx);
+	written = ehbi_write_decimal(&bi, test_write_func, &ctx, &err);
+	failures += check_int_m(err, 0, "ehbi_write_decimal");
+	ehbi_to_decimal_string(&bi, buf, TEST_WRITE_LEN, &err);
+	failures += check_str_m(ctx.buf, buf, "decimal");
+	failures += check_int_m((int)written, (int)ctx.used, "written");
+
+	test_write_context_init(&ctx);
+	written = ehbi_write_hex(&bi, test_write_func, &ctx, &err);
+	failures += check_int_m(err, 0, "ehbi_write_hex");
+	ehbi_to_hex_string(&bi, buf, TEST_WRITE_LEN, &err);
+	failures += check_str_m(ctx.buf, buf, "hex");
+	failures += check_int_m((int)written, (int)ctx.used, "hex written");
+
+	for (radix = 2; radix <= 62; ++radix) {
+		test_write_context_init(&ctx);
+		ehbi_write_string_radix(&bi, radix, test_write_func, &ctx,
+					&err);
+		ehbi_to_string_radix(&bi, buf, TEST_WRITE_LEN, radix, &err);
+		failures += check_int_m(err, 0, "radix err");
+		failures += check_str_m(ctx.buf, buf, "radix");
+	}
+
+	if (failures) {
+		Test_log_error(hex);
+	}
+
+	return failures;
+}
+
+unsigned test_write_errors(int verbose)
+{
+	int err;
+	unsigned failures;
+	size_t written;
+	unsigned char bytes[BILEN];
+	struct ehbigint bi;
+	struct test_write_context ctx;
+	struct eembed_log slog;
+	struct eembed_str_buf sbuf;
+	char buf[BUFLEN];
+
+	VERBOSE_ANNOUNCE(verbose);
+	failures = 0;
+	err = 0;
+
+	ehbi_init(&bi, bytes, BILEN);
+	ehbi_set_hex_string(&bi, "0x0123456789ABCDEF0123", 22, &err);
+
+	/* a write which fails stops the rest */
+	test_write_context_init(&ctx);
+	ctx.fail_at = 1;
+	written = ehbi_write_string_radix(&bi, 2, test_write_func, &ctx, &err);
+	failures += check_int_m(err, EHBI_WRITE_FAILED, "write failed");
+	failures += check_int_m((int)written, 0, "nothing written");
+	failures += check_int_m((int)ctx.calls, 1, "calls");
+	err = 0;
+
+	test_write_context_init(&ctx);
+	ehbi_write_string_radix(&bi, 63, test_write_func, &ctx, &err);
+	failures += check_int_m(err, EHBI_BAD_INPUT, "radix 63");
+	failures += check_int_m((int)ctx.calls, 0, "no calls");
+	err = 0;
+
+	ehbi_write_decimal(&bi, NULL, NULL, &err);
+	failures += check_int_m(err, EHBI_NULL_ARGS, "null write_func");
+	err = 0;
+
+	/* to a log */
+	eembed_char_buf_log_init(&slog, &sbuf, buf, BUFLEN);
+	ehbi_set_l(&bi, -1234567890, &err);
+	ehbi_write_decimal(&bi, ehbi_write_to_log, &slog, &err);
+	failures += check_int_m(err, 0, "ehbi_write_to_log");
+	failures += check_str_m(buf, "-1234567890", "log");
+
+	return failures;
+}
+
+unsigned test_write(int v)
+{
+	unsigned failures = 0;
+
+	failures += test_write_same(v, "0x00", 0);
+	failures += test_write_same(v, "0x01", 1);
+	failures += test_write_same(v, "0x2386F26FC10000", 0);
+	failures += test_write_same(v, "0x2386F26FC0FFFF", 1);
+	failures +=
+	    test_write_same(v,
+			    "0x0123456789ABCDEF0123456789ABCDEF"
+			    "0123456789ABCDEF0123456789ABCDEF"
+			    "0123456789ABCDEF0123456789ABCDEF"
+			    "0123456789ABCDEF0123456789ABCDEF", 1);
+	failures += test_write_errors(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(test_write)